@@ -0,0 +1,91 @@
+// Replaces every form of the global operator new and delete, the plain, array, nothrow, sized
+// and aligned ones, so all heap allocations go through one counted path and every block is
+// freed by the same code that allocated it. Kept in its own translation unit, where no caller
+// of the operators can have them inlined and paired with the malloc and free underneath.
+
+#include "AllocationCounter.h"
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <cstdlib>
+#include <new>
+
+namespace {
+    std::atomic<size_t> g_allocationCount{0};
+    std::atomic<size_t> g_allocatedBytes{0};
+    std::atomic<int64_t> g_liveBytes{0};
+
+    // In front of every block handed out, offset leads back to what malloc returned
+    struct BlockHeader {
+        size_t size;
+        size_t offset;
+    };
+
+    void* allocateCounted(size_t size, size_t alignment){
+        alignment = std::max(alignment, alignof(std::max_align_t));
+        char* block = static_cast<char*>(std::malloc(sizeof(BlockHeader) + alignment + size));
+        if(!block){
+            return nullptr;
+        }
+        const uintptr_t first = reinterpret_cast<uintptr_t>(block) + sizeof(BlockHeader);
+        char* pointer = block + ((first + alignment - 1) / alignment * alignment - reinterpret_cast<uintptr_t>(block));
+        BlockHeader* header = reinterpret_cast<BlockHeader*>(pointer) - 1;
+        header->size = size;
+        header->offset = static_cast<size_t>(pointer - block);
+        g_allocationCount.fetch_add(1, std::memory_order_relaxed);
+        g_allocatedBytes.fetch_add(size, std::memory_order_relaxed);
+        g_liveBytes.fetch_add(static_cast<int64_t>(size), std::memory_order_relaxed);
+        return pointer;
+    }
+
+    void* allocateCountedOrThrow(size_t size, size_t alignment){
+        void* pointer = allocateCounted(size, alignment);
+        if(!pointer){
+            throw std::bad_alloc();
+        }
+        return pointer;
+    }
+
+    void freeCounted(void* pointer){
+        if(!pointer){
+            return;
+        }
+        const BlockHeader* header = static_cast<const BlockHeader*>(pointer) - 1;
+        g_liveBytes.fetch_sub(static_cast<int64_t>(header->size), std::memory_order_relaxed);
+        std::free(static_cast<char*>(pointer) - header->offset);
+    }
+}
+
+namespace Bench {
+
+AllocationCounts getAllocationCounts(){
+    AllocationCounts counts;
+    counts.allocationCount = g_allocationCount.load(std::memory_order_relaxed);
+    counts.allocatedBytes = g_allocatedBytes.load(std::memory_order_relaxed);
+    counts.liveBytes = g_liveBytes.load(std::memory_order_relaxed);
+    return counts;
+}
+
+} // namespace Bench
+
+void* operator new(size_t size){ return allocateCountedOrThrow(size, 0); }
+void* operator new[](size_t size){ return allocateCountedOrThrow(size, 0); }
+void* operator new(size_t size, const std::nothrow_t&) noexcept{ return allocateCounted(size, 0); }
+void* operator new[](size_t size, const std::nothrow_t&) noexcept{ return allocateCounted(size, 0); }
+void* operator new(size_t size, std::align_val_t alignment){ return allocateCountedOrThrow(size, static_cast<size_t>(alignment)); }
+void* operator new[](size_t size, std::align_val_t alignment){ return allocateCountedOrThrow(size, static_cast<size_t>(alignment)); }
+void* operator new(size_t size, std::align_val_t alignment, const std::nothrow_t&) noexcept{ return allocateCounted(size, static_cast<size_t>(alignment)); }
+void* operator new[](size_t size, std::align_val_t alignment, const std::nothrow_t&) noexcept{ return allocateCounted(size, static_cast<size_t>(alignment)); }
+
+void operator delete(void* pointer) noexcept{ freeCounted(pointer); }
+void operator delete[](void* pointer) noexcept{ freeCounted(pointer); }
+void operator delete(void* pointer, const std::nothrow_t&) noexcept{ freeCounted(pointer); }
+void operator delete[](void* pointer, const std::nothrow_t&) noexcept{ freeCounted(pointer); }
+void operator delete(void* pointer, size_t) noexcept{ freeCounted(pointer); }
+void operator delete[](void* pointer, size_t) noexcept{ freeCounted(pointer); }
+void operator delete(void* pointer, std::align_val_t) noexcept{ freeCounted(pointer); }
+void operator delete[](void* pointer, std::align_val_t) noexcept{ freeCounted(pointer); }
+void operator delete(void* pointer, std::align_val_t, const std::nothrow_t&) noexcept{ freeCounted(pointer); }
+void operator delete[](void* pointer, std::align_val_t, const std::nothrow_t&) noexcept{ freeCounted(pointer); }
+void operator delete(void* pointer, size_t, std::align_val_t) noexcept{ freeCounted(pointer); }
+void operator delete[](void* pointer, size_t, std::align_val_t) noexcept{ freeCounted(pointer); }
@@ -0,0 +1,21 @@
+#ifndef BENCH_ALLOCATIONCOUNTER_H
+#define BENCH_ALLOCATIONCOUNTER_H
+
+#include <cstddef>
+#include <cstdint>
+
+namespace Bench {
+
+// Heap use of the process so far, as counted by the global operator new and delete that
+// AllocationCounter.cpp replaces. Only benchmarks linking that file get the counters.
+struct AllocationCounts {
+    size_t allocationCount = 0;
+    size_t allocatedBytes = 0;
+    int64_t liveBytes = 0;
+};
+
+AllocationCounts getAllocationCounts();
+
+} // namespace Bench
+
+#endif // BENCH_ALLOCATIONCOUNTER_H
@@ -0,0 +1,136 @@
+// Measures how the latency of a literal or regex query grows with the corpus size, scanning every
+// line against scanning only the lines the trigram Bloom filters of FileLineIndex or the n-gram
+// index leave, plus the cost of the index.
+// Usage: NgramIndexBench [maxLineCount]
+
+#include "FileLineIndex.h"
+#include "NgramIndex.h"
+#include "PatternMatcher.h"
+#include "SyntheticLog.h"
+#include <chrono>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+
+using namespace Core;
+
+namespace {
+
+    // Rare token of the kind people filter for, in a few lines spread over the corpus
+    const char* NEEDLE = "trace=5f1e2d3c4b5a6978";
+    constexpr size_t NEEDLE_COUNT = 12;
+    constexpr int32_t QUERY_CHUNK_LINE_COUNT = 16384;
+
+    std::string generateCorpus(size_t lineCount){
+        std::string corpus = Bench::generateSyntheticLog(lineCount);
+        std::string needleLine = std::string("2024-03-01 00:00:00.000 [ERROR] auth: request failed ") + NEEDLE + "\n";
+        std::string result;
+        result.reserve(corpus.size() + NEEDLE_COUNT * needleLine.size());
+        size_t lineStart = 0;
+        for(size_t i = 0; i < lineCount; i++){
+            size_t lineEnd = corpus.find('\n', lineStart) + 1;
+            result.append(corpus, lineStart, lineEnd - lineStart);
+            if(i % (lineCount / NEEDLE_COUNT) == lineCount / NEEDLE_COUNT / 2){
+                result += needleLine;
+            }
+            lineStart = lineEnd;
+        }
+        return result;
+    }
+
+    struct Result {
+        double milliseconds = 0;
+        size_t matchCount = 0;
+        size_t scannedLineCount = 0;
+    };
+
+    Result scan(const FileLineIndex& fileLineIndex, const PatternMatcher& matcher, bool bBloom, const NgramIndex* index){
+        Result result;
+        std::vector<PatternMatch> matches;
+        std::vector<std::string_view> literals{matcher.getRequiredLiteral()};
+        auto start = std::chrono::steady_clock::now();
+        const int32_t lineCount = fileLineIndex.getLineCount();
+        for(int32_t beginLine = 0; beginLine < lineCount; beginLine += QUERY_CHUNK_LINE_COUNT){
+            const int32_t endLine = std::min(lineCount, beginLine + QUERY_CHUNK_LINE_COUNT);
+            NgramCandidateLines candidates;
+            if(bBloom){
+                candidates.restrict(fileLineIndex, literals, beginLine, endLine);
+            }
+            if(index){
+                candidates.restrict(*index, literals, beginLine, endLine);
+            }
+            for(int32_t lineIndex = beginLine; lineIndex < endLine; lineIndex++){
+                if(!candidates.contains(lineIndex)){
+                    continue;
+                }
+                result.scannedLineCount++;
+                matches.clear();
+                matcher.findAll(fileLineIndex.getLine(lineIndex), matches);
+                result.matchCount += matches.size();
+            }
+        }
+        result.milliseconds = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+        return result;
+    }
+
+    void benchCorpus(size_t lineCount, const std::string& path){
+        {
+            std::ofstream file(path, std::ios::binary | std::ios::trunc);
+            std::string corpus = generateCorpus(lineCount);
+            file.write(corpus.data(), static_cast<std::streamsize>(corpus.size()));
+        }
+        FileLineIndex fileLineIndex;
+        if(!fileLineIndex.load(path)){
+            std::cout << "can not load " << path << "\n";
+            return;
+        }
+        auto start = std::chrono::steady_clock::now();
+        NgramMemoryBudget memoryBudget(NgramMemoryBudget::DEFAULT_LIMIT);
+        NgramIndexPtr index = NgramIndex::build(fileLineIndex, memoryBudget, []{ return false; });
+        double buildMilliseconds = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+        if(!index){
+            std::cout << "index does not fit in the budget\n";
+            return;
+        }
+        std::cout << "\ncorpus: " << fileLineIndex.getLineCount() << " lines, " << fileLineIndex.getSize() / (1024 * 1024) << " MB"
+                  << ", index: " << index->getMemoryUsage() / 1024 << " KB in blocks of " << index->getBlockLineCount()
+                  << " lines, built in " << std::fixed << std::setprecision(1) << buildMilliseconds << " ms\n";
+
+        struct Query {
+            std::string pattern;
+            bool regex;
+        };
+        const Query queries[] = {
+            {NEEDLE, false},
+            {"trace=5f1e2d3c\\w+", true},
+            {"no_such_token_42", false},
+            {"connection reset", false},
+        };
+        for(auto& query : queries){
+            std::string error;
+            auto matcher = PatternMatcher::create(query.pattern, false, false, query.regex, error);
+            Result full = scan(fileLineIndex, *matcher, false, nullptr);
+            Result bloom = scan(fileLineIndex, *matcher, true, nullptr);
+            Result indexed = scan(fileLineIndex, *matcher, false, index.get());
+            std::cout << "  " << std::left << std::setw(26) << query.pattern << std::right << std::fixed
+                      << std::setprecision(1) << std::setw(9) << full.milliseconds << " ms full"
+                      << std::setw(9) << bloom.milliseconds << " ms bloom ("
+                      << std::setprecision(2) << 100.0 * bloom.scannedLineCount / full.scannedLineCount << "%)"
+                      << std::setprecision(1) << std::setw(9) << indexed.milliseconds << " ms indexed ("
+                      << std::setprecision(2) << 100.0 * indexed.scannedLineCount / full.scannedLineCount << "%)"
+                      << (full.matchCount == bloom.matchCount && full.matchCount == indexed.matchCount ? "" : "  MATCH COUNT DIFFERS") << "\n";
+        }
+    }
+}
+
+int main(int argc, char* argv[]){
+    size_t maxLineCount = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 4000000;
+    std::string path = (std::filesystem::temp_directory_path() / "NgramIndexBench.log").string();
+    for(size_t lineCount = std::max<size_t>(maxLineCount / 64, 1000); lineCount <= maxLineCount; lineCount *= 4){
+        benchCorpus(lineCount, path);
+    }
+    std::filesystem::remove(path);
+    return 0;
+}
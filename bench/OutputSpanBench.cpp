@@ -0,0 +1,340 @@
+// Compares the span representation of output lines with the std::list<OutputSubLine> layout it
+// replaced, on the filter, search and combine stages of the output pipeline, with the span lines
+// on their own heap blocks and in per-chunk arenas as OutputData keeps them.
+// Usage: OutputSpanBench [lineCount]
+
+#include "AllocationCounter.h"
+#include "FilterSetMatcher.h"
+#include "OutputArena.h"
+#include "OutputLine.h"
+#include "SearchData.h"
+#include "SyntheticLog.h"
+#include <chrono>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <list>
+
+using namespace Core;
+
+namespace {
+
+    // The layout before spans: every part of a line owned its color and ids, in a linked list
+    struct LegacySubLine {
+        int32_t fileId = 0;
+        std::string_view content;
+        std::string color;
+        int32_t filterId = -1;
+        int32_t filterRow = -1;
+        int32_t searchId = -1;
+        int32_t searchRow = -1;
+    };
+
+    struct LegacyLine {
+        int32_t fileId = 0;
+        int32_t fileRow = 0;
+        int32_t lineIndex = 0;
+        std::string_view content;
+        std::list<LegacySubLine> subLines;
+    };
+
+    struct Pipeline {
+        OutputStyleTable styles;
+        std::vector<std::shared_ptr<FilterData>> filters;
+        std::vector<SearchData> searches;
+        std::vector<int32_t> searchStyleIds;
+        std::unique_ptr<FilterSetMatcher> filterSetMatcher;
+    };
+
+    struct Counters {
+        size_t allocationCount = 0;
+        size_t allocatedBytes = 0;
+        int64_t retainedBytes = 0;
+        double seconds = 0;
+        size_t lineCount = 0;
+        size_t partCount = 0;
+    };
+
+    LegacySubLine toLegacySubLine(std::string_view line, const OutputSpan& span, const OutputStyleTable& styles){
+        const OutputStyle& style = styles.getStyle(span.styleId);
+        LegacySubLine subLine;
+        subLine.content = line.substr(span.offset, span.length);
+        subLine.color = style.color;
+        subLine.filterId = style.filterId;
+        subLine.filterRow = style.filterRow;
+        subLine.searchId = style.searchId;
+        subLine.searchRow = style.searchRow;
+        return subLine;
+    }
+
+    // The three stages as OutputData ran them on lists, the matchers themselves are shared with the span run
+    void runLegacy(const Pipeline& pipeline, const std::vector<std::string_view>& lines,
+                   std::vector<std::shared_ptr<LegacyLine>>& output){
+        std::vector<OutputSpan> spans;
+        for(size_t lineIndex = 0; lineIndex < lines.size(); lineIndex++){
+            std::string_view line = lines[lineIndex];
+            spans.clear();
+            pipeline.filterSetMatcher->apply(line, spans);
+            std::list<LegacySubLine> subLines;
+            bool matched = false;
+            for(auto& span : spans){
+                subLines.push_back(toLegacySubLine(line, span, pipeline.styles));
+                matched = matched || span.styleId != OutputStyleTable::PLAIN_STYLE_ID;
+            }
+            if(!matched){
+                continue;
+            }
+            auto filteredLine = std::make_shared<LegacyLine>();
+            filteredLine->lineIndex = static_cast<int32_t>(lineIndex);
+            filteredLine->content = line;
+            for(auto& subLine : subLines){
+                filteredLine->subLines.push_back(subLine);
+            }
+
+            std::list<LegacySubLine> searchSubLines;
+            LegacySubLine whole;
+            whole.content = line;
+            searchSubLines.push_back(whole);
+            for(size_t i = 0; i < pipeline.searches.size(); i++){
+                std::list<LegacySubLine> searchSubLines2;
+                for(auto& subLine : searchSubLines){
+                    if(subLine.searchId != -1){
+                        searchSubLines2.push_back(subLine);
+                        continue;
+                    }
+                    spans.clear();
+                    uint32_t offset = static_cast<uint32_t>(subLine.content.data() - line.data());
+                    pipeline.searches[i].apply(subLine.content, offset, pipeline.searchStyleIds[i], spans);
+                    for(auto& span : spans){
+                        searchSubLines2.push_back(toLegacySubLine(line, span, pipeline.styles));
+                    }
+                }
+                searchSubLines = searchSubLines2;
+            }
+            auto searchedLine = std::make_shared<LegacyLine>();
+            searchedLine->lineIndex = static_cast<int32_t>(lineIndex);
+            for(auto& subLine : searchSubLines){
+                searchedLine->subLines.push_back(subLine);
+            }
+
+            auto combinedLine = std::make_shared<LegacyLine>();
+            combinedLine->lineIndex = static_cast<int32_t>(lineIndex);
+            std::list<LegacySubLine> combinedSubLines;
+            for(auto& subLine : filteredLine->subLines){
+                combinedSubLines.push_back(subLine);
+            }
+            for(auto& searchedSubLine : searchedLine->subLines){
+                if(searchedSubLine.searchId == -1){
+                    continue;
+                }
+                const char* searchFirst = searchedSubLine.content.data();
+                const char* searchLast = searchFirst + searchedSubLine.content.size() - 1;
+                std::list<LegacySubLine> combinedSubLines2;
+                for(auto& combinedSubLine : combinedSubLines){
+                    const char* combinedFirst = combinedSubLine.content.data();
+                    const char* combinedLast = combinedFirst + combinedSubLine.content.size() - 1;
+                    if(searchFirst > combinedLast || searchLast < combinedFirst){
+                        combinedSubLines2.push_back(combinedSubLine);
+                        continue;
+                    }
+                    size_t leftSize = combinedFirst < searchFirst ? searchFirst - combinedFirst : 0;
+                    size_t rightSize = combinedLast > searchLast ? combinedLast - searchLast : 0;
+                    size_t middleSize = combinedSubLine.content.size() - leftSize - rightSize;
+                    if(0 < leftSize){
+                        LegacySubLine left = combinedSubLine;
+                        left.content = std::string_view(combinedFirst, leftSize);
+                        combinedSubLines2.push_back(left);
+                    }
+                    if(0 < middleSize){
+                        LegacySubLine middle = searchedSubLine;
+                        middle.content = std::string_view(combinedFirst + leftSize, middleSize);
+                        combinedSubLines2.push_back(middle);
+                    }
+                    if(0 < rightSize){
+                        LegacySubLine right = combinedSubLine;
+                        right.content = std::string_view(combinedFirst + leftSize + middleSize, rightSize);
+                        combinedSubLines2.push_back(right);
+                    }
+                }
+                combinedSubLines = combinedSubLines2;
+            }
+            for(auto& subLine : combinedSubLines){
+                combinedLine->subLines.push_back(subLine);
+            }
+            output.push_back(filteredLine);
+            output.push_back(searchedLine);
+            output.push_back(combinedLine);
+        }
+    }
+
+    // A span line on its own heap block, as before the lines of a chunk shared an arena
+    struct HeapSpanLine {
+        OutputLine line;
+        std::vector<OutputSpan> spans;
+    };
+
+    std::shared_ptr<HeapSpanLine> makeHeapLine(const OutputLine& line, const std::vector<OutputSpan>& spans, OutputArenaPtr&){
+        auto heapLine = std::make_shared<HeapSpanLine>();
+        heapLine->line = line;
+        heapLine->spans = spans;
+        heapLine->line.setSpans(heapLine->spans);
+        return heapLine;
+    }
+
+    std::shared_ptr<OutputLine> makeArenaLine(const OutputLine& line, const std::vector<OutputSpan>& spans, OutputArenaPtr& arena){
+        OutputLine* arenaLine = arena->create<OutputLine>(line);
+        arenaLine->setSpans(OutputSpanRange(arena->copyArray(spans.data(), spans.size()), spans.size()));
+        return std::shared_ptr<OutputLine>(arena, arenaLine);
+    }
+
+    OutputSpanRange getSpans(const HeapSpanLine& line){
+        return line.line.getSpans();
+    }
+
+    OutputSpanRange getSpans(const OutputLine& line){
+        return line.getSpans();
+    }
+
+    // The same stages on spans, as OutputData runs them now, with a new arena every CHUNK_LINE_COUNT lines
+    constexpr size_t CHUNK_LINE_COUNT = 16384;
+
+    template <typename Line>
+    void runSpans(const Pipeline& pipeline, const std::vector<std::string_view>& lines,
+                  std::vector<std::shared_ptr<Line>>& output,
+                  std::shared_ptr<Line> (*makeLine)(const OutputLine&, const std::vector<OutputSpan>&, OutputArenaPtr&),
+                  std::vector<OutputArenaPtr>& arenas){
+        OutputArenaPtr arena;
+        std::vector<OutputSpan> spans;
+        std::vector<OutputSpan> nextSpans;
+        std::vector<OutputSpan> combinedSpans;
+        for(size_t lineIndex = 0; lineIndex < lines.size(); lineIndex++){
+            if(lineIndex % CHUNK_LINE_COUNT == 0){
+                arena = std::make_shared<OutputArena>();
+                arenas.push_back(arena);
+            }
+            std::string_view line = lines[lineIndex];
+            spans.clear();
+            pipeline.filterSetMatcher->apply(line, spans);
+            bool matched = false;
+            for(auto& span : spans){
+                matched = matched || span.styleId != OutputStyleTable::PLAIN_STYLE_ID;
+            }
+            if(!matched){
+                continue;
+            }
+            OutputLine outputLine;
+            outputLine.setLineIndex(static_cast<int32_t>(lineIndex));
+            outputLine.setContent(line);
+            auto filteredLine = makeLine(outputLine, spans, arena);
+
+            spans.clear();
+            spans.push_back({0, static_cast<uint32_t>(line.size()), OutputStyleTable::PLAIN_STYLE_ID});
+            for(size_t i = 0; i < pipeline.searches.size(); i++){
+                nextSpans.clear();
+                for(auto& span : spans){
+                    if(span.styleId != OutputStyleTable::PLAIN_STYLE_ID){
+                        nextSpans.push_back(span);
+                    }else{
+                        pipeline.searches[i].apply(line.substr(span.offset, span.length), span.offset, pipeline.searchStyleIds[i], nextSpans);
+                    }
+                }
+                spans.swap(nextSpans);
+            }
+            auto searchedLine = makeLine(outputLine, spans, arena);
+
+            combineOutputSpans(getSpans(*filteredLine), getSpans(*searchedLine), combinedSpans);
+            auto combinedLine = makeLine(outputLine, combinedSpans, arena);
+
+            output.push_back(filteredLine);
+            output.push_back(searchedLine);
+            output.push_back(combinedLine);
+        }
+    }
+
+    template <typename Line, typename Run>
+    Counters measure(size_t inputLineCount, const Run& run, size_t (*countParts)(const Line&)){
+        std::vector<std::shared_ptr<Line>> output;
+        output.reserve(inputLineCount * 3);
+        Bench::AllocationCounts before = Bench::getAllocationCounts();
+        auto start = std::chrono::steady_clock::now();
+        run(output);
+        Counters counters;
+        counters.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        Bench::AllocationCounts after = Bench::getAllocationCounts();
+        counters.allocationCount = after.allocationCount - before.allocationCount;
+        counters.allocatedBytes = after.allocatedBytes - before.allocatedBytes;
+        counters.retainedBytes = after.liveBytes - before.liveBytes;
+        counters.lineCount = output.size() / 3;
+        for(auto& line : output){
+            counters.partCount += countParts(*line);
+        }
+        return counters;
+    }
+
+    void print(const char* name, const Counters& counters){
+        double lines = counters.lineCount ? static_cast<double>(counters.lineCount) : 1.0;
+        std::cout << std::left << std::setw(16) << name << std::right << std::fixed << std::setprecision(1)
+                  << std::setw(12) << counters.allocationCount / lines << " allocs/line"
+                  << std::setw(12) << counters.allocatedBytes / lines << " B allocated/line"
+                  << std::setw(12) << counters.retainedBytes / lines << " B retained/line"
+                  << std::setw(10) << counters.seconds * 1000 << " ms\n";
+    }
+}
+
+int main(int argc, char* argv[]){
+    size_t lineCount = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 200000;
+    std::string corpus = Bench::generateSyntheticLog(lineCount);
+    std::vector<std::string_view> lines;
+    lines.reserve(lineCount);
+    for(size_t lineStart = 0; lineStart < corpus.size();){
+        size_t lineEnd = corpus.find('\n', lineStart);
+        lines.push_back(std::string_view(corpus).substr(lineStart, lineEnd - lineStart));
+        lineStart = lineEnd + 1;
+    }
+
+    Pipeline pipeline;
+    std::map<int32_t, std::shared_ptr<FilterData>> enabledFilters;
+    enabledFilters[0] = std::make_shared<FilterData>(201, 0, "ERROR", true, false, false, true, "#ff0000");
+    enabledFilters[1] = std::make_shared<FilterData>(202, 1, "WARN", true, false, false, true, "#ffa500");
+    enabledFilters[2] = std::make_shared<FilterData>(203, 2, "user\\d+", false, false, true, true, "#008000");
+    enabledFilters[3] = std::make_shared<FilterData>(204, 3, "timeout", false, true, false, true, "#0000ff");
+    pipeline.filterSetMatcher = std::make_unique<FilterSetMatcher>(enabledFilters, pipeline.styles);
+    pipeline.searches.emplace_back(301, 0, "retries", false, false, false, true, "#800080");
+    pipeline.searches.emplace_back(302, 1, "\\d+ ms", false, false, true, true, "#008080");
+    pipeline.searches.emplace_back(303, 2, "e", true, false, false, true, "#808000");
+    for(auto& search : pipeline.searches){
+        pipeline.searchStyleIds.push_back(pipeline.styles.addStyle(search.getStyle()));
+    }
+    std::cout << "corpus: " << lineCount << " lines, " << corpus.size() / 1024 << " KB, 4 filters, 3 searches\n";
+
+    Counters legacy = measure<LegacyLine>(lines.size(), [&](auto& output){ runLegacy(pipeline, lines, output); },
+                                          [](const LegacyLine& line){ return line.subLines.size(); });
+    // Reserved up front, so recording the arenas allocates nothing while measuring
+    std::vector<OutputArenaPtr> arenas;
+    arenas.reserve(lines.size() / CHUNK_LINE_COUNT + 1);
+    Counters heapSpans = measure<HeapSpanLine>(lines.size(), [&](auto& output){ runSpans(pipeline, lines, output, makeHeapLine, arenas); },
+                                               [](const HeapSpanLine& line){ return line.spans.size(); });
+    arenas.clear();
+    Counters spans = measure<OutputLine>(lines.size(), [&](auto& output){ runSpans(pipeline, lines, output, makeArenaLine, arenas); },
+                                         [](const OutputLine& line){ return line.getSpans().size(); });
+    std::cout << "output: " << spans.lineCount << " lines, " << spans.partCount / 3.0 / (spans.lineCount ? spans.lineCount : 1)
+              << " parts per stage and line"
+              << (legacy.partCount == spans.partCount && heapSpans.partCount == spans.partCount ? "" : "  PART COUNT DIFFERS") << "\n";
+    print("std::list", legacy);
+    print("spans, heap", heapSpans);
+    print("spans, arena", spans);
+    // Told by the arenas themselves, apart from the allocation counters
+    size_t arenaBlockCount = 0;
+    size_t arenaReservedBytes = 0;
+    for(auto& arena : arenas){
+        arenaBlockCount += arena->getBlockCount();
+        arenaReservedBytes += arena->getReservedBytes();
+    }
+    std::cout << "arenas: " << arenas.size() << " chunks, " << std::setprecision(1)
+              << static_cast<double>(arenaBlockCount) / (arenas.empty() ? 1 : arenas.size()) << " blocks and "
+              << arenaReservedBytes / 1024.0 / (arenas.empty() ? 1 : arenas.size()) << " KB per chunk\n";
+    std::cout << "reduction: " << std::setprecision(1)
+              << static_cast<double>(legacy.allocationCount) / spans.allocationCount << "x allocations, "
+              << static_cast<double>(legacy.retainedBytes) / spans.retainedBytes << "x retained memory\n";
+    return 0;
+}
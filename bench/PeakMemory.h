@@ -0,0 +1,77 @@
+#ifndef BENCH_PEAKMEMORY_H
+#define BENCH_PEAKMEMORY_H
+
+#include <cstddef>
+#include <cstdio>
+
+#if defined(_WIN32)
+#include <windows.h>
+#include <psapi.h>
+#pragma comment(lib, "psapi.lib")
+#elif defined(__APPLE__)
+#include <mach/mach.h>
+#include <sys/resource.h>
+#else
+#include <sys/resource.h>
+#include <unistd.h>
+#endif
+
+namespace Bench {
+
+// Largest resident set size of the process so far, 0 where it can not be read
+inline size_t getPeakResidentBytes(){
+#if defined(_WIN32)
+    PROCESS_MEMORY_COUNTERS counters;
+    if(GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters))){
+        return counters.PeakWorkingSetSize;
+    }
+    return 0;
+#else
+    struct rusage usage;
+    if(getrusage(RUSAGE_SELF, &usage) != 0){
+        return 0;
+    }
+#if defined(__APPLE__)
+    return static_cast<size_t>(usage.ru_maxrss);            // bytes on macOS
+#else
+    return static_cast<size_t>(usage.ru_maxrss) * 1024;     // kilobytes on Linux
+#endif
+#endif
+}
+
+// Resident set size of the process now, 0 where it can not be read. Unlike the peak it also goes
+// down, so the growth of one stage can be told apart from what earlier stages left behind.
+inline size_t getCurrentResidentBytes(){
+#if defined(_WIN32)
+    PROCESS_MEMORY_COUNTERS counters;
+    if(GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters))){
+        return counters.WorkingSetSize;
+    }
+    return 0;
+#elif defined(__APPLE__)
+    mach_task_basic_info_data_t info;
+    mach_msg_type_number_t count = MACH_TASK_BASIC_INFO_COUNT;
+    if(task_info(mach_task_self(), MACH_TASK_BASIC_INFO, reinterpret_cast<task_info_t>(&info), &count) != KERN_SUCCESS){
+        return 0;
+    }
+    return static_cast<size_t>(info.resident_size);
+#else
+    // Second field of /proc/self/statm, in pages
+    FILE* file = std::fopen("/proc/self/statm", "r");
+    if(!file){
+        return 0;
+    }
+    unsigned long long sizePages = 0;
+    unsigned long long residentPages = 0;
+    int fieldCount = std::fscanf(file, "%llu %llu", &sizePages, &residentPages);
+    std::fclose(file);
+    if(fieldCount != 2){
+        return 0;
+    }
+    return static_cast<size_t>(residentPages) * static_cast<size_t>(sysconf(_SC_PAGESIZE));
+#endif
+}
+
+} // namespace Bench
+
+#endif // BENCH_PEAKMEMORY_H
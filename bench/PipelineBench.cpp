@@ -0,0 +1,347 @@
+// Runs the stages of the OutputData pipeline one at a time on a synthetic corpus: loading the file,
+// the filters, the searches and combining their spans, each on one thread. Then a full pass as the
+// worker runs it, match navigation, and fetching the output a window at a time as the view does.
+// Every stage reports its throughput, the resident memory of the process after it, how much that
+// grew during the stage, and the peak resident memory so far.
+// Usage: txtlogparser_bench [--lines N] [--seed N] [--timestamp iso|syslog|epoch|none] [--words N]
+//                           [--max-words N] [--vocabulary N] [--selectivity F] [--ngram-index]
+
+#include "OutputData.h"
+#include "PeakMemory.h"
+#include "SyntheticLog.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+
+#ifdef TXTLOGPARSER_BENCH_QT
+#include "OutputLineAdapter.h"
+#include "OutputRows.h"
+#endif
+
+using namespace Core;
+
+namespace {
+
+    constexpr int32_t WINDOW_LINE_COUNT = 60;           // rows of a tall output view
+    constexpr int32_t MAX_NAVIGATION_STEPS = 200000;
+    constexpr int32_t MAX_WINDOW_FETCHES = 20000;
+
+    struct Stage {
+        double seconds = 0;
+        uint64_t bytes = 0;
+        uint64_t lines = 0;
+        size_t residentBytesBefore = 0;
+        size_t residentBytesAfter = 0;
+    };
+
+    void printHeader(){
+        std::cout << std::left << std::setw(28) << "stage" << std::right
+                  << std::setw(10) << "ms" << std::setw(12) << "MB/s" << std::setw(14) << "lines/s"
+                  << std::setw(10) << "RSS MB" << std::setw(10) << "+RSS MB" << std::setw(14) << "peak RSS MB" << "\n";
+    }
+
+    double toMegabytes(size_t bytes){
+        return bytes / (1024.0 * 1024.0);
+    }
+
+    // Stages that do not go through text, like match navigation, have no MB/s
+    void print(const char* name, const Stage& stage){
+        double seconds = stage.seconds > 0 ? stage.seconds : 1e-9;
+        std::cout << std::left << std::setw(28) << name << std::right << std::fixed
+                  << std::setprecision(1) << std::setw(10) << stage.seconds * 1000 << std::setw(12);
+        if(stage.bytes > 0){
+            std::cout << toMegabytes(stage.bytes) / seconds;
+        }else{
+            std::cout << "-";
+        }
+        // Signed, a stage that frees what an earlier one left behind shrinks the resident set
+        double growth = toMegabytes(stage.residentBytesAfter) - toMegabytes(stage.residentBytesBefore);
+        // Linux updates the peak lazily, it can trail the current size by a little
+        size_t peak = std::max(Bench::getPeakResidentBytes(), stage.residentBytesAfter);
+        std::cout << std::setprecision(0) << std::setw(14) << stage.lines / seconds
+                  << std::setprecision(1) << std::setw(10) << toMegabytes(stage.residentBytesAfter)
+                  << std::showpos << std::setw(10) << growth << std::noshowpos
+                  << std::setw(14) << toMegabytes(peak) << "\n";
+    }
+
+    template <typename Run>
+    Stage measure(const Run& run){
+        Stage stage;
+        stage.residentBytesBefore = Bench::getCurrentResidentBytes();
+        auto start = std::chrono::steady_clock::now();
+        run(stage);
+        stage.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        stage.residentBytesAfter = Bench::getCurrentResidentBytes();
+        return stage;
+    }
+
+    // Exposes the protected stages of the pipeline, each of them run over every chunk on this thread
+    class BenchOutputData : public OutputData {
+    public:
+        Stage load(const std::shared_ptr<FileData>& file){
+            // The pass loadFiles() would run stays pending, the stages below run it piece by piece
+            pauseRefresh();
+            Stage stage = measure([&](Stage&){ loadFiles({file}, {}, false); });
+            resumeRefresh();
+            for(auto& [fileId, fileLineIndex] : m_allFileLineIndexes){
+                stage.bytes += fileLineIndex->getSize();
+                stage.lines += static_cast<uint64_t>(fileLineIndex->getLineCount());
+            }
+            return stage;
+        }
+
+        void prepareStages(){
+            m_job = createOutputJob();
+            m_candidates.clear();
+            for(auto& chunk : m_job->chunks){
+                m_candidates.push_back(createChunkCandidates(*m_job, chunk));
+            }
+            m_arena = std::make_shared<OutputArena>();
+        }
+
+        Stage runFilters(){
+            m_filteredLines.clear();
+            return measure([&](Stage& stage){
+                for(size_t i = 0; i < m_job->chunks.size(); i++){
+                    const OutputChunk& chunk = m_job->chunks[i];
+                    for(int32_t lineIndex = chunk.beginLine; lineIndex < chunk.endLine; lineIndex++){
+                        stage.bytes += chunk.fileLineIndex->getLine(lineIndex).size() + 1;
+                        stage.lines++;
+                        if(!m_candidates[i].filterLines.contains(lineIndex)){
+                            continue;
+                        }
+                        if(auto line = applyEnabledFilters(*m_job, chunk, lineIndex, m_arena)){
+                            m_filteredLines.push_back({i, std::move(line)});
+                        }
+                    }
+                }
+            });
+        }
+
+        Stage runSearches(){
+            m_searchedLines.clear();
+            m_searchedLines.reserve(m_filteredLines.size());
+            return measure([&](Stage& stage){
+                for(auto& filteredLine : m_filteredLines){
+                    stage.bytes += filteredLine.line->getContent().size() + 1;
+                    stage.lines++;
+                    m_searchedLines.push_back(applyEnabledSearches(*m_job, *filteredLine.line, m_candidates[filteredLine.chunkIndex], m_arena));
+                }
+            });
+        }
+
+        Stage runCombine(){
+            // A fresh arena, so the combined lines do not grow the one of the filtered and searched lines
+            OutputArenaPtr arena = std::make_shared<OutputArena>();
+            return measure([&](Stage& stage){
+                for(size_t i = 0; i < m_filteredLines.size(); i++){
+                    stage.bytes += m_filteredLines[i].line->getContent().size() + 1;
+                    stage.lines++;
+                    combineFiltersAndSearches(*m_filteredLines[i].line, *m_searchedLines[i], arena);
+                }
+            });
+        }
+
+        void releaseStages(){
+            m_filteredLines.clear();
+            m_searchedLines.clear();
+            m_candidates.clear();
+            m_arena.reset();
+            m_job.reset();
+        }
+
+        // The pass the worker thread runs, parallel unless disabled, on the loaded files
+        Stage runPass(){
+            Stage stage = measure([&](Stage&){ recreateOutputLines(); });
+            for(auto& [fileId, fileLineIndex] : m_allFileLineIndexes){
+                stage.bytes += fileLineIndex->getSize();
+                stage.lines += static_cast<uint64_t>(fileLineIndex->getLineCount());
+            }
+            return stage;
+        }
+
+    private:
+        struct FilteredLine {
+            size_t chunkIndex;
+            std::shared_ptr<OutputLine> line;
+        };
+
+        std::shared_ptr<OutputJob> m_job;
+        std::vector<ChunkCandidates> m_candidates;
+        OutputArenaPtr m_arena;
+        std::vector<FilteredLine> m_filteredLines;
+        std::vector<std::shared_ptr<OutputLine>> m_searchedLines;
+    };
+
+    using GetNextMatch = bool (OutputData::*)(int32_t, int32_t, int32_t, int32_t&, int32_t&, int32_t&);
+
+    // Steps from match to match of one filter or search, as its navigate button does
+    Stage navigate(OutputData& data, GetNextMatch getNextMatch, int32_t id){
+        return measure([&](Stage& stage){
+            int32_t lineIndex = 0;
+            int32_t charIndex = 0;
+            int32_t matchLineIndex = 0;
+            int32_t matchCharStartIndex = 0;
+            int32_t matchCharEndIndex = 0;
+            while(stage.lines < MAX_NAVIGATION_STEPS
+                  && (data.*getNextMatch)(id, lineIndex, charIndex, matchLineIndex, matchCharStartIndex, matchCharEndIndex)){
+                if(matchLineIndex < lineIndex || (matchLineIndex == lineIndex && matchCharStartIndex < charIndex)){
+                    break;  // wrapped around to the first match
+                }
+                stage.lines++;
+                lineIndex = matchLineIndex;
+                charIndex = matchCharEndIndex;
+            }
+        });
+    }
+
+    // Scrolls through the output a window at a time, as the view asks for the lines it shows
+    template <typename Convert>
+    Stage fetchWindows(OutputData& data, const Convert& convert){
+        int32_t lineCount = data.getOutputLineCount();
+        int32_t step = std::max<int32_t>(WINDOW_LINE_COUNT, lineCount / MAX_WINDOW_FETCHES);
+        Stage stage = measure([&](Stage& stage){
+            for(int32_t topLineIndex = 0; topLineIndex < lineCount; topLineIndex += step){
+                data.setOutputWindow(topLineIndex, WINDOW_LINE_COUNT);
+                std::vector<std::shared_ptr<OutputLine>> lines = data.getOutputStringList();
+                for(auto& line : lines){
+                    stage.bytes += line->getContent().size() + 1;
+                }
+                stage.lines += lines.size();
+                convert(lines);
+            }
+        });
+        data.setOutputWindow(0, WINDOW_LINE_COUNT);
+        return stage;
+    }
+
+    bool parseArguments(int argc, char* argv[], Bench::SyntheticLogOptions& options, bool& bNgramIndex){
+        for(int i = 1; i < argc; i++){
+            const char* arg = argv[i];
+            const char* value = i + 1 < argc ? argv[i + 1] : nullptr;
+            if(std::strcmp(arg, "--ngram-index") == 0){
+                bNgramIndex = true;
+                continue;
+            }
+            if(!value){
+                return false;
+            }
+            i++;
+            if(std::strcmp(arg, "--lines") == 0){
+                options.lineCount = std::strtoul(value, nullptr, 10);
+            }else if(std::strcmp(arg, "--seed") == 0){
+                options.seed = static_cast<uint32_t>(std::strtoul(value, nullptr, 10));
+            }else if(std::strcmp(arg, "--words") == 0){
+                options.meanMessageWords = std::strtod(value, nullptr);
+            }else if(std::strcmp(arg, "--max-words") == 0){
+                options.maxMessageWords = std::strtoul(value, nullptr, 10);
+            }else if(std::strcmp(arg, "--vocabulary") == 0){
+                options.vocabularySize = std::strtoul(value, nullptr, 10);
+            }else if(std::strcmp(arg, "--selectivity") == 0){
+                options.selectivity = std::strtod(value, nullptr);
+            }else if(std::strcmp(arg, "--timestamp") == 0){
+                if(std::strcmp(value, "iso") == 0){
+                    options.timestampFormat = Bench::TimestampFormat::Iso;
+                }else if(std::strcmp(value, "syslog") == 0){
+                    options.timestampFormat = Bench::TimestampFormat::Syslog;
+                }else if(std::strcmp(value, "epoch") == 0){
+                    options.timestampFormat = Bench::TimestampFormat::EpochMillis;
+                }else if(std::strcmp(value, "none") == 0){
+                    options.timestampFormat = Bench::TimestampFormat::None;
+                }else{
+                    return false;
+                }
+            }else{
+                return false;
+            }
+        }
+        return true;
+    }
+}
+
+int main(int argc, char* argv[]){
+    Bench::SyntheticLogOptions options;
+    bool bNgramIndex = false;
+    if(!parseArguments(argc, argv, options, bNgramIndex)){
+        std::cerr << "Usage: txtlogparser_bench [--lines N] [--seed N] [--timestamp iso|syslog|epoch|none] [--words N]\n"
+                     "                          [--max-words N] [--vocabulary N] [--selectivity F] [--ngram-index]\n";
+        return 2;
+    }
+    // Log messages of the pipeline would mix with the report
+    Logger::getInstance().setConsoleStream(nullptr);
+
+    std::string path = (std::filesystem::temp_directory_path() / "txtlogparser_bench.log").string();
+    {
+        // Written a piece at a time, the corpus as a whole would set a peak no stage gets near
+        std::ofstream file(path, std::ios::binary | std::ios::trunc);
+        Bench::generateSyntheticLog(options, [&file](std::string_view piece){
+            file.write(piece.data(), static_cast<std::streamsize>(piece.size()));
+        });
+    }
+
+    BenchOutputData data;
+    data.setNgramIndexEnabled(bNgramIndex);
+    // Two filters keeping the selected lines, searches for a frequent word, a level and a regex
+    std::string frequentWord = Bench::getSyntheticWord(0);
+    data.addFilter(std::make_shared<FilterData>(201, 0, options.matchToken, false, false, false, true, "#ff0000"));
+    data.addFilter(std::make_shared<FilterData>(202, 1, options.matchToken + "\\b", false, false, true, true, "#ffa500"));
+    data.addSearch(std::make_shared<SearchData>(301, 0, frequentWord, false, true, false, true, "#800080"));
+    data.addSearch(std::make_shared<SearchData>(302, 1, "WARN", true, false, false, true, "#008080"));
+    data.addSearch(std::make_shared<SearchData>(303, 2, "(auth|storage):", false, false, true, true, "#808000"));
+    auto file = std::make_shared<FileData>();
+    file->init(101, 0, path);
+    data.addFile(file);
+
+    size_t residentBeforeLoad = Bench::getCurrentResidentBytes();
+    Stage load = data.load(file);
+    std::cout << "corpus: " << load.lines << " lines, " << std::fixed << std::setprecision(1) << toMegabytes(load.bytes)
+              << " MB, selectivity " << std::defaultfloat << options.selectivity << ", seed " << options.seed
+              << (bNgramIndex ? ", n-gram index" : "") << "\n";
+    std::cout << "RSS before loading: " << std::fixed << std::setprecision(1) << toMegabytes(residentBeforeLoad) << " MB\n";
+    printHeader();
+    print("loadFiles", load);
+
+    data.prepareStages();
+    Stage filters = data.runFilters();
+    print("applyEnabledFilters", filters);
+    print("applyEnabledSearches", data.runSearches());
+    print("combineFiltersAndSearches", data.runCombine());
+    data.releaseStages();
+
+    print("full pass", data.runPass());
+    std::cout << "output: " << data.getOutputLineCount() << " lines\n";
+    print("getNextMatchByFilter", navigate(data, &OutputData::getNextMatchByFilter, 201));
+    print("getNextMatchBySearch", navigate(data, &OutputData::getNextMatchBySearch, 302));
+    print("getOutputStringList", fetchWindows(data, [](const std::vector<std::shared_ptr<OutputLine>>&){}));
+#ifdef TXTLOGPARSER_BENCH_QT
+    // What QtBridge::getOutputStringList() adds: the conversion it runs, a QString of every span and of its color
+    qsizetype characterCount = 0;
+    print("  + QOutputLine", fetchWindows(data, [&](const std::vector<std::shared_ptr<OutputLine>>& lines){
+        OutputStyleTablePtr styles = data.getOutputStyleTable();
+        QList<QOutputLine> outputLines = OutputLineAdapter::getInstance().toQOutputLineList(lines, *styles);
+        for(auto& outputLine : outputLines){
+            for(auto& subLine : outputLine.m_subLines){
+                characterCount += subLine.m_content.size() + subLine.m_color.size();
+            }
+        }
+    }));
+    // And what QtBridge::getOutputRows() does for the log view instead
+    print("  + OutputRows", fetchWindows(data, [&](const std::vector<std::shared_ptr<OutputLine>>& lines){
+        OutputRows rows(0, lines, *data.getOutputStyleTable());
+        for(int index = 0; index < rows.size(); index++){
+            for(int spanIndex = 0; spanIndex < rows.getSpanCount(index); spanIndex++){
+                characterCount += rows.getSpanText(index, spanIndex).size();
+            }
+        }
+    }));
+    std::cout << "converted " << characterCount << " characters\n";
+#endif
+
+    std::filesystem::remove(path);
+    return 0;
+}
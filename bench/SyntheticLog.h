@@ -0,0 +1,175 @@
+#ifndef BENCH_SYNTHETICLOG_H
+#define BENCH_SYNTHETICLOG_H
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <random>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace Bench {
+
+/**
+ * @brief Deterministic generator of application-style log text
+ *
+ * The same seed always produces the same corpus, so results of different builds can be compared.
+ */
+inline std::string generateSyntheticLog(size_t lineCount, uint32_t seed = 12345){
+    static const char* levels[] = {"DEBUG", "INFO", "INFO", "INFO", "WARN", "ERROR"};
+    static const char* modules[] = {"network", "storage", "scheduler", "auth", "ui", "parser"};
+    static const char* messages[] = {
+        "request completed for user%u in %u ms",
+        "connection reset by peer 10.0.%u.%u",
+        "cache miss on key session_%u, reloading %u entries",
+        "timeout while waiting for lock %u after %u retries",
+        "processed batch %u with %u records",
+        "failed to open file /var/data/item_%u.dat errno=%u",
+    };
+    std::mt19937 rng(seed);
+    std::string text;
+    text.reserve(lineCount * 96);
+    char line[256];
+    for(size_t i = 0; i < lineCount; i++){
+        unsigned seconds = static_cast<unsigned>(i / 50);
+        int prefix = std::snprintf(line, sizeof(line), "2024-03-%02u %02u:%02u:%02u.%03u [%s] %s: ",
+                                   1 + (seconds / 86400) % 28, (seconds / 3600) % 24, (seconds / 60) % 60,
+                                   seconds % 60, static_cast<unsigned>(rng() % 1000),
+                                   levels[rng() % 6], modules[rng() % 6]);
+        std::snprintf(line + prefix, sizeof(line) - prefix, messages[rng() % 6],
+                      static_cast<unsigned>(rng() % 5000), static_cast<unsigned>(rng() % 300));
+        text += line;
+        text += '\n';
+    }
+    return text;
+}
+
+enum class TimestampFormat {
+    Iso,            // 2024-03-01 00:00:00.123
+    Syslog,         // Mar  1 00:00:00
+    EpochMillis,    // 1709251200123
+    None
+};
+
+/**
+ * @brief Shape of a corpus made by generateSyntheticLog(const SyntheticLogOptions&)
+ *
+ * Messages are words drawn from a vocabulary of made-up words, the first ones far more often than
+ * the rest. Their word count follows an exponential distribution, so most lines are short and a
+ * few are long. matchToken is put in a fraction selectivity of the lines and nowhere else, so a
+ * filter for it keeps a known share of the corpus.
+ */
+struct SyntheticLogOptions {
+    size_t lineCount = 200000;
+    uint32_t seed = 12345;
+    TimestampFormat timestampFormat = TimestampFormat::Iso;
+    double meanMessageWords = 10;
+    size_t maxMessageWords = 200;
+    size_t vocabularySize = 5000;
+    double selectivity = 0.01;
+    std::string matchToken = "match_token";     // vocabulary words have no '_', so only selected lines contain it
+};
+
+// The i-th word of the vocabulary, made of syllables so words differ in length like real ones
+inline std::string getSyntheticWord(size_t index){
+    static const char* syllables[] = {"ka", "lo", "mi", "ren", "sta", "tor", "vu", "pex", "dra", "ni", "quo", "bel", "fin", "gar", "hu", "jo"};
+    std::string word;
+    do {
+        word += syllables[index % 16];
+        index /= 16;
+    } while(index > 0);
+    return word;
+}
+
+constexpr size_t SYNTHETIC_LOG_PIECE_SIZE = 1024 * 1024;
+
+/**
+ * @brief Deterministic generator of log text with a chosen shape
+ *
+ * Only the bits of std::mt19937 are used, never a std distribution, so the same options give the
+ * same corpus with every standard library. The text is handed to write in pieces of whole lines of
+ * about SYNTHETIC_LOG_PIECE_SIZE, so a corpus written to a file is never in memory as a whole.
+ */
+template <typename Write>
+void generateSyntheticLog(const SyntheticLogOptions& options, const Write& write){
+    static const char* levels[] = {"DEBUG", "INFO", "INFO", "INFO", "WARN", "ERROR"};
+    static const char* modules[] = {"network", "storage", "scheduler", "auth", "ui", "parser"};
+    static const char* months[] = {"Jan", "Feb", "Mar", "Apr", "May", "Jun", "Jul", "Aug", "Sep", "Oct", "Nov", "Dec"};
+    std::vector<std::string> vocabulary;
+    vocabulary.reserve(options.vocabularySize);
+    for(size_t i = 0; i < std::max<size_t>(1, options.vocabularySize); i++){
+        vocabulary.push_back(getSyntheticWord(i));
+    }
+    std::mt19937 rng(options.seed);
+    auto uniform = [&rng]() { return rng() / 4294967296.0; };
+    std::string text;
+    text.reserve(SYNTHETIC_LOG_PIECE_SIZE + 4096);
+    const uint64_t startMillis = 1709251200000ull;  // 2024-03-01 00:00:00 UTC
+    char prefix[96];
+    for(size_t i = 0; i < options.lineCount; i++){
+        uint64_t millis = startMillis + i * 20 + rng() % 20;
+        uint64_t seconds = millis / 1000 - startMillis / 1000;
+        unsigned day = static_cast<unsigned>(1 + (seconds / 86400) % 28);
+        unsigned hour = static_cast<unsigned>((seconds / 3600) % 24);
+        unsigned minute = static_cast<unsigned>((seconds / 60) % 60);
+        unsigned second = static_cast<unsigned>(seconds % 60);
+        switch(options.timestampFormat){
+        case TimestampFormat::Iso:
+            std::snprintf(prefix, sizeof(prefix), "2024-03-%02u %02u:%02u:%02u.%03u ", day, hour, minute, second,
+                          static_cast<unsigned>(millis % 1000));
+            break;
+        case TimestampFormat::Syslog:
+            std::snprintf(prefix, sizeof(prefix), "%s %2u %02u:%02u:%02u ", months[2], day, hour, minute, second);
+            break;
+        case TimestampFormat::EpochMillis:
+            std::snprintf(prefix, sizeof(prefix), "%llu ", static_cast<unsigned long long>(millis));
+            break;
+        case TimestampFormat::None:
+            prefix[0] = '\0';
+            break;
+        }
+        text += prefix;
+        text += '[';
+        text += levels[rng() % 6];
+        text += "] ";
+        text += modules[rng() % 6];
+        text += ':';
+
+        // Exponential word count, at least one word
+        size_t wordCount = 1 + static_cast<size_t>(-options.meanMessageWords * std::log(1.0 - uniform()));
+        wordCount = std::min(wordCount, std::max<size_t>(1, options.maxMessageWords));
+        bool bSelected = uniform() < options.selectivity;
+        size_t tokenPosition = bSelected ? rng() % wordCount : wordCount;
+        for(size_t word = 0; word < wordCount; word++){
+            text += ' ';
+            if(word == tokenPosition){
+                text += options.matchToken;
+                continue;
+            }
+            // Cubing a uniform value skews the pick towards the first words, as in natural text
+            double u = uniform();
+            text += vocabulary[static_cast<size_t>(u * u * u * vocabulary.size())];
+        }
+        text += '\n';
+        if(text.size() >= SYNTHETIC_LOG_PIECE_SIZE){
+            write(std::string_view(text));
+            text.clear();
+        }
+    }
+    if(!text.empty()){
+        write(std::string_view(text));
+    }
+}
+
+inline std::string generateSyntheticLog(const SyntheticLogOptions& options){
+    std::string text;
+    text.reserve(options.lineCount * static_cast<size_t>(40 + options.meanMessageWords * 5));
+    generateSyntheticLog(options, [&text](std::string_view piece){ text += piece; });
+    return text;
+}
+
+} // namespace Bench
+
+#endif // BENCH_SYNTHETICLOG_H
@@ -38,7 +38,7 @@ FileInfo FileAdapter::toFileInfo(const Core::FileData& data) {
     auto systemTime = Core::TimeConverter::fromFileTime(modTime);
     
     // Create FileInfo with all properties
-    return FileInfo(
+    FileInfo info(
         QString::fromStdString(data.getFilePath()),
         QString::fromStdString(data.getFileName()),
         systemTime,
@@ -48,6 +48,8 @@ FileInfo FileAdapter::toFileInfo(const Core::FileData& data) {
         data.getFileRow(),
         data.isExists()
     );
+    info.loadState = static_cast<FileInfo::LoadState>(data.getLoadState());
+    return info;
 }
 
 bool FileAdapter::toFileInfo(const Core::FileDataPtr& data, FileInfo& info)
@@ -0,0 +1,30 @@
+#include "OutputLineAdapter.h"
+
+// Singleton instance
+OutputLineAdapter& OutputLineAdapter::getInstance() {
+    static OutputLineAdapter instance;
+    return instance;
+}
+
+QList<QOutputLine> OutputLineAdapter::toQOutputLineList(const std::vector<std::shared_ptr<Core::OutputLine>>& lines,
+                                                        const Core::OutputStyleTable& styles) const {
+    QList<QOutputLine> result;
+    for (const auto& coreOutputLine : lines) {
+        QOutputLine qOutputLine;
+        qOutputLine.m_fileId = coreOutputLine->getFileId();
+        qOutputLine.m_fileRow = coreOutputLine->getFileRow();
+        qOutputLine.m_lineIndex = coreOutputLine->getLineIndex();
+        for (const auto& span : coreOutputLine->getSpans()) {
+            QOutputSubLine qOutputSubLine;
+            qOutputSubLine.m_fileId = coreOutputLine->getFileId();
+            std::string_view content = coreOutputLine->getSpanContent(span);
+            qOutputSubLine.m_content = QString::fromUtf8(content.data(), static_cast<qsizetype>(content.size()));
+            // Lines are not copied on load, so a stray '\r' inside a line is normalized here
+            qOutputSubLine.m_content.replace(QChar('\r'), QChar(' '));
+            qOutputSubLine.m_color = QString::fromStdString(styles.getStyle(span.styleId).color);
+            qOutputLine.m_subLines.append(qOutputSubLine);
+        }
+        result.append(qOutputLine);
+    }
+    return result;
+}
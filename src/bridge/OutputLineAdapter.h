@@ -0,0 +1,34 @@
+#ifndef OUTPUTLINEADAPTER_H
+#define OUTPUTLINEADAPTER_H
+
+#include <QList>
+#include <memory>
+#include <vector>
+#include "../ui/models/qoutputline.h"
+#include "../core/OutputLine.h"
+
+/**
+ * @brief Adapter class to bridge between Qt UI (QOutputLine) and core logic (Core::OutputLine)
+ * 
+ * Copies the text of every span into a QString with the color of its style, as
+ * QtBridge::getOutputStringList() hands the output to the UI.
+ */
+class OutputLineAdapter {
+public:
+    // Singleton instance
+    static OutputLineAdapter& getInstance();
+
+    // Convert a vector of Core::OutputLine to a list of QOutputLine, styles has to resolve every span of lines
+    QList<QOutputLine> toQOutputLineList(const std::vector<std::shared_ptr<Core::OutputLine>>& lines,
+                                         const Core::OutputStyleTable& styles) const;
+
+private:
+    // Private constructor for singleton
+    OutputLineAdapter() = default;
+
+    // Prevent copying
+    OutputLineAdapter(const OutputLineAdapter&) = delete;
+    OutputLineAdapter& operator=(const OutputLineAdapter&) = delete;
+};
+
+#endif // OUTPUTLINEADAPTER_H
@@ -0,0 +1,104 @@
+#include "OutputRows.h"
+#include <algorithm>
+#include <map>
+#include <string>
+
+namespace {
+
+// Bytes of the UTF-8 sequence starting at position, an invalid byte stands alone as
+// QString::fromUtf8() replaces it with one U+FFFD
+int getUtf8SequenceLength(std::string_view utf8, size_t position) {
+    unsigned char lead = static_cast<unsigned char>(utf8[position]);
+    int length = lead < 0x80 ? 1 : lead < 0xC2 ? 0 : lead < 0xE0 ? 2 : lead < 0xF0 ? 3 : lead < 0xF5 ? 4 : 0;
+    if (length == 0 || position + length > utf8.size()) {
+        return 1;
+    }
+    for (int i = 1; i < length; ++i) {
+        if ((static_cast<unsigned char>(utf8[position + i]) & 0xC0) != 0x80) {
+            return 1;
+        }
+    }
+    return length;
+}
+
+// A four byte sequence is outside the BMP and takes a surrogate pair
+int getUtf16Length(int utf8SequenceLength) {
+    return utf8SequenceLength == 4 ? 2 : 1;
+}
+
+} // namespace
+
+OutputRows::OutputRows(int32_t beginRow, std::vector<std::shared_ptr<Core::OutputLine>> lines, const Core::OutputStyleTable& styles)
+    : m_beginRow(beginRow)
+    , m_lines(std::move(lines))
+    , m_styleColorIndexes(styles.size(), -1)
+{
+    // Styles of different filters and searches often share a color, they share its entry
+    std::map<std::string, int> colorIndexes;
+    for (const auto& line : m_lines) {
+        for (const auto& span : line->getSpans()) {
+            int& colorIndex = m_styleColorIndexes[span.styleId];
+            if (colorIndex != -1) {
+                continue;
+            }
+            const std::string& color = styles.getStyle(span.styleId).color;
+            if (color.empty()) {
+                colorIndex = DEFAULT_COLOR_INDEX;
+                continue;
+            }
+            auto it = colorIndexes.find(color);
+            if (it == colorIndexes.end()) {
+                it = colorIndexes.emplace(color, static_cast<int>(m_palette.size())).first;
+                m_palette.append(QColor(QString::fromStdString(color)));
+            }
+            colorIndex = it->second;
+        }
+    }
+}
+
+std::string_view OutputRows::getSpanUtf8(int index, int spanIndex) const {
+    const Core::OutputLine& line = *m_lines[index];
+    return line.getSpanContent(line.getSpans()[spanIndex]);
+}
+
+QString OutputRows::getSpanText(int index, int spanIndex) const {
+    return toDisplayText(getSpanUtf8(index, spanIndex));
+}
+
+int OutputRows::getSpanColorIndex(int index, int spanIndex) const {
+    return m_styleColorIndexes[m_lines[index]->getSpans()[spanIndex].styleId];
+}
+
+QString OutputRows::getLineText(int index) const {
+    return toDisplayText(m_lines[index]->getContent());
+}
+
+int OutputRows::toColumn(int index, int32_t byteOffset) const {
+    std::string_view utf8 = m_lines[index]->getContent();
+    size_t end = std::min(utf8.size(), static_cast<size_t>(std::max(0, byteOffset)));
+    int column = 0;
+    for (size_t position = 0; position < end; ) {
+        int length = getUtf8SequenceLength(utf8, position);
+        column += getUtf16Length(length);
+        position += length;
+    }
+    return column;
+}
+
+int32_t OutputRows::toByteOffset(int index, int column) const {
+    std::string_view utf8 = m_lines[index]->getContent();
+    size_t position = 0;
+    for (int currentColumn = 0; currentColumn < column && position < utf8.size(); ) {
+        int length = getUtf8SequenceLength(utf8, position);
+        currentColumn += getUtf16Length(length);
+        position += length;
+    }
+    return static_cast<int32_t>(position);
+}
+
+QString OutputRows::toDisplayText(std::string_view utf8) {
+    QString text = QString::fromUtf8(utf8.data(), static_cast<qsizetype>(utf8.size()));
+    // Lines are not copied on load, so a stray '\r' inside a line is normalized here
+    text.replace(QChar('\r'), QChar(' '));
+    return text;
+}
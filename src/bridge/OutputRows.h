@@ -0,0 +1,59 @@
+#ifndef OUTPUTROWS_H
+#define OUTPUTROWS_H
+
+#include <QColor>
+#include <QString>
+#include <QVector>
+#include <cstdint>
+#include <memory>
+#include <string_view>
+#include <vector>
+#include "../core/OutputLine.h"
+
+/**
+ * @brief Rows of the output handed to the UI without copying their text
+ *
+ * A row borrows the UTF-8 content of its core line, and the rows hold the core lines so the
+ * memory they point into stays alive as long as the rows do. Span colors are interned in a small
+ * palette, so a span only carries an index into it. Text is converted to a QString only when
+ * the UI asks for it to paint a row.
+ */
+class OutputRows {
+public:
+    static constexpr int DEFAULT_COLOR_INDEX = 0;   // unstyled text, painted in the text color of the view
+
+    OutputRows() = default;
+    // rows [beginRow, beginRow + lines.size()) of the output, styles has to resolve every span of lines
+    OutputRows(int32_t beginRow, std::vector<std::shared_ptr<Core::OutputLine>> lines, const Core::OutputStyleTable& styles);
+
+    int32_t getBeginRow() const { return m_beginRow; }
+    int32_t getEndRow() const { return m_beginRow + size(); }
+    int size() const { return static_cast<int>(m_lines.size()); }
+    bool isEmpty() const { return m_lines.empty(); }
+
+    // index is relative to getBeginRow()
+    const Core::OutputLine& getLine(int index) const { return *m_lines[index]; }
+    int getSpanCount(int index) const { return static_cast<int>(m_lines[index]->getSpans().size()); }
+    std::string_view getSpanUtf8(int index, int spanIndex) const;
+    QString getSpanText(int index, int spanIndex) const;
+    int getSpanColorIndex(int index, int spanIndex) const;
+    QString getLineText(int index) const;
+
+    // The core counts a row in UTF-8 bytes, the view in UTF-16 columns of its QString text.
+    // Offsets past the end of the row give the end of the row.
+    int toColumn(int index, int32_t byteOffset) const;
+    int32_t toByteOffset(int index, int column) const;
+
+    // Entry DEFAULT_COLOR_INDEX is an invalid color
+    const QVector<QColor>& getPalette() const { return m_palette; }
+
+private:
+    static QString toDisplayText(std::string_view utf8);
+
+    int32_t m_beginRow = 0;
+    std::vector<std::shared_ptr<Core::OutputLine>> m_lines;
+    std::vector<int> m_styleColorIndexes;   // by style id, -1 for styles no span of the rows uses
+    QVector<QColor> m_palette{QColor()};
+};
+
+#endif // OUTPUTROWS_H
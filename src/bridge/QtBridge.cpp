@@ -5,7 +5,7 @@
 #include "../core/FileSystem.h"
 #include "../core/AppUtils.h"
 #include "../core/Logger.h"
-#include "../core/StringConverter.h"
+#include "StringConverter.h"
 #include <QFile>
 #include <QTextStream>
 #include <QFileInfo>
@@ -19,6 +19,7 @@
 #include "../core/FilterData.h"
 #include "../core/SearchData.h"
 #include "bridge/FileAdapter.h"
+#include "bridge/OutputLineAdapter.h"
 #include "bridge/FilterAdapter.h"
 #include "bridge/SearchAdapter.h"
 #include <QFileDialog>
@@ -59,8 +60,19 @@ QtBridge::QtBridge() : activeWorkspaceId(-1) {
     
     // Setup LoggerBridge callback for UI updates
     Core::LoggerBridge::getInstance().setLogCallback([this](Core::LogLevel level, const std::string& message) {
-        emit logMessage(Core::StringConverter::toQString(message), static_cast<int>(level));
+        emit logMessage(StringConverter::toQString(message), static_cast<int>(level));
     });        
+
+    // Recompute output in the background, receivers in the UI thread get queued signals
+    workspaceManager->setOutputUpdateCallback([this](int64_t workspaceId, bool bFinished) {
+        emit outputUpdated(workspaceId, bFinished);
+    });
+    workspaceManager->setFileChangeCallback([this](int64_t workspaceId) {
+        emit followedFilesChanged(workspaceId);
+    });
+    workspaceManager->setFileLoadCallback([this](int64_t workspaceId, int32_t fileId, bool bLoaded) {
+        emit fileLoaded(workspaceId, fileId, bLoaded);
+    });
 }
 
 QtBridge::~QtBridge() {
@@ -182,6 +194,7 @@ void QtBridge::getFileListFromWorkspace(int64_t workspaceId, const std::function
                              fileData->getFileId(),
                              fileData->getFileRow(),
                              fileData->isExists());
+        fileInfo.loadState = static_cast<FileInfo::LoadState>(fileData->getLoadState());
         fileList.append(fileInfo);
     }
     callback(fileList);
@@ -203,6 +216,22 @@ void QtBridge::reloadFilesInWorkspace(int64_t workspaceId) {
     workspaceManager->reloadFilesInWorkspace(workspaceId);
 }
 
+bool QtBridge::updateLoadedFilesInWorkspace(int64_t workspaceId) {
+    return workspaceManager->updateLoadedFilesInWorkspace(workspaceId);
+}
+
+void QtBridge::setFollowFilesInWorkspace(int64_t workspaceId, bool follow) {
+    workspaceManager->setFollowFilesInWorkspace(workspaceId, follow);
+}
+
+bool QtBridge::isFollowingFilesInWorkspace(int64_t workspaceId) {
+    return workspaceManager->isFollowingFilesInWorkspace(workspaceId);
+}
+
+bool QtBridge::updateFollowedFilesInWorkspace(int64_t workspaceId) {
+    return workspaceManager->updateFollowedFilesInWorkspace(workspaceId);
+}
+
 ////////////////////////////////////////////////////////////
 // Filter management
 ////////////////////////////////////////////////////////////
@@ -407,34 +436,34 @@ bool QtBridge::saveWorkspaces() {
 
 void QtBridge::logDebug(const QString& message) {
     emit logMessage(message, 0); // Debug level
-    Core::LoggerBridge::getInstance().debug(Core::StringConverter::fromQString(message));
+    Core::LoggerBridge::getInstance().debug(StringConverter::fromQString(message));
 }
 
 void QtBridge::logInfo(const QString& message) {
     emit logMessage(message, 1); // Info level
-    Core::LoggerBridge::getInstance().info(Core::StringConverter::fromQString(message));
+    Core::LoggerBridge::getInstance().info(StringConverter::fromQString(message));
 }
 
 void QtBridge::logWarning(const QString& message) {
     emit logMessage(message, 2); // Warning level
-    Core::LoggerBridge::getInstance().warning(Core::StringConverter::fromQString(message));
+    Core::LoggerBridge::getInstance().warning(StringConverter::fromQString(message));
 }
 
 void QtBridge::logError(const QString& message) {
     emit logMessage(message, 3); // Error level
-    Core::LoggerBridge::getInstance().error(Core::StringConverter::fromQString(message));
+    Core::LoggerBridge::getInstance().error(StringConverter::fromQString(message));
 }
 
 void QtBridge::logCritical(const QString& message) {
     emit logMessage(message, 4); // Critical level
-    Core::LoggerBridge::getInstance().critical(Core::StringConverter::fromQString(message));
+    Core::LoggerBridge::getInstance().critical(StringConverter::fromQString(message));
 }
 
 void QtBridge::troubleshootingLog(const QString& category, const QString& operation, const QString& message) {
     Core::LoggerBridge::getInstance().troubleshootingLog(
-        Core::StringConverter::fromQString(category),
-        Core::StringConverter::fromQString(operation),
-        Core::StringConverter::fromQString(message)
+        StringConverter::fromQString(category),
+        StringConverter::fromQString(operation),
+        StringConverter::fromQString(message)
     );
     
     // 发送信号通知UI
@@ -443,7 +472,7 @@ void QtBridge::troubleshootingLog(const QString& category, const QString& operat
 
 void QtBridge::troubleshootingLogMessage(const QString& message) {
     Core::LoggerBridge::getInstance().troubleshootingLogMessage(
-        Core::StringConverter::fromQString(message)
+        StringConverter::fromQString(message)
     );
     
     // 发送信号通知UI
@@ -452,8 +481,8 @@ void QtBridge::troubleshootingLogMessage(const QString& message) {
 
 void QtBridge::troubleshootingLogFilterOperation(const QString& operation, const QString& filterString, const QString& message) {
     Core::LoggerBridge::getInstance().troubleshootingLogFilterOperation(
-        Core::StringConverter::fromQString(operation),
-        Core::StringConverter::fromQString(message)
+        StringConverter::fromQString(operation),
+        StringConverter::fromQString(message)
     );
     
     // 发送信号通知UI
@@ -478,25 +507,33 @@ int QtBridge::codeFromColor(const QColor& color) {
 
 
 
+void QtBridge::cancelOutputUpdate(int64_t workspaceId) {
+    workspaceManager->cancelOutputUpdate(workspaceId);
+}
+
+void QtBridge::setOutputWindow(int64_t workspaceId, int32_t topLineIndex, int32_t visiableLineCount) {
+    workspaceManager->setOutputWindow(workspaceId, topLineIndex, visiableLineCount);
+}
+
+int32_t QtBridge::getOutputLineCount(int64_t workspaceId) const {
+    return workspaceManager->getOutputLineCount(workspaceId);
+}
+
+int32_t QtBridge::getMaxFileLineCount(int64_t workspaceId) const {
+    return workspaceManager->getMaxFileLineCount(workspaceId);
+}
+
 QList<QOutputLine> QtBridge::getOutputStringList(int64_t workspaceId) const {
     std::vector<std::shared_ptr<Core::OutputLine>> coreOutputLines  = workspaceManager->getOutputStringList(workspaceId);
-    QList<QOutputLine> result;
-    for (const auto& coreOutputLine : coreOutputLines) {
-        QOutputLine qOutputLine;    
-        qOutputLine.m_fileId = coreOutputLine->getFileId();
-        qOutputLine.m_fileRow = coreOutputLine->getFileRow();
-        qOutputLine.m_lineIndex = coreOutputLine->getLineIndex();
-        for (const auto& coreOutputSubLine : coreOutputLine->getSubLines()) {
-            QOutputSubLine qOutputSubLine;
-            qOutputSubLine.m_fileId = coreOutputSubLine.getFileId();
-            qOutputSubLine.m_content = QString::fromStdString(std::string(coreOutputSubLine.getContent()));
-            qOutputSubLine.m_color = QString::fromStdString(coreOutputSubLine.getColor());
-            qOutputLine.m_subLines.append(qOutputSubLine);
-        }
-        result.append(qOutputLine);
-    }
+    // Taken after the lines, the style table only grows, so it resolves all of them
+    Core::OutputStyleTablePtr styles = workspaceManager->getOutputStyleTable(workspaceId);
+    return OutputLineAdapter::getInstance().toQOutputLineList(coreOutputLines, *styles);
+}
 
-    return result;  
+OutputRows QtBridge::getOutputRows(int64_t workspaceId, int32_t beginRow, int32_t rowCount) const {
+    std::vector<std::shared_ptr<Core::OutputLine>> coreOutputLines = workspaceManager->getOutputLines(workspaceId, beginRow, rowCount);
+    Core::OutputStyleTablePtr styles = workspaceManager->getOutputStyleTable(workspaceId);
+    return OutputRows(std::max(0, beginRow), std::move(coreOutputLines), *styles);
 }
 
 bool QtBridge::getNextMatchByFilter(int64_t workspaceId, int32_t filterId, int32_t lineIndex, int32_t charIndex,
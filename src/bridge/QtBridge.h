@@ -15,6 +15,7 @@
 #include "FilterAdapter.h"
 #include "SearchAdapter.h"
 #include "FileAdapter.h"
+#include "OutputRows.h"
 #include "qoutputline.h"
 #include "../core/WorkspaceData.h"
 
@@ -75,6 +76,10 @@ public:
     void commitFileUpdate(int64_t workspaceId);
     void rollbackFileUpdate(int64_t workspaceId);
     void reloadFilesInWorkspace(int64_t workspaceId);
+    bool updateLoadedFilesInWorkspace(int64_t workspaceId);
+    void setFollowFilesInWorkspace(int64_t workspaceId, bool follow);
+    bool isFollowingFilesInWorkspace(int64_t workspaceId);
+    bool updateFollowedFilesInWorkspace(int64_t workspaceId);
 
     // Filter operations for workspaces
     int32_t addFilterToWorkspace(int64_t workspaceId, const FilterConfig& filter);
@@ -102,7 +107,13 @@ public:
 
 
     // Output operations for workspaces
+    void cancelOutputUpdate(int64_t workspaceId);
+    void setOutputWindow(int64_t workspaceId, int32_t topLineIndex, int32_t visiableLineCount);
+    int32_t getOutputLineCount(int64_t workspaceId) const;
+    int32_t getMaxFileLineCount(int64_t workspaceId) const;
     QList<QOutputLine> getOutputStringList(int64_t workspaceId) const;
+    // Rows [beginRow, beginRow + rowCount) clamped to the output, their text stays in the core until painted
+    OutputRows getOutputRows(int64_t workspaceId, int32_t beginRow, int32_t rowCount) const;
     bool getNextMatchByFilter(int64_t workspaceId, int32_t filterId, int32_t lineIndex, int32_t charIndex,
                               int32_t& matchLineIndex, int32_t& matchCharStartIndex, int32_t& matchCharEndIndex);
     bool getPreviousMatchByFilter(int64_t workspaceId, int32_t filterId, int32_t lineIndex, int32_t charIndex,
@@ -135,6 +146,16 @@ signals:
     // Log signals
     void logMessage(const QString& message, int level);
     void troubleshootingLogSignal(const QString& category, const QString& operation, const QString& message);
+
+    // Emitted from a worker thread when new output of a workspace can be fetched,
+    // finished is false while the output is still being recomputed
+    void outputUpdated(qint64 workspaceId, bool finished);
+    // Emitted from a watcher thread when a followed file of a workspace changed,
+    // the receiver calls updateFollowedFilesInWorkspace() to load the change
+    void followedFilesChanged(qint64 workspaceId);
+    // Emitted from a pool thread for every file indexed while a workspace loads or reloads its files,
+    // the receiver calls updateLoadedFilesInWorkspace() to take the files in once all are indexed
+    void fileLoaded(qint64 workspaceId, qint32 fileId, bool loaded);
     
 private:
     // Prevent copying
@@ -1,13 +1,9 @@
 #include "StringConverter.h"
 
-namespace Core {
-
 std::string StringConverter::fromQString(const QString& qstr) {
     return qstr.toStdString();
 }
 
 QString StringConverter::toQString(const std::string& str) {
     return QString::fromStdString(str);
-}
-
-} // namespace Core 
\ No newline at end of file
+} 
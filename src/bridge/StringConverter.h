@@ -4,8 +4,6 @@
 #include <string>
 #include <QString>
 
-namespace Core {
-
 /**
  * @brief 字符串转换工具类，用于处理QString和std::string之间的转换
  */
@@ -26,6 +24,4 @@ public:
     static QString toQString(const std::string& str);
 };
 
-} // namespace Core
-
-#endif // STRINGCONVERTER_H 
\ No newline at end of file
+#endif // STRINGCONVERTER_H 
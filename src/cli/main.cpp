@@ -0,0 +1,355 @@
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <string>
+#include <vector>
+#include <nlohmann/json.hpp>
+#include "AppUtils.h"
+#include "Logger.h"
+#include "WorkspaceData.h"
+
+/**
+ * txtlogparser-cli runs the filters and searches of a saved workspace, or ones given on the
+ * command line, over log files and streams the output to stdout. It drives the same
+ * WorkspaceData and OutputData as the GUI, so a filter set gives the same lines in both.
+ */
+
+namespace {
+
+    using namespace Core;
+
+    constexpr int EXIT_MATCHED = 0;
+    constexpr int EXIT_NO_MATCH = 1;
+    constexpr int EXIT_ERROR = 2;
+
+    // Output lines fetched at a time, the size of an output chunk
+    constexpr int32_t OUTPUT_BATCH_LINES = 16384;
+
+    struct PatternOption {
+        std::string pattern;
+        bool bSearch = false;
+        bool bCaseSensitive = false;
+        bool bWholeWord = false;
+        bool bRegex = false;
+    };
+
+    struct Options {
+        std::string workspacesFilePath;
+        std::string workspace;
+        std::vector<PatternOption> patterns;
+        std::vector<std::string> files;
+        bool bLineNumbers = false;
+        bool bColor = false;
+        bool bCount = false;
+        bool bVerbose = false;
+    };
+
+    void printUsage(std::ostream& stream) {
+        stream <<
+            "Usage: txtlogparser-cli [options] [file...]\n"
+            "\n"
+            "Applies filters and searches to log files and writes the output lines to stdout.\n"
+            "Without filters every line is written, searches only mark text with --color.\n"
+            "\n"
+            "  -w, --workspace NAME|ID  use the filters, searches and, when no file is given,\n"
+            "                           the selected files of a saved workspace\n"
+            "      --workspaces PATH    workspaces file to read, the GUI's by default\n"
+            "  -f, --filter PATTERN     add a filter\n"
+            "  -s, --search PATTERN     add a search\n"
+            "  -c, --case-sensitive     following patterns match case\n"
+            "  -W, --whole-word         following patterns match whole words\n"
+            "  -r, --regex              following patterns are regular expressions\n"
+            "  -n, --line-number        prefix each line with its file and line number\n"
+            "      --color              color the text of filter and search matches\n"
+            "      --count              only write the match count of each filter and search\n"
+            "  -v, --verbose            log to stderr\n"
+            "  -h, --help               show this help\n"
+            "\n"
+            "Exit status is 0 when a line was written, 1 when none was and 2 on error.\n";
+    }
+
+    // Returns false with a message in error when the arguments are invalid
+    bool parseArguments(int argc, char* argv[], Options& options, bool& bHelp, std::string& error) {
+        bool bCaseSensitive = false;
+        bool bWholeWord = false;
+        bool bRegex = false;
+        bool bFilesOnly = false;
+        for(int i = 1; i < argc; ++i){
+            std::string arg = argv[i];
+            if(bFilesOnly || arg.empty() || arg[0] != '-'){
+                options.files.push_back(arg);
+                continue;
+            }
+            auto takeValue = [&](std::string& value) {
+                if(i + 1 >= argc){
+                    error = "missing value for " + arg;
+                    return false;
+                }
+                value = argv[++i];
+                return true;
+            };
+            if(arg == "--"){
+                bFilesOnly = true;
+            }else if(arg == "-h" || arg == "--help"){
+                bHelp = true;
+                return true;
+            }else if(arg == "-w" || arg == "--workspace"){
+                if(!takeValue(options.workspace)){
+                    return false;
+                }
+            }else if(arg == "--workspaces"){
+                if(!takeValue(options.workspacesFilePath)){
+                    return false;
+                }
+            }else if(arg == "-f" || arg == "--filter" || arg == "-s" || arg == "--search"){
+                PatternOption pattern;
+                pattern.bSearch = arg == "-s" || arg == "--search";
+                pattern.bCaseSensitive = bCaseSensitive;
+                pattern.bWholeWord = bWholeWord;
+                pattern.bRegex = bRegex;
+                if(!takeValue(pattern.pattern)){
+                    return false;
+                }
+                options.patterns.push_back(pattern);
+            }else if(arg == "-c" || arg == "--case-sensitive"){
+                bCaseSensitive = true;
+            }else if(arg == "-W" || arg == "--whole-word"){
+                bWholeWord = true;
+            }else if(arg == "-r" || arg == "--regex"){
+                bRegex = true;
+            }else if(arg == "-n" || arg == "--line-number"){
+                options.bLineNumbers = true;
+            }else if(arg == "--color"){
+                options.bColor = true;
+            }else if(arg == "--count"){
+                options.bCount = true;
+            }else if(arg == "-v" || arg == "--verbose"){
+                options.bVerbose = true;
+            }else{
+                error = "unknown option " + arg;
+                return false;
+            }
+        }
+        return true;
+    }
+
+    // Loads the workspace named or numbered by nameOrId from the workspaces file
+    bool loadWorkspace(const std::string& filePath, const std::string& nameOrId, WorkspaceData& workspace, std::string& error) {
+        std::ifstream file(filePath);
+        if(!file.is_open()){
+            error = "can not open workspaces file " + filePath;
+            return false;
+        }
+        try {
+            json rootObj = json::parse(file);
+            if(!rootObj.contains("workspaces") || !rootObj["workspaces"].is_array()){
+                error = "no workspaces in " + filePath;
+                return false;
+            }
+            // A name is looked for first, names made only of digits are allowed
+            const json* found = nullptr;
+            for(const auto& workspaceObj : rootObj["workspaces"]){
+                if(workspaceObj.value("name", "") == nameOrId){
+                    found = &workspaceObj;
+                    break;
+                }
+            }
+            for(const auto& workspaceObj : rootObj["workspaces"]){
+                if(found){
+                    break;
+                }
+                if(std::to_string(workspaceObj.value("id", int64_t(-1))) == nameOrId){
+                    found = &workspaceObj;
+                }
+            }
+            if(!found){
+                error = "no workspace " + nameOrId + " in " + filePath;
+                return false;
+            }
+            return workspace.loadFromJson(*found);
+        } catch (const std::exception& e) {
+            error = "invalid workspaces file " + filePath + ": " + e.what();
+            return false;
+        }
+    }
+
+    // Files on the command line replace the ones of the workspace
+    bool setFiles(WorkspaceData& workspace, const std::vector<std::string>& files, std::string& error) {
+        if(files.empty()){
+            return true;
+        }
+        for(const auto& file : workspace.getFileDataList()){
+            workspace.removeFile(file->getFileId());
+        }
+        for(size_t i = 0; i < files.size(); ++i){
+            std::error_code ec;
+            if(!std::filesystem::is_regular_file(files[i], ec)){
+                error = "no such file " + files[i];
+                return false;
+            }
+            workspace.addFile(static_cast<int32_t>(i), files[i]);
+        }
+        return true;
+    }
+
+    bool addPatterns(WorkspaceData& workspace, const std::vector<PatternOption>& patterns, std::string& error) {
+        auto nextFilterRow = static_cast<int32_t>(workspace.getFilterDataList().size());
+        auto nextSearchRow = static_cast<int32_t>(workspace.getSearchDataList().size());
+        for(const auto& option : patterns){
+            if(option.bSearch){
+                SearchData search(-1, nextSearchRow++, option.pattern, option.bCaseSensitive, option.bWholeWord,
+                                  option.bRegex, true, workspace.getNextSearchColor());
+                if(!search.getMatcher()){
+                    error = "invalid search " + option.pattern;
+                    return false;
+                }
+                workspace.addSearch(search);
+            }else{
+                FilterData filter(-1, nextFilterRow++, option.pattern, option.bCaseSensitive, option.bWholeWord,
+                                  option.bRegex, true, workspace.getNextFilterColor());
+                if(!filter.getMatcher()){
+                    error = "invalid filter " + option.pattern;
+                    return false;
+                }
+                workspace.addFilter(filter);
+            }
+        }
+        return true;
+    }
+
+    // "#rrggbb" as an ANSI 24-bit foreground color, empty for other colors
+    std::string toAnsiColor(const std::string& color) {
+        if(color.size() != 7 || color[0] != '#'){
+            return std::string();
+        }
+        char* end = nullptr;
+        unsigned long rgb = std::strtoul(color.c_str() + 1, &end, 16);
+        if(end != color.c_str() + color.size()){
+            return std::string();
+        }
+        return "\x1b[38;2;" + std::to_string((rgb >> 16) & 0xff) + ";" + std::to_string((rgb >> 8) & 0xff)
+            + ";" + std::to_string(rgb & 0xff) + "m";
+    }
+
+    void appendLine(std::string& buffer, const OutputLine& line, const OutputStyleTable& styles,
+                    std::vector<std::string>& ansiColors, const std::map<int32_t, std::string>& filePaths,
+                    const Options& options) {
+        if(options.bLineNumbers){
+            auto it = filePaths.find(line.getFileId());
+            if(it != filePaths.end()){
+                buffer += it->second;
+                buffer += ':';
+            }
+            buffer += std::to_string(line.getLineIndex() + 1);
+            buffer += ':';
+        }
+        if(!options.bColor){
+            buffer += line.getContent();
+        }else{
+            for(const auto& span : line.getSpans()){
+                if(ansiColors.size() <= static_cast<size_t>(span.styleId)){
+                    ansiColors.resize(styles.size());
+                    for(size_t styleId = 0; styleId < styles.size(); ++styleId){
+                        ansiColors[styleId] = toAnsiColor(styles.getStyle(static_cast<int32_t>(styleId)).color);
+                    }
+                }
+                const std::string& ansiColor = ansiColors[span.styleId];
+                buffer += ansiColor;
+                buffer += line.getSpanContent(span);
+                if(!ansiColor.empty()){
+                    buffer += "\x1b[0m";
+                }
+            }
+        }
+        buffer += '\n';
+    }
+
+    int writeOutput(WorkspaceData& workspace, const Options& options) {
+        std::map<int32_t/*fileId*/, std::string> filePaths;
+        for(const auto& file : workspace.getFileDataList()){
+            filePaths[file->getFileId()] = file->getFilePath();
+        }
+        int32_t lineCount = workspace.getOutputLineCount();
+        OutputStyleTablePtr styles = workspace.getOutputStyleTable();
+        std::vector<std::string> ansiColors;
+        std::string buffer;
+        for(int32_t beginLine = 0; beginLine < lineCount; beginLine += OUTPUT_BATCH_LINES){
+            buffer.clear();
+            for(const auto& line : workspace.getOutputLines(beginLine, OUTPUT_BATCH_LINES)){
+                appendLine(buffer, *line, *styles, ansiColors, filePaths, options);
+            }
+            if(std::fwrite(buffer.data(), 1, buffer.size(), stdout) != buffer.size()){
+                // stdout was closed, e.g. by head at the other end of a pipe
+                return lineCount > 0 ? EXIT_MATCHED : EXIT_NO_MATCH;
+            }
+        }
+        std::fflush(stdout);
+        return lineCount > 0 ? EXIT_MATCHED : EXIT_NO_MATCH;
+    }
+
+    int writeCounts(WorkspaceData& workspace) {
+        std::map<int32_t, int32_t> filterMatchCounts = workspace.getFilterMatchCounts();
+        std::map<int32_t, int32_t> searchMatchCounts = workspace.getSearchMatchCounts();
+        bool bMatched = false;
+        for(const auto& filter : workspace.getFilterDataList()){
+            int32_t count = filterMatchCounts[filter->getId()];
+            bMatched = bMatched || count > 0;
+            std::cout << "filter\t" << count << '\t' << filter->getPattern() << '\n';
+        }
+        for(const auto& search : workspace.getSearchDataList()){
+            int32_t count = searchMatchCounts[search->getId()];
+            bMatched = bMatched || count > 0;
+            std::cout << "search\t" << count << '\t' << search->getPattern() << '\n';
+        }
+        std::cout << "lines\t" << workspace.getOutputLineCount() << '\n';
+        std::cout.flush();
+        // Without patterns every line is output, so there is a match when there is a line
+        if(workspace.getFilterDataList().empty() && workspace.getSearchDataList().empty()){
+            bMatched = workspace.getOutputLineCount() > 0;
+        }
+        return bMatched ? EXIT_MATCHED : EXIT_NO_MATCH;
+    }
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    Options options;
+    bool bHelp = false;
+    std::string error;
+    if(!parseArguments(argc, argv, options, bHelp, error)){
+        std::cerr << "txtlogparser-cli: " << error << "\n\n";
+        printUsage(std::cerr);
+        return EXIT_ERROR;
+    }
+    if(bHelp){
+        printUsage(std::cout);
+        return EXIT_MATCHED;
+    }
+    // stdout only carries output lines, log messages go to stderr when asked for
+    Logger::getInstance().setConsoleStream(options.bVerbose ? &std::cerr : nullptr);
+
+    WorkspaceData workspace;
+    if(!options.workspace.empty()){
+        std::string filePath = options.workspacesFilePath.empty() ? AppUtils::getWorkspacesFilePath() : options.workspacesFilePath;
+        if(!loadWorkspace(filePath, options.workspace, workspace, error)){
+            std::cerr << "txtlogparser-cli: " << error << "\n";
+            return EXIT_ERROR;
+        }
+    }
+    if(!setFiles(workspace, options.files, error) || !addPatterns(workspace, options.patterns, error)){
+        std::cerr << "txtlogparser-cli: " << error << "\n";
+        return EXIT_ERROR;
+    }
+    if(workspace.getFileDataList().empty()){
+        std::cerr << "txtlogparser-cli: no file given\n";
+        return EXIT_ERROR;
+    }
+
+    // Activating loads the files and runs the filters and searches on the worker thread
+    workspace.setActive(true);
+    workspace.waitForOutputUpdate();
+    return options.bCount ? writeCounts(workspace) : writeOutput(workspace, options);
+}
@@ -0,0 +1,111 @@
+#include "AhoCorasick.h"
+#include <deque>
+
+namespace Core {
+
+    namespace {
+        inline unsigned char toLowerAscii(unsigned char c){
+            return (c >= 'A' && c <= 'Z') ? static_cast<unsigned char>(c | 0x20) : c;
+        }
+    }
+
+    int32_t AhoCorasick::addPattern(const std::string& pattern){
+        std::string lower(pattern);
+        for(auto& c : lower){
+            c = static_cast<char>(toLowerAscii(static_cast<unsigned char>(c)));
+        }
+        m_patterns.push_back(lower);
+        m_patternLengths.push_back(lower.size());
+        return static_cast<int32_t>(m_patterns.size() - 1);
+    }
+
+    void AhoCorasick::build(){
+        // Class 0 is every byte that does not occur in any pattern, upper case letters share the lower case class
+        m_byteClasses.fill(0);
+        m_byteClassCount = 1;
+        for(const auto& pattern : m_patterns){
+            for(unsigned char c : pattern){
+                if(m_byteClasses[c] == 0){
+                    m_byteClasses[c] = static_cast<uint8_t>(m_byteClassCount++);
+                }
+            }
+        }
+        for(int c = 'A'; c <= 'Z'; c++){
+            m_byteClasses[c] = m_byteClasses[toLowerAscii(static_cast<unsigned char>(c))];
+        }
+
+        // Trie
+        std::vector<std::vector<int32_t>> outputs(1);
+        m_transitions.assign(m_byteClassCount, -1);
+        for(size_t i = 0; i < m_patterns.size(); i++){
+            int32_t state = ROOT;
+            for(unsigned char c : m_patterns[i]){
+                int32_t& next = m_transitions[state * m_byteClassCount + m_byteClasses[c]];
+                if(next == -1){
+                    next = static_cast<int32_t>(outputs.size());
+                    outputs.emplace_back();
+                    m_transitions.resize(m_transitions.size() + m_byteClassCount, -1);
+                }
+                // re-read, the resize above may have moved the table
+                state = m_transitions[state * m_byteClassCount + m_byteClasses[c]];
+            }
+            outputs[state].push_back(static_cast<int32_t>(i));
+        }
+
+        // Breadth first, turn the trie into a complete automaton and merge the outputs of failure states
+        std::vector<int32_t> failure(outputs.size(), ROOT);
+        std::deque<int32_t> queue;
+        for(int32_t byteClass = 0; byteClass < m_byteClassCount; byteClass++){
+            int32_t& next = m_transitions[ROOT * m_byteClassCount + byteClass];
+            if(next == -1){
+                next = ROOT;
+            }else{
+                failure[next] = ROOT;
+                queue.push_back(next);
+            }
+        }
+        while(!queue.empty()){
+            int32_t state = queue.front();
+            queue.pop_front();
+            const auto& failureOutputs = outputs[failure[state]];
+            outputs[state].insert(outputs[state].end(), failureOutputs.begin(), failureOutputs.end());
+            for(int32_t byteClass = 0; byteClass < m_byteClassCount; byteClass++){
+                int32_t& next = m_transitions[state * m_byteClassCount + byteClass];
+                int32_t fallback = m_transitions[failure[state] * m_byteClassCount + byteClass];
+                if(next == -1){
+                    next = fallback;
+                }else{
+                    failure[next] = fallback;
+                    queue.push_back(next);
+                }
+            }
+        }
+
+        m_outputBegin.clear();
+        m_outputs.clear();
+        for(const auto& stateOutputs : outputs){
+            m_outputBegin.push_back(static_cast<int32_t>(m_outputs.size()));
+            m_outputs.insert(m_outputs.end(), stateOutputs.begin(), stateOutputs.end());
+        }
+        m_outputBegin.push_back(static_cast<int32_t>(m_outputs.size()));
+    }
+
+    void AhoCorasick::findAll(std::string_view text, std::vector<Occurrence>& occurrences) const{
+        if(m_patterns.empty()){
+            return;
+        }
+        const int32_t* transitions = m_transitions.data();
+        const int32_t* outputBegin = m_outputBegin.data();
+        int32_t state = ROOT;
+        for(size_t i = 0; i < text.size(); i++){
+            state = transitions[state * m_byteClassCount + m_byteClasses[static_cast<unsigned char>(text[i])]];
+            int32_t begin = outputBegin[state];
+            int32_t end = outputBegin[state + 1];
+            for(int32_t k = begin; k < end; k++){
+                int32_t patternIndex = m_outputs[k];
+                occurrences.push_back({patternIndex, i + 1 - m_patternLengths[patternIndex]});
+            }
+        }
+    }
+
+} // namespace Core
@@ -0,0 +1,50 @@
+#ifndef CORE_AHOCORASICK_H
+#define CORE_AHOCORASICK_H
+
+#include <array>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace Core {
+
+/**
+ * @brief Aho-Corasick automaton that finds every occurrence of a set of literals in one scan
+ *
+ * Matching is ASCII case-insensitive: patterns are lower-cased when added and the text is folded
+ * while scanning. Callers that need case-sensitive hits verify them against the original pattern.
+ * Transitions are stored as a dense table over the byte classes that occur in the patterns.
+ */
+class AhoCorasick {
+public:
+    struct Occurrence {
+        int32_t patternIndex;
+        size_t position;
+    };
+
+    // Returns the index reported in occurrences, patterns must not be empty
+    int32_t addPattern(const std::string& pattern);
+    void build();
+
+    bool empty() const { return m_patternLengths.empty(); }
+
+    // Append all, possibly overlapping, occurrences ordered by their end position
+    void findAll(std::string_view text, std::vector<Occurrence>& occurrences) const;
+
+private:
+    static constexpr int32_t ROOT = 0;
+
+    std::vector<std::string> m_patterns;
+    std::vector<size_t> m_patternLengths;
+
+    std::array<uint8_t, 256> m_byteClasses{};
+    int32_t m_byteClassCount = 1;
+    std::vector<int32_t> m_transitions;     // state * m_byteClassCount + class -> state
+    std::vector<int32_t> m_outputBegin;     // per state, range in m_outputs, size is state count + 1
+    std::vector<int32_t> m_outputs;         // pattern indexes ending in a state, including suffixes
+};
+
+} // namespace Core
+
+#endif // CORE_AHOCORASICK_H
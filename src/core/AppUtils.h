@@ -57,6 +57,13 @@ public:
         return getAppSupportDir() + getPathSeparator() + "workspaces.json";
     }
 
+    // Get the directory of the line index cache, next to the workspaces file
+    static std::string getLineIndexCacheDir() {
+        std::string path = getAppSupportDir() + "LineIndexCache" + getPathSeparator();
+        ensureDirExists(path);
+        return path;
+    }
+
 private:
     // Get the home directory
     static std::string getHomeDir() {
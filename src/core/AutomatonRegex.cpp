@@ -0,0 +1,876 @@
+#include "AutomatonRegex.h"
+#include <algorithm>
+#include <cctype>
+#include <map>
+
+namespace Core {
+
+    namespace {
+        // Upper bounds that keep compile time and memory predictable, larger patterns use std::regex
+        constexpr size_t MAX_PROGRAM_SIZE = 20000;
+        constexpr int32_t MAX_REPEAT_COUNT = 1000;
+        constexpr size_t MAX_DFA_STATES = 2048;
+
+        constexpr int32_t REPEAT_INFINITE = -1;
+
+        bool isWordByte(unsigned char c){
+            return std::isalnum(c) || c == '_';
+        }
+
+        struct Node {
+            enum class Kind { Empty, ByteSet, Concat, Alternate, Repeat, Assert };
+            Kind kind = Kind::Empty;
+            std::bitset<256> bytes;
+            int32_t assertKind = 0;
+            int32_t minCount = 0;
+            int32_t maxCount = 0;
+            bool greedy = true;
+            std::vector<std::unique_ptr<Node>> children;
+        };
+
+        using NodePtr = std::unique_ptr<Node>;
+    }
+
+    /**
+     * @brief Recursive descent parser for the supported ECMAScript subset, emits the VM program
+     */
+    class AutomatonRegexCompiler {
+    public:
+        AutomatonRegexCompiler(const std::string& pattern, bool caseSensitive)
+            : m_pattern(pattern), m_caseSensitive(caseSensitive) {}
+
+        bool compile(AutomatonRegex& regex){
+            NodePtr root = parseAlternate();
+            if(!root || m_bUnsupported || m_pos != m_pattern.size()){
+                return false;
+            }
+            m_regex = &regex;
+            if(!emit(*root)){
+                return false;
+            }
+            regex.m_program.push_back({AutomatonRegex::Op::Match, 0, 0});
+            return regex.m_program.size() <= MAX_PROGRAM_SIZE;
+        }
+
+    private:
+        bool atEnd() const { return m_pos >= m_pattern.size(); }
+        char peek() const { return m_pattern[m_pos]; }
+
+        NodePtr unsupported(){
+            m_bUnsupported = true;
+            return nullptr;
+        }
+
+        NodePtr makeBytes(const std::bitset<256>& bytes){
+            auto node = std::make_unique<Node>();
+            node->kind = Node::Kind::ByteSet;
+            node->bytes = bytes;
+            return node;
+        }
+
+        NodePtr makeAssert(int32_t kind){
+            auto node = std::make_unique<Node>();
+            node->kind = Node::Kind::Assert;
+            node->assertKind = kind;
+            return node;
+        }
+
+        void foldCase(std::bitset<256>& bytes) const{
+            if(m_caseSensitive){
+                return;
+            }
+            for(int c = 'a'; c <= 'z'; c++){
+                int upper = c - 'a' + 'A';
+                if(bytes.test(c) || bytes.test(upper)){
+                    bytes.set(c);
+                    bytes.set(upper);
+                }
+            }
+        }
+
+        static void addClassEscape(char c, std::bitset<256>& bytes){
+            std::bitset<256> set;
+            for(int i = 0; i < 256; i++){
+                unsigned char b = static_cast<unsigned char>(i);
+                bool in = false;
+                switch(std::tolower(static_cast<unsigned char>(c))){
+                    case 'd': in = std::isdigit(b) != 0; break;
+                    case 'w': in = isWordByte(b); break;
+                    case 's': in = std::isspace(b) != 0; break;
+                }
+                set.set(i, in);
+            }
+            if(std::isupper(static_cast<unsigned char>(c))){
+                set.flip();
+            }
+            bytes |= set;
+        }
+
+        static bool isClassEscape(char c){
+            return c == 'd' || c == 'D' || c == 'w' || c == 'W' || c == 's' || c == 'S';
+        }
+
+        bool parseHex(size_t digits, int& value){
+            if(m_pos + digits > m_pattern.size()){
+                return false;
+            }
+            value = 0;
+            for(size_t i = 0; i < digits; i++){
+                char c = m_pattern[m_pos + i];
+                if(!std::isxdigit(static_cast<unsigned char>(c))){
+                    return false;
+                }
+                value = value * 16 + (std::isdigit(static_cast<unsigned char>(c)) ? c - '0' : std::tolower(c) - 'a' + 10);
+            }
+            m_pos += digits;
+            return true;
+        }
+
+        // Parse a single character escape (after the backslash), shared by atoms and classes
+        bool parseCharEscape(char c, int& value){
+            switch(c){
+                case 't': value = '\t'; return true;
+                case 'n': value = '\n'; return true;
+                case 'r': value = '\r'; return true;
+                case 'f': value = '\f'; return true;
+                case 'v': value = '\v'; return true;
+                case '0':
+                    if(!atEnd() && std::isdigit(static_cast<unsigned char>(peek()))){
+                        return false;
+                    }
+                    value = 0;
+                    return true;
+                case 'x':
+                    return parseHex(2, value);
+                case 'u':
+                    return parseHex(4, value) && value < 0x80;
+                default:
+                    break;
+            }
+            if(std::isalnum(static_cast<unsigned char>(c))){
+                // backreferences, \c and unknown letter escapes
+                return false;
+            }
+            value = static_cast<unsigned char>(c);
+            return true;
+        }
+
+        static bool isNullable(const Node& node){
+            switch(node.kind){
+                case Node::Kind::Empty:
+                case Node::Kind::Assert:
+                    return true;
+                case Node::Kind::ByteSet:
+                    return false;
+                case Node::Kind::Concat:
+                    return std::all_of(node.children.begin(), node.children.end(),
+                                       [](const NodePtr& child) { return isNullable(*child); });
+                case Node::Kind::Alternate:
+                    return std::any_of(node.children.begin(), node.children.end(),
+                                       [](const NodePtr& child) { return isNullable(*child); });
+                case Node::Kind::Repeat:
+                    return node.minCount == 0 || isNullable(*node.children[0]);
+            }
+            return true;
+        }
+
+        NodePtr parseAlternate(){
+            NodePtr first = parseConcat();
+            if(!first){
+                return nullptr;
+            }
+            if(atEnd() || peek() != '|'){
+                return first;
+            }
+            auto node = std::make_unique<Node>();
+            node->kind = Node::Kind::Alternate;
+            node->children.push_back(std::move(first));
+            while(!atEnd() && peek() == '|'){
+                ++m_pos;
+                NodePtr next = parseConcat();
+                if(!next){
+                    return nullptr;
+                }
+                node->children.push_back(std::move(next));
+            }
+            return node;
+        }
+
+        NodePtr parseConcat(){
+            auto node = std::make_unique<Node>();
+            node->kind = Node::Kind::Concat;
+            while(!atEnd() && peek() != '|' && peek() != ')'){
+                NodePtr item = parseRepeat();
+                if(!item){
+                    return nullptr;
+                }
+                node->children.push_back(std::move(item));
+            }
+            return node;
+        }
+
+        bool parseCount(int32_t& value){
+            size_t start = m_pos;
+            value = 0;
+            while(!atEnd() && std::isdigit(static_cast<unsigned char>(peek()))){
+                value = value * 10 + (peek() - '0');
+                if(value > MAX_REPEAT_COUNT){
+                    return false;
+                }
+                ++m_pos;
+            }
+            return m_pos > start;
+        }
+
+        NodePtr parseRepeat(){
+            NodePtr atom = parseAtom();
+            if(!atom || atEnd()){
+                return atom;
+            }
+            int32_t minCount = 0;
+            int32_t maxCount = 0;
+            char c = peek();
+            if(c == '*'){
+                minCount = 0;
+                maxCount = REPEAT_INFINITE;
+                ++m_pos;
+            }else if(c == '+'){
+                minCount = 1;
+                maxCount = REPEAT_INFINITE;
+                ++m_pos;
+            }else if(c == '?'){
+                minCount = 0;
+                maxCount = 1;
+                ++m_pos;
+            }else if(c == '{'){
+                ++m_pos;
+                if(!parseCount(minCount)){
+                    return unsupported();
+                }
+                maxCount = minCount;
+                if(!atEnd() && peek() == ','){
+                    ++m_pos;
+                    maxCount = REPEAT_INFINITE;
+                    if(!atEnd() && peek() != '}' && !parseCount(maxCount)){
+                        return unsupported();
+                    }
+                }
+                if(atEnd() || peek() != '}' || (maxCount != REPEAT_INFINITE && maxCount < minCount)){
+                    return unsupported();
+                }
+                ++m_pos;
+            }else{
+                return atom;
+            }
+            if(atom->kind == Node::Kind::Assert){
+                return unsupported();
+            }
+            if((maxCount == REPEAT_INFINITE || maxCount > 1) && isNullable(*atom)){
+                // ECMAScript stops a loop on an empty iteration, which a Pike VM does not reproduce
+                return unsupported();
+            }
+            bool greedy = true;
+            if(!atEnd() && peek() == '?'){
+                greedy = false;
+                ++m_pos;
+            }
+            if(!atEnd() && (peek() == '*' || peek() == '+' || peek() == '?' || peek() == '{')){
+                return unsupported();
+            }
+            auto node = std::make_unique<Node>();
+            node->kind = Node::Kind::Repeat;
+            node->minCount = minCount;
+            node->maxCount = maxCount;
+            node->greedy = greedy;
+            node->children.push_back(std::move(atom));
+            return node;
+        }
+
+        NodePtr parseAtom(){
+            char c = peek();
+            switch(c){
+                case '(': {
+                    ++m_pos;
+                    if(!atEnd() && peek() == '?'){
+                        // only non-capturing groups, no lookahead
+                        if(m_pos + 1 < m_pattern.size() && m_pattern[m_pos + 1] == ':'){
+                            m_pos += 2;
+                        }else{
+                            return unsupported();
+                        }
+                    }
+                    NodePtr inner = parseAlternate();
+                    if(!inner || atEnd() || peek() != ')'){
+                        return unsupported();
+                    }
+                    ++m_pos;
+                    return inner;
+                }
+                case '[':
+                    ++m_pos;
+                    return parseClass();
+                case '.': {
+                    ++m_pos;
+                    std::bitset<256> bytes;
+                    bytes.set();
+                    bytes.reset('\n');
+                    bytes.reset('\r');
+                    return makeBytes(bytes);
+                }
+                case '^':
+                    ++m_pos;
+                    return makeAssert(AutomatonRegex::LineBegin);
+                case '$':
+                    ++m_pos;
+                    return makeAssert(AutomatonRegex::LineEnd);
+                case '\\':
+                    ++m_pos;
+                    return parseEscape();
+                case ')':
+                case ']':
+                case '}':
+                case '*':
+                case '+':
+                case '?':
+                case '{':
+                    return unsupported();
+                default: {
+                    ++m_pos;
+                    std::bitset<256> bytes;
+                    bytes.set(static_cast<unsigned char>(c));
+                    foldCase(bytes);
+                    return makeBytes(bytes);
+                }
+            }
+        }
+
+        NodePtr parseEscape(){
+            if(atEnd()){
+                return unsupported();
+            }
+            char c = peek();
+            ++m_pos;
+            if(c == 'b'){
+                return makeAssert(AutomatonRegex::WordBoundary);
+            }
+            if(c == 'B'){
+                return makeAssert(AutomatonRegex::NotWordBoundary);
+            }
+            std::bitset<256> bytes;
+            if(isClassEscape(c)){
+                addClassEscape(c, bytes);
+                return makeBytes(bytes);
+            }
+            int value = 0;
+            if(!parseCharEscape(c, value)){
+                return unsupported();
+            }
+            bytes.set(static_cast<unsigned char>(value));
+            foldCase(bytes);
+            return makeBytes(bytes);
+        }
+
+        // Read one class member, returns false for unsupported syntax. isSet is true for \d style escapes.
+        bool parseClassItem(int& value, bool& isSet, std::bitset<256>& set){
+            char c = peek();
+            ++m_pos;
+            isSet = false;
+            if(static_cast<unsigned char>(c) >= 0x80){
+                return false;
+            }
+            if(c == '['){
+                if(!atEnd() && (peek() == ':' || peek() == '.' || peek() == '=')){
+                    return false;
+                }
+                value = c;
+                return true;
+            }
+            if(c != '\\'){
+                value = c;
+                return true;
+            }
+            if(atEnd()){
+                return false;
+            }
+            char e = peek();
+            ++m_pos;
+            if(isClassEscape(e)){
+                isSet = true;
+                addClassEscape(e, set);
+                return true;
+            }
+            if(e == 'b'){
+                value = '\b';
+                return true;
+            }
+            return parseCharEscape(e, value);
+        }
+
+        NodePtr parseClass(){
+            bool negate = false;
+            if(!atEnd() && peek() == '^'){
+                negate = true;
+                ++m_pos;
+            }
+            if(atEnd() || peek() == ']'){
+                return unsupported();
+            }
+            std::bitset<256> bytes;
+            bool first = true;
+            while(!atEnd() && peek() != ']'){
+                if(peek() == '-' && !first && m_pos + 1 < m_pattern.size() && m_pattern[m_pos + 1] != ']'){
+                    // a '-' that is neither first nor last must belong to a range
+                    return unsupported();
+                }
+                int low = 0;
+                bool isSet = false;
+                if(!parseClassItem(low, isSet, bytes)){
+                    return unsupported();
+                }
+                first = false;
+                if(isSet){
+                    continue;
+                }
+                if(!atEnd() && peek() == '-' && m_pos + 1 < m_pattern.size() && m_pattern[m_pos + 1] != ']'){
+                    ++m_pos;
+                    int high = 0;
+                    bool highIsSet = false;
+                    std::bitset<256> unused;
+                    if(!parseClassItem(high, highIsSet, unused) || highIsSet || high < low){
+                        return unsupported();
+                    }
+                    for(int i = low; i <= high; i++){
+                        bytes.set(i);
+                    }
+                }else{
+                    bytes.set(low);
+                }
+            }
+            if(atEnd()){
+                return unsupported();
+            }
+            ++m_pos;
+            foldCase(bytes);
+            if(negate){
+                bytes.flip();
+            }
+            return makeBytes(bytes);
+        }
+
+        int32_t addInstruction(AutomatonRegex::Op op, int32_t x = 0, int32_t y = 0){
+            m_regex->m_program.push_back({op, x, y});
+            return static_cast<int32_t>(m_regex->m_program.size() - 1);
+        }
+
+        int32_t addByteSet(const std::bitset<256>& bytes){
+            auto& byteSets = m_regex->m_byteSets;
+            for(size_t i = 0; i < byteSets.size(); i++){
+                if(byteSets[i] == bytes){
+                    return static_cast<int32_t>(i);
+                }
+            }
+            byteSets.push_back(bytes);
+            return static_cast<int32_t>(byteSets.size() - 1);
+        }
+
+        int32_t programSize() const{
+            return static_cast<int32_t>(m_regex->m_program.size());
+        }
+
+        bool emit(const Node& node){
+            if(m_regex->m_program.size() > MAX_PROGRAM_SIZE){
+                return false;
+            }
+            auto& program = m_regex->m_program;
+            switch(node.kind){
+                case Node::Kind::Empty:
+                    return true;
+                case Node::Kind::ByteSet:
+                    addInstruction(AutomatonRegex::Op::ByteSet, addByteSet(node.bytes));
+                    return true;
+                case Node::Kind::Assert:
+                    addInstruction(AutomatonRegex::Op::Assert, node.assertKind);
+                    return true;
+                case Node::Kind::Concat:
+                    for(const auto& child : node.children){
+                        if(!emit(*child)){
+                            return false;
+                        }
+                    }
+                    return true;
+                case Node::Kind::Alternate: {
+                    std::vector<int32_t> jumps;
+                    for(size_t i = 0; i < node.children.size(); i++){
+                        bool last = (i + 1 == node.children.size());
+                        int32_t split = -1;
+                        if(!last){
+                            split = addInstruction(AutomatonRegex::Op::Split);
+                            program[split].x = programSize();
+                        }
+                        if(!emit(*node.children[i])){
+                            return false;
+                        }
+                        if(!last){
+                            jumps.push_back(addInstruction(AutomatonRegex::Op::Jump));
+                            program[split].y = programSize();
+                        }
+                    }
+                    for(int32_t jump : jumps){
+                        program[jump].x = programSize();
+                    }
+                    return true;
+                }
+                case Node::Kind::Repeat:
+                    return emitRepeat(node);
+            }
+            return false;
+        }
+
+        bool emitRepeat(const Node& node){
+            auto& program = m_regex->m_program;
+            const Node& child = *node.children[0];
+            for(int32_t i = 0; i < node.minCount; i++){
+                if(!emit(child)){
+                    return false;
+                }
+            }
+            if(node.maxCount == REPEAT_INFINITE){
+                int32_t split = addInstruction(AutomatonRegex::Op::Split);
+                int32_t body = programSize();
+                if(!emit(child)){
+                    return false;
+                }
+                addInstruction(AutomatonRegex::Op::Jump, split);
+                int32_t out = programSize();
+                program[split].x = node.greedy ? body : out;
+                program[split].y = node.greedy ? out : body;
+                return true;
+            }
+            // x{0,n} is emitted as (x(x(...)?)?)?
+            std::vector<int32_t> splits;
+            for(int32_t i = node.minCount; i < node.maxCount; i++){
+                int32_t split = addInstruction(AutomatonRegex::Op::Split);
+                splits.push_back(split);
+                int32_t body = programSize();
+                if(!emit(child)){
+                    return false;
+                }
+                program[split].x = body;
+            }
+            int32_t out = programSize();
+            for(int32_t split : splits){
+                if(node.greedy){
+                    program[split].y = out;
+                }else{
+                    program[split].y = program[split].x;
+                    program[split].x = out;
+                }
+            }
+            return true;
+        }
+
+        const std::string& m_pattern;
+        bool m_caseSensitive;
+        size_t m_pos = 0;
+        bool m_bUnsupported = false;
+        AutomatonRegex* m_regex = nullptr;
+    };
+
+    std::unique_ptr<AutomatonRegex> AutomatonRegex::compile(const std::string& pattern, bool caseSensitive){
+        std::unique_ptr<AutomatonRegex> regex(new AutomatonRegex());
+        AutomatonRegexCompiler compiler(pattern, caseSensitive);
+        if(!compiler.compile(*regex)){
+            return nullptr;
+        }
+        regex->buildStartByteSet();
+        regex->buildDfa();
+        return regex;
+    }
+
+    namespace {
+        // Follow every epsilon edge from pc. Assertions are passed through unconditionally,
+        // which over-approximates the real program as required by the prefilters.
+        void collectClosure(const std::vector<AutomatonRegex::Instruction>& program, int32_t pc,
+                            std::vector<uint8_t>& visited, std::vector<int32_t>& result){
+            std::vector<int32_t> stack;
+            stack.push_back(pc);
+            while(!stack.empty()){
+                int32_t cur = stack.back();
+                stack.pop_back();
+                if(visited[cur]){
+                    continue;
+                }
+                visited[cur] = 1;
+                const auto& inst = program[cur];
+                switch(inst.op){
+                    case AutomatonRegex::Op::Jump:
+                        stack.push_back(inst.x);
+                        break;
+                    case AutomatonRegex::Op::Split:
+                        stack.push_back(inst.y);
+                        stack.push_back(inst.x);
+                        break;
+                    case AutomatonRegex::Op::Assert:
+                        stack.push_back(cur + 1);
+                        break;
+                    case AutomatonRegex::Op::ByteSet:
+                    case AutomatonRegex::Op::Match:
+                        result.push_back(cur);
+                        break;
+                }
+            }
+        }
+    }
+
+    void AutomatonRegex::buildStartByteSet(){
+        std::vector<uint8_t> visited(m_program.size(), 0);
+        std::vector<int32_t> closure;
+        collectClosure(m_program, 0, visited, closure);
+        m_startByteSet.reset();
+        for(size_t pc = 0; pc < m_program.size(); pc++){
+            if(visited[pc] && m_program[pc].op == Op::Assert){
+                // the first byte alone can not decide an assertion at the match start
+                m_bUseStartByteSet = false;
+                return;
+            }
+        }
+        for(int32_t pc : closure){
+            if(m_program[pc].op == Op::Match){
+                m_bUseStartByteSet = false;
+                return;
+            }
+            m_startByteSet |= m_byteSets[m_program[pc].x];
+        }
+        m_bUseStartByteSet = true;
+    }
+
+    void AutomatonRegex::buildDfa(){
+        // Group bytes that no instruction can tell apart into classes
+        std::map<std::vector<bool>, int32_t> signatures;
+        for(int b = 0; b < 256; b++){
+            std::vector<bool> signature(m_byteSets.size());
+            for(size_t i = 0; i < m_byteSets.size(); i++){
+                signature[i] = m_byteSets[i].test(b);
+            }
+            auto it = signatures.find(signature);
+            if(it == signatures.end()){
+                it = signatures.emplace(signature, static_cast<int32_t>(signatures.size())).first;
+            }
+            m_byteClasses[b] = static_cast<uint8_t>(it->second);
+        }
+        m_byteClassCount = static_cast<int32_t>(signatures.size());
+        std::vector<int32_t> classRepresentative(m_byteClassCount, 0);
+        for(int b = 255; b >= 0; b--){
+            classRepresentative[m_byteClasses[b]] = b;
+        }
+
+        std::vector<uint8_t> visited(m_program.size(), 0);
+        std::vector<int32_t> startClosure;
+        collectClosure(m_program, 0, visited, startClosure);
+
+        std::map<std::vector<int32_t>, int32_t> stateIds;
+        std::vector<std::vector<int32_t>> states;
+        auto addState = [&](std::vector<int32_t> pcs) -> int32_t {
+            std::sort(pcs.begin(), pcs.end());
+            pcs.erase(std::unique(pcs.begin(), pcs.end()), pcs.end());
+            auto it = stateIds.find(pcs);
+            if(it != stateIds.end()){
+                return it->second;
+            }
+            int32_t id = static_cast<int32_t>(states.size());
+            stateIds.emplace(pcs, id);
+            states.push_back(std::move(pcs));
+            return id;
+        };
+        addState(startClosure);
+
+        std::vector<int32_t> transitions;
+        std::vector<uint8_t> accepting;
+        for(size_t stateId = 0; stateId < states.size(); stateId++){
+            if(states.size() > MAX_DFA_STATES){
+                return;
+            }
+            const std::vector<int32_t> pcs = states[stateId];
+            bool accept = false;
+            for(int32_t pc : pcs){
+                if(m_program[pc].op == Op::Match){
+                    accept = true;
+                }
+            }
+            accepting.push_back(accept ? 1 : 0);
+            for(int32_t byteClass = 0; byteClass < m_byteClassCount; byteClass++){
+                int b = classRepresentative[byteClass];
+                std::fill(visited.begin(), visited.end(), 0);
+                std::vector<int32_t> next;
+                for(int32_t pc : pcs){
+                    if(m_program[pc].op == Op::ByteSet && m_byteSets[m_program[pc].x].test(b)){
+                        collectClosure(m_program, pc + 1, visited, next);
+                    }
+                }
+                // unanchored search, a new match can start at every position
+                for(int32_t pc : startClosure){
+                    next.push_back(pc);
+                }
+                transitions.push_back(addState(std::move(next)));
+            }
+        }
+        m_dfaTransitions = std::move(transitions);
+        m_dfaAccepting = std::move(accepting);
+    }
+
+    bool AutomatonRegex::mayMatch(std::string_view text) const{
+        if(m_dfaTransitions.empty()){
+            return true;
+        }
+        int32_t state = 0;
+        if(m_dfaAccepting[state]){
+            return true;
+        }
+        const int32_t* transitions = m_dfaTransitions.data();
+        const uint8_t* accepting = m_dfaAccepting.data();
+        for(unsigned char c : text){
+            state = transitions[state * m_byteClassCount + m_byteClasses[c]];
+            if(accepting[state]){
+                return true;
+            }
+        }
+        return false;
+    }
+
+    bool AutomatonRegex::checkAssert(int32_t kind, std::string_view text, size_t pos) const{
+        switch(kind){
+            case LineBegin:
+                return pos == 0;
+            case LineEnd:
+                return pos == text.size();
+            case WordBoundary:
+            case NotWordBoundary: {
+                bool before = pos > 0 && isWordByte(static_cast<unsigned char>(text[pos - 1]));
+                bool after = pos < text.size() && isWordByte(static_cast<unsigned char>(text[pos]));
+                return (before != after) == (kind == WordBoundary);
+            }
+        }
+        return false;
+    }
+
+    namespace {
+        struct Thread {
+            int32_t pc;
+            size_t start;
+        };
+
+        // Per-thread scratch space so searches do not allocate for every line
+        struct VmScratch {
+            std::vector<Thread> current;
+            std::vector<Thread> next;
+            std::vector<uint32_t> marks;
+            std::vector<int32_t> stack;
+            uint32_t generation = 0;
+
+            void prepare(size_t programSize){
+                if(marks.size() < programSize){
+                    marks.assign(programSize, 0);
+                    generation = 0;
+                }
+            }
+
+            uint32_t nextGeneration(){
+                if(++generation == 0){
+                    std::fill(marks.begin(), marks.end(), 0);
+                    generation = 1;
+                }
+                return generation;
+            }
+        };
+    }
+
+    bool AutomatonRegex::search(std::string_view text, size_t from, bool anchored, bool notEmpty,
+                                size_t& matchStart, size_t& matchEnd) const{
+        static thread_local VmScratch scratch;
+        scratch.prepare(m_program.size());
+        std::vector<Thread>& current = scratch.current;
+        std::vector<Thread>& next = scratch.next;
+        std::vector<int32_t>& stack = scratch.stack;
+        current.clear();
+        next.clear();
+
+        // Add a thread and everything reachable through epsilon edges, highest priority first
+        auto addThread = [&](std::vector<Thread>& list, uint32_t generation, int32_t pc, size_t start, size_t pos){
+            stack.clear();
+            stack.push_back(pc);
+            while(!stack.empty()){
+                int32_t cur = stack.back();
+                stack.pop_back();
+                if(scratch.marks[cur] == generation){
+                    continue;
+                }
+                scratch.marks[cur] = generation;
+                const Instruction& inst = m_program[cur];
+                switch(inst.op){
+                    case Op::Jump:
+                        stack.push_back(inst.x);
+                        break;
+                    case Op::Split:
+                        stack.push_back(inst.y);
+                        stack.push_back(inst.x);
+                        break;
+                    case Op::Assert:
+                        if(checkAssert(inst.x, text, pos)){
+                            stack.push_back(cur + 1);
+                        }
+                        break;
+                    case Op::ByteSet:
+                    case Op::Match:
+                        list.push_back({cur, start});
+                        break;
+                }
+            }
+        };
+
+        bool matched = false;
+        uint32_t generation = scratch.nextGeneration();
+        for(size_t pos = from; ; pos++){
+            if(!matched && (!anchored || pos == from)){
+                if(current.empty() && !anchored && m_bUseStartByteSet){
+                    while(pos < text.size() && !m_startByteSet.test(static_cast<unsigned char>(text[pos]))){
+                        pos++;
+                    }
+                    if(pos >= text.size()){
+                        break;
+                    }
+                }
+                addThread(current, generation, 0, pos, pos);
+            }
+            if(current.empty() && (matched || anchored || pos >= text.size())){
+                break;
+            }
+            uint32_t nextGeneration = scratch.nextGeneration();
+            for(size_t i = 0; i < current.size(); i++){
+                const Thread& thread = current[i];
+                const Instruction& inst = m_program[thread.pc];
+                if(inst.op == Op::ByteSet){
+                    if(pos < text.size() && m_byteSets[inst.x].test(static_cast<unsigned char>(text[pos]))){
+                        addThread(next, nextGeneration, thread.pc + 1, thread.start, pos + 1);
+                    }
+                }else if(inst.op == Op::Match){
+                    if(notEmpty && thread.start == pos){
+                        continue;
+                    }
+                    matched = true;
+                    matchStart = thread.start;
+                    matchEnd = pos;
+                    // lower priority threads can not win any more
+                    break;
+                }
+            }
+            current.swap(next);
+            next.clear();
+            generation = nextGeneration;
+            if(pos >= text.size()){
+                break;
+            }
+        }
+        return matched;
+    }
+
+} // namespace Core
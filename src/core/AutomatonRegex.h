@@ -0,0 +1,90 @@
+#ifndef CORE_AUTOMATONREGEX_H
+#define CORE_AUTOMATONREGEX_H
+
+#include <array>
+#include <bitset>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace Core {
+
+/**
+ * @brief Linear-time regular expression engine
+ *
+ * Supports the ECMAScript subset that log filters use in practice: literals, '.', character
+ * classes, \d \w \s and their negations, ^ $ \b \B, groups, alternation and greedy or lazy
+ * quantifiers including {n,m}. Patterns are compiled to a small instruction program that is
+ * executed by a Pike VM, so matching never backtracks and runs in O(text * program) time.
+ * A DFA built at compile time rejects lines without any match before the VM runs.
+ *
+ * compile() returns nullptr for syntax outside that subset (backreferences, lookahead,
+ * POSIX bracket classes, ...), and the caller falls back to std::regex.
+ *
+ * A compiled AutomatonRegex is immutable, so one instance can be used from several threads.
+ */
+class AutomatonRegex {
+public:
+    static std::unique_ptr<AutomatonRegex> compile(const std::string& pattern, bool caseSensitive);
+
+    // Quick check, false means there is no match anywhere in text
+    bool mayMatch(std::string_view text) const;
+
+    // Find the leftmost match starting at or after from, with the same priorities as a backtracking
+    // ECMAScript engine. anchored only tries a match starting at from, notEmpty rejects empty matches.
+    bool search(std::string_view text, size_t from, bool anchored, bool notEmpty,
+                size_t& matchStart, size_t& matchEnd) const;
+
+    size_t getProgramSize() const { return m_program.size(); }
+    bool hasDfa() const { return !m_dfaTransitions.empty(); }
+
+    enum class Op : uint8_t {
+        ByteSet,    // consume one byte contained in m_byteSets[x]
+        Split,      // continue at x, then at y with lower priority
+        Jump,       // continue at x
+        Assert,     // zero width assertion of kind x
+        Match
+    };
+
+    enum AssertKind : int32_t {
+        LineBegin,
+        LineEnd,
+        WordBoundary,
+        NotWordBoundary
+    };
+
+    struct Instruction {
+        Op op;
+        int32_t x;
+        int32_t y;
+    };
+
+private:
+    friend class AutomatonRegexCompiler;
+
+    AutomatonRegex() = default;
+
+    void buildStartByteSet();
+    void buildDfa();
+    bool checkAssert(int32_t kind, std::string_view text, size_t pos) const;
+
+    std::vector<Instruction> m_program;
+    std::vector<std::bitset<256>> m_byteSets;
+
+    // Bytes that can start a match, used to skip ahead while no thread is alive
+    bool m_bUseStartByteSet = false;
+    std::bitset<256> m_startByteSet;
+
+    // Unanchored DFA over the program with all assertions treated as true, so it accepts a
+    // superset of the real matches. Empty when the state budget was exceeded.
+    std::array<uint8_t, 256> m_byteClasses{};
+    int32_t m_byteClassCount = 0;
+    std::vector<int32_t> m_dfaTransitions;  // state * m_byteClassCount + class -> state
+    std::vector<uint8_t> m_dfaAccepting;
+};
+
+} // namespace Core
+
+#endif // CORE_AUTOMATONREGEX_H
@@ -0,0 +1,46 @@
+#include "AutomatonRegexMatcher.h"
+
+namespace Core {
+
+    AutomatonRegexMatcher::AutomatonRegexMatcher(std::unique_ptr<AutomatonRegex> regex, std::string requiredLiteral)
+        : m_regex(std::move(regex)), m_requiredLiteral(std::move(requiredLiteral)) {}
+
+    void AutomatonRegexMatcher::findAll(std::string_view content, std::vector<PatternMatch>& matches) const{
+        if(!m_regex->mayMatch(content)){
+            return;
+        }
+        size_t matchStart = 0;
+        size_t matchEnd = 0;
+        if(!m_regex->search(content, 0, false, false, matchStart, matchEnd)){
+            return;
+        }
+        // Follows std::regex_iterator step by step. Until its first plain search after a match, the
+        // iterator does not pass match_prev_avail, so ^ and \b treat the retry position as line start.
+        bool prevAvailable = false;
+        while(true){
+            matches.emplace_back(matchStart, matchEnd - matchStart);
+            size_t from = matchEnd;
+            if(matchStart == matchEnd){
+                // After an empty match, first try a non-empty match at the same position, then move on by one
+                if(from == content.size()){
+                    break;
+                }
+                if(prevAvailable){
+                    if(m_regex->search(content, from, true, true, matchStart, matchEnd)){
+                        continue;
+                    }
+                }else if(m_regex->search(content.substr(from), 0, true, true, matchStart, matchEnd)){
+                    matchStart += from;
+                    matchEnd += from;
+                    continue;
+                }
+                ++from;
+            }
+            prevAvailable = true;
+            if(!m_regex->search(content, from, false, false, matchStart, matchEnd)){
+                break;
+            }
+        }
+    }
+
+} // namespace Core
@@ -0,0 +1,30 @@
+#ifndef CORE_AUTOMATONREGEXMATCHER_H
+#define CORE_AUTOMATONREGEXMATCHER_H
+
+#include "PatternMatcher.h"
+#include "AutomatonRegex.h"
+
+namespace Core {
+
+/**
+ * @brief Regex matcher running the linear-time AutomatonRegex engine
+ *
+ * Reports the same match sequence as std::cregex_iterator, including its handling of empty matches.
+ */
+class AutomatonRegexMatcher : public PatternMatcher {
+public:
+    AutomatonRegexMatcher(std::unique_ptr<AutomatonRegex> regex, std::string requiredLiteral);
+
+    void findAll(std::string_view content, std::vector<PatternMatch>& matches) const override;
+    bool mayMatch(std::string_view content) const override { return m_regex->mayMatch(content); }
+    const std::string& getRequiredLiteral() const override { return m_requiredLiteral; }
+    const char* getEngineName() const override { return "automaton"; }
+
+private:
+    std::unique_ptr<AutomatonRegex> m_regex;
+    std::string m_requiredLiteral;
+};
+
+} // namespace Core
+
+#endif // CORE_AUTOMATONREGEXMATCHER_H
@@ -0,0 +1,344 @@
+#include "CompressedInput.h"
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <vector>
+#include "ThreadPool.h"
+
+#ifdef TXTLOGPARSER_HAVE_ZLIB
+#include <zlib.h>
+#endif
+#ifdef TXTLOGPARSER_HAVE_ZSTD
+#include <zstd.h>
+#endif
+#ifdef TXTLOGPARSER_HAVE_LZMA
+#include <lzma.h>
+#endif
+
+namespace Core {
+
+    namespace {
+        const unsigned char GZIP_MAGIC[] = {0x1f, 0x8b};
+        const unsigned char ZSTD_MAGIC[] = {0x28, 0xb5, 0x2f, 0xfd};
+        const unsigned char XZ_MAGIC[] = {0xfd, 0x37, 0x7a, 0x58, 0x5a, 0x00};
+
+        // Output of a stream is grown by this much while its final size is unknown
+        constexpr size_t OUTPUT_CHUNK_SIZE = 1024 * 1024;
+
+        // Content sizes written in the file are only trusted up to these bounds, larger claims are
+        // decompressed as one stream so the output only grows as far as the content really goes
+        constexpr size_t BGZF_MAX_BLOCK_SIZE = 64 * 1024;
+        constexpr size_t ZSTD_MAX_EXPANSION_RATIO = 256;
+
+        template <size_t N>
+        bool startsWith(std::string_view data, const unsigned char (&magic)[N]){
+            return data.size() >= N && std::memcmp(data.data(), magic, N) == 0;
+        }
+
+        // An independently compressed part of the input and where its content goes in the output
+        struct CompressedPart {
+            size_t offset;
+            size_t size;
+            size_t outputOffset;
+            size_t outputSize;
+        };
+
+#if defined(TXTLOGPARSER_HAVE_ZLIB) || defined(TXTLOGPARSER_HAVE_ZSTD)
+        // Splits the parts into a few runs per thread, so every run can reuse one decoder context
+        bool decompressParts(const std::vector<CompressedPart>& parts, const std::function<bool(size_t, size_t)>& decompressRun){
+            ThreadPool& threadPool = ThreadPool::getInstance();
+            const size_t runCount = std::min(parts.size(), threadPool.getConcurrency() * 4);
+            std::atomic<bool> bFailed{false};
+            threadPool.parallelFor(runCount, [&](size_t run){
+                if(!decompressRun(parts.size() * run / runCount, parts.size() * (run + 1) / runCount)){
+                    bFailed = true;
+                }
+            });
+            return !bFailed;
+        }
+#endif
+
+#ifdef TXTLOGPARSER_HAVE_ZLIB
+        uint32_t readLittleEndian16(const unsigned char* bytes){
+            return static_cast<uint32_t>(bytes[0]) | static_cast<uint32_t>(bytes[1]) << 8;
+        }
+
+        uint32_t readLittleEndian32(const unsigned char* bytes){
+            return readLittleEndian16(bytes) | readLittleEndian16(bytes + 2) << 16;
+        }
+#endif
+    }
+
+    CompressionFormat CompressedInput::detectFormat(std::string_view data){
+        if(startsWith(data, GZIP_MAGIC)){
+            return CompressionFormat::Gzip;
+        }
+        if(startsWith(data, ZSTD_MAGIC)){
+            return CompressionFormat::Zstd;
+        }
+        if(startsWith(data, XZ_MAGIC)){
+            return CompressionFormat::Xz;
+        }
+        return CompressionFormat::None;
+    }
+
+    const char* CompressedInput::getFormatName(CompressionFormat format){
+        switch(format){
+        case CompressionFormat::Gzip: return "gzip";
+        case CompressionFormat::Zstd: return "zstd";
+        case CompressionFormat::Xz: return "xz";
+        default: return "none";
+        }
+    }
+
+    bool CompressedInput::isSupported(CompressionFormat format){
+        switch(format){
+#ifdef TXTLOGPARSER_HAVE_ZLIB
+        case CompressionFormat::Gzip: return true;
+#endif
+#ifdef TXTLOGPARSER_HAVE_ZSTD
+        case CompressionFormat::Zstd: return true;
+#endif
+#ifdef TXTLOGPARSER_HAVE_LZMA
+        case CompressionFormat::Xz: return true;
+#endif
+        case CompressionFormat::None: return true;
+        default: return false;
+        }
+    }
+
+    bool CompressedInput::decompress(CompressionFormat format, std::string_view data, std::string& output){
+        switch(format){
+        case CompressionFormat::Gzip: return decompressGzip(data, output);
+        case CompressionFormat::Zstd: return decompressZstd(data, output);
+        case CompressionFormat::Xz: return decompressXz(data, output);
+        default:
+            output.append(data.data(), data.size());
+            return true;
+        }
+    }
+
+#ifdef TXTLOGPARSER_HAVE_ZLIB
+    namespace {
+        // BGZF members carry their compressed size in a "BC" extra subfield and their content size in the trailer
+        bool findBgzfMembers(std::string_view data, size_t outputOffset, std::vector<CompressedPart>& members){
+            const unsigned char* bytes = reinterpret_cast<const unsigned char*>(data.data());
+            size_t offset = 0;
+            while(offset < data.size()){
+                const unsigned char* header = bytes + offset;
+                const size_t remaining = data.size() - offset;
+                const uint8_t FLAG_EXTRA = 0x04;
+                if(remaining < 18 || header[0] != GZIP_MAGIC[0] || header[1] != GZIP_MAGIC[1] || header[2] != Z_DEFLATED
+                   || (header[3] & FLAG_EXTRA) == 0){
+                    return false;
+                }
+                const size_t extraEnd = 12 + readLittleEndian16(header + 10);
+                size_t memberSize = 0;
+                for(size_t pos = 12; pos + 4 <= extraEnd && extraEnd <= remaining;){
+                    const size_t fieldSize = readLittleEndian16(header + pos + 2);
+                    if(header[pos] == 'B' && header[pos + 1] == 'C' && fieldSize == 2 && pos + 6 <= extraEnd){
+                        memberSize = readLittleEndian16(header + pos + 4) + 1;
+                    }
+                    pos += 4 + fieldSize;
+                }
+                if(memberSize < extraEnd + 8 || memberSize > remaining){
+                    return false;
+                }
+                const size_t memberOutputSize = readLittleEndian32(header + memberSize - 4);
+                if(memberOutputSize > BGZF_MAX_BLOCK_SIZE){
+                    return false;
+                }
+                members.push_back({offset, memberSize, outputOffset, memberOutputSize});
+                offset += memberSize;
+                outputOffset += memberOutputSize;
+            }
+            return !members.empty();
+        }
+
+        bool inflateStream(std::string_view data, std::string& output){
+            z_stream stream{};
+            if(inflateInit2(&stream, 16 + MAX_WBITS) != Z_OK){
+                return false;
+            }
+            const unsigned char* next = reinterpret_cast<const unsigned char*>(data.data());
+            size_t remaining = data.size();
+            auto refill = [&](){
+                // avail_in is 32 bit, larger inputs are fed in pieces
+                const size_t size = std::min<size_t>(remaining, 1u << 30);
+                stream.next_in = const_cast<Bytef*>(next);
+                stream.avail_in = static_cast<uInt>(size);
+                next += size;
+                remaining -= size;
+            };
+            bool bSucceeded = false;
+            while(true){
+                if(stream.avail_in == 0){
+                    refill();
+                }
+                const size_t outputSize = output.size();
+                output.resize(outputSize + OUTPUT_CHUNK_SIZE);
+                stream.next_out = reinterpret_cast<Bytef*>(&output[outputSize]);
+                stream.avail_out = static_cast<uInt>(OUTPUT_CHUNK_SIZE);
+                int result = inflate(&stream, Z_NO_FLUSH);
+                output.resize(outputSize + OUTPUT_CHUNK_SIZE - stream.avail_out);
+                if(result == Z_STREAM_END){
+                    if(stream.avail_in == 0){
+                        refill();
+                    }
+                    // Concatenated members continue the content, anything else after a member is ignored like gzip does
+                    if(stream.avail_in < 2 || stream.next_in[0] != GZIP_MAGIC[0] || stream.next_in[1] != GZIP_MAGIC[1]){
+                        bSucceeded = true;
+                        break;
+                    }
+                    inflateReset(&stream);
+                }else if(result != Z_OK){
+                    // Z_BUF_ERROR here means the input ended in the middle of a member
+                    break;
+                }
+            }
+            inflateEnd(&stream);
+            return bSucceeded;
+        }
+    }
+
+    bool CompressedInput::decompressGzip(std::string_view data, std::string& output){
+        const size_t outputBegin = output.size();
+        std::vector<CompressedPart> members;
+        if(!findBgzfMembers(data, outputBegin, members) || members.size() == 1){
+            return inflateStream(data, output);
+        }
+        output.resize(members.back().outputOffset + members.back().outputSize);
+        return decompressParts(members, [&](size_t begin, size_t end){
+            z_stream stream{};
+            if(inflateInit2(&stream, 16 + MAX_WBITS) != Z_OK){
+                return false;
+            }
+            bool bSucceeded = true;
+            for(size_t i = begin; i < end && bSucceeded; i++){
+                const CompressedPart& member = members[i];
+                inflateReset(&stream);
+                stream.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(data.data() + member.offset));
+                stream.avail_in = static_cast<uInt>(member.size);
+                stream.next_out = reinterpret_cast<Bytef*>(&output[0] + member.outputOffset);
+                stream.avail_out = static_cast<uInt>(member.outputSize);
+                bSucceeded = inflate(&stream, Z_FINISH) == Z_STREAM_END && stream.total_out == member.outputSize;
+            }
+            inflateEnd(&stream);
+            return bSucceeded;
+        });
+    }
+#else
+    bool CompressedInput::decompressGzip(std::string_view, std::string&){
+        return false;
+    }
+#endif
+
+#ifdef TXTLOGPARSER_HAVE_ZSTD
+    bool CompressedInput::decompressZstd(std::string_view data, std::string& output){
+        // Frames that record their content size can be decompressed side by side
+        std::vector<CompressedPart> frames;
+        size_t offset = 0;
+        size_t outputOffset = output.size();
+        const size_t maxOutputSize = std::max(data.size() * ZSTD_MAX_EXPANSION_RATIO, OUTPUT_CHUNK_SIZE);
+        while(offset < data.size()){
+            const size_t frameSize = ZSTD_findFrameCompressedSize(data.data() + offset, data.size() - offset);
+            const unsigned long long contentSize = ZSTD_getFrameContentSize(data.data() + offset, data.size() - offset);
+            if(ZSTD_isError(frameSize) || contentSize == ZSTD_CONTENTSIZE_ERROR){
+                return false;
+            }
+            if(contentSize == ZSTD_CONTENTSIZE_UNKNOWN || contentSize > maxOutputSize - (outputOffset - output.size())){
+                frames.clear();
+                break;
+            }
+            frames.push_back({offset, frameSize, outputOffset, static_cast<size_t>(contentSize)});
+            offset += frameSize;
+            outputOffset += static_cast<size_t>(contentSize);
+        }
+        if(frames.size() > 1){
+            output.resize(outputOffset);
+            return decompressParts(frames, [&](size_t begin, size_t end){
+                ZSTD_DCtx* context = ZSTD_createDCtx();
+                bool bSucceeded = context != nullptr;
+                for(size_t i = begin; i < end && bSucceeded; i++){
+                    const CompressedPart& frame = frames[i];
+                    size_t result = ZSTD_decompressDCtx(context, &output[0] + frame.outputOffset, frame.outputSize,
+                                                        data.data() + frame.offset, frame.size);
+                    bSucceeded = !ZSTD_isError(result) && result == frame.outputSize;
+                }
+                ZSTD_freeDCtx(context);
+                return bSucceeded;
+            });
+        }
+
+        ZSTD_DStream* stream = ZSTD_createDStream();
+        if(stream == nullptr){
+            return false;
+        }
+        ZSTD_inBuffer input = {data.data(), data.size(), 0};
+        size_t result = 0;
+        bool bSucceeded = true;
+        // result is 0 once a frame is complete and flushed, otherwise more input or output space is needed
+        while(input.pos < input.size || result != 0){
+            const size_t outputSize = output.size();
+            const size_t inputPos = input.pos;
+            output.resize(outputSize + OUTPUT_CHUNK_SIZE);
+            ZSTD_outBuffer outputBuffer = {&output[outputSize], OUTPUT_CHUNK_SIZE, 0};
+            result = ZSTD_decompressStream(stream, &outputBuffer, &input);
+            output.resize(outputSize + outputBuffer.pos);
+            if(ZSTD_isError(result) || (outputBuffer.pos == 0 && input.pos == inputPos)){
+                // no progress means the input ended in the middle of a frame
+                bSucceeded = false;
+                break;
+            }
+        }
+        ZSTD_freeDStream(stream);
+        return bSucceeded;
+    }
+#else
+    bool CompressedInput::decompressZstd(std::string_view, std::string&){
+        return false;
+    }
+#endif
+
+#ifdef TXTLOGPARSER_HAVE_LZMA
+    bool CompressedInput::decompressXz(std::string_view data, std::string& output){
+        lzma_stream stream = LZMA_STREAM_INIT;
+#if LZMA_VERSION >= 50040002
+        // Files with several blocks (xz -T) are decompressed by liblzma's own threads
+        lzma_mt options = {};
+        options.flags = LZMA_CONCATENATED;
+        options.threads = static_cast<uint32_t>(ThreadPool::getInstance().getConcurrency());
+        options.memlimit_threading = std::max<uint64_t>(lzma_physmem() / 4, 64 * 1024 * 1024);
+        options.memlimit_stop = UINT64_MAX;
+        lzma_ret result = lzma_stream_decoder_mt(&stream, &options);
+#else
+        lzma_ret result = lzma_stream_decoder(&stream, UINT64_MAX, LZMA_CONCATENATED);
+#endif
+        if(result != LZMA_OK){
+            return false;
+        }
+        stream.next_in = reinterpret_cast<const uint8_t*>(data.data());
+        stream.avail_in = data.size();
+        while(true){
+            const size_t outputSize = output.size();
+            output.resize(outputSize + OUTPUT_CHUNK_SIZE);
+            stream.next_out = reinterpret_cast<uint8_t*>(&output[outputSize]);
+            stream.avail_out = OUTPUT_CHUNK_SIZE;
+            result = lzma_code(&stream, stream.avail_in == 0 ? LZMA_FINISH : LZMA_RUN);
+            output.resize(outputSize + OUTPUT_CHUNK_SIZE - stream.avail_out);
+            if(result != LZMA_OK){
+                break;
+            }
+        }
+        lzma_end(&stream);
+        return result == LZMA_STREAM_END;
+    }
+#else
+    bool CompressedInput::decompressXz(std::string_view, std::string&){
+        return false;
+    }
+#endif
+
+} // namespace Core
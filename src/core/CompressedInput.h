@@ -0,0 +1,43 @@
+#ifndef CORE_COMPRESSEDINPUT_H
+#define CORE_COMPRESSEDINPUT_H
+
+#include <string>
+#include <string_view>
+
+namespace Core {
+
+enum class CompressionFormat {
+    None,
+    Gzip,
+    Zstd,
+    Xz
+};
+
+/**
+ * @brief Decompresses whole log files written by gzip, zstd or xz
+ *
+ * The format is told by the magic bytes, not by the file name. Files made of independent
+ * parts are decompressed in parallel on the ThreadPool: zstd files with several frames that
+ * record their content size (zstd -T0, pzstd) and BGZF files (bgzip), whose gzip members
+ * record their compressed size. Other files, and files whose recorded content sizes are
+ * implausible for their compressed size, are decompressed as one stream. Each format is
+ * only available when its library was found at build time, see isSupported().
+ */
+class CompressedInput {
+public:
+    static CompressionFormat detectFormat(std::string_view data);
+    static const char* getFormatName(CompressionFormat format);
+    static bool isSupported(CompressionFormat format);
+
+    // Appends the content of all frames or members in data to output, false if data is corrupt or truncated
+    static bool decompress(CompressionFormat format, std::string_view data, std::string& output);
+
+private:
+    static bool decompressGzip(std::string_view data, std::string& output);
+    static bool decompressZstd(std::string_view data, std::string& output);
+    static bool decompressXz(std::string_view data, std::string& output);
+};
+
+} // namespace Core
+
+#endif // CORE_COMPRESSEDINPUT_H
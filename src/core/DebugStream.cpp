@@ -1,5 +1,5 @@
 #include "DebugUtils.h"
-#include "StringConverter.h"
+#include "../bridge/StringConverter.h"
 #include <QColor>
 #include <QString>
 #include <QList>
@@ -10,6 +10,14 @@ using json = nlohmann::json;
 
 namespace Core {
 
+// Where loading a file into the output stands, see OutputData::loadFiles()
+enum class FileLoadState {
+    Unloaded,
+    Loading,
+    Loaded,
+    Failed
+};
+
 /**
  * @brief Pure C++ class representing file data
  * 
@@ -61,6 +69,10 @@ public:
 
     bool isExists() const { return m_isExists; }
     void setExists(bool exists) { m_isExists = exists; }
+
+    // Only changed on the thread that owns the workspace, not saved
+    FileLoadState getLoadState() const { return m_loadState; }
+    void setLoadState(FileLoadState state) { m_loadState = state; }
     
 private:
     int32_t m_id = -1;
@@ -71,6 +83,7 @@ private:
     int64_t m_fileSize = 0;
     bool m_selected = false;
     bool m_isExists = false;
+    FileLoadState m_loadState = FileLoadState::Unloaded;
     // Helper method to extract filename from path
     std::string extractFileName() const;
 };
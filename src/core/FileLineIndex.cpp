@@ -0,0 +1,229 @@
+#include "FileLineIndex.h"
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <new>
+#include <stdexcept>
+#include <cassert>
+#include "CompressedInput.h"
+#include "Logger.h"
+#include "ThreadPool.h"
+
+namespace Core {
+
+    namespace {
+        std::atomic<uint64_t> g_nextLineageId{1};
+
+        // Bytes in front of the appended tail compared with the previous index, to notice a file rewritten in place
+        constexpr uint64_t APPEND_CHECK_SIZE = 4096;
+    }
+
+    bool FileLineIndex::load(const std::string& path, bool bAllowMapping, LineIndexCache* cache){
+        // A corrupt or hostile file can make the content or its offsets too large to hold
+        try {
+            return loadContent(path, bAllowMapping, cache);
+        } catch (const std::bad_alloc&) {
+        } catch (const std::length_error&) {
+        }
+        (Logger::getInstance() << "FileLineIndex::load Out of memory while reading " << path).error();
+        m_lineOffsets = std::vector<uint64_t>();
+        m_trigramBloom = TrigramBloom();
+        m_blocks.clear();
+        m_size = 0;
+        return false;
+    }
+
+    bool FileLineIndex::loadContent(const std::string& path, bool bAllowMapping, LineIndexCache* cache){
+        m_lineOffsets.clear();
+        m_trigramBloom = TrigramBloom();
+        m_blocks.clear();
+        m_size = 0;
+        m_lineageId = g_nextLineageId++;
+        auto file = std::make_shared<MappedFile>();
+        if(!file->open(path, bAllowMapping)){
+            return false;
+        }
+        m_bCompressed = false;
+        CompressionFormat format = CompressedInput::detectFormat(file->view());
+        if(format != CompressionFormat::None){
+            if(!CompressedInput::isSupported(format)){
+                (Logger::getInstance() << "FileLineIndex::load " << CompressedInput::getFormatName(format)
+                                       << " support was not built in, can not read " << path).error();
+                return false;
+            }
+            std::string content;
+            if(!CompressedInput::decompress(format, file->view(), content)){
+                (Logger::getInstance() << "FileLineIndex::load Corrupt or truncated " << CompressedInput::getFormatName(format)
+                                       << " file: " << path).error();
+                return false;
+            }
+            auto decompressedFile = std::make_shared<MappedFile>();
+            decompressedFile->assign(std::move(content), file->getStatus());
+            file = std::move(decompressedFile);
+            m_bCompressed = true;
+        }
+        m_size = file->size();
+        m_status = file->getStatus();
+        m_blocks.push_back({std::move(file), 0, 0});
+        // Decompressing takes much longer than scanning, so offsets of compressed files are not cached
+        const bool bCacheable = cache != nullptr && !m_bCompressed && m_size >= LineIndexCache::MIN_FILE_SIZE;
+        const size_t bloomBlockCount = static_cast<size_t>((m_size + (uint64_t(1) << TrigramBloom::BLOCK_SHIFT) - 1) >> TrigramBloom::BLOCK_SHIFT);
+        if(!bCacheable || !cache->read(path, m_status, m_lineOffsets, m_trigramBloom.getWords()) || m_lineOffsets.empty()
+           || m_lineOffsets.back() != m_size || m_trigramBloom.getBlockCount() != bloomBlockCount){
+            m_lineOffsets.clear();
+            m_trigramBloom = TrigramBloom();
+            buildLineOffsets(0);
+            buildTrigramBloom(0);
+            if(bCacheable){
+                cache->write(path, m_status, m_lineOffsets, m_trigramBloom.getWords());
+            }
+        }
+        copyTailCheck();
+        return true;
+    }
+
+    bool FileLineIndex::loadAppended(const std::string& path, const FileLineIndex& previous){
+        m_lineOffsets.clear();
+        m_trigramBloom = TrigramBloom();
+        m_blocks.clear();
+        m_size = 0;
+        FileStatus status;
+        const uint64_t previousSize = previous.getSize();
+        // The appended part of a compressed file can not be told without decompressing all of it
+        if(previous.m_bCompressed || !MappedFile::getStatus(path, status) || !status.isSameFile(previous.getFileStatus()) || status.size < previousSize){
+            return false;
+        }
+        // Keep the complete lines, the last one is read and scanned again in case it was continued
+        const int32_t completeLineCount = previous.getCompleteLineCount();
+        const uint64_t beginOffset = completeLineCount < previous.getLineCount() ? previous.m_lineOffsets[completeLineCount] : previousSize;
+        const uint64_t checkOffset = previousSize - previous.m_tailCheck.size();
+        for(const ContentBlock& block : previous.m_blocks){
+            if(block.firstLine < completeLineCount){
+                m_blocks.push_back(block);
+            }
+        }
+        uint64_t readOffset = std::min(beginOffset, checkOffset);
+        int32_t firstLine = completeLineCount;
+        while(!m_blocks.empty() && m_blocks.back().content->size() <= status.size - readOffset){
+            readOffset = std::min(readOffset, m_blocks.back().offset);
+            firstLine = m_blocks.back().firstLine;
+            m_blocks.pop_back();
+        }
+        auto tail = std::make_shared<MappedFile>();
+        if(!tail->openRange(path, readOffset) || readOffset + tail->size() < previousSize
+           || (!previous.m_tailCheck.empty()
+               && std::memcmp(tail->data() + (checkOffset - readOffset), previous.m_tailCheck.data(), previous.m_tailCheck.size()) != 0)){
+            m_blocks.clear();
+            return false;
+        }
+        m_size = readOffset + tail->size();
+        m_status = tail->getStatus();
+        m_blocks.push_back({std::move(tail), readOffset, firstLine});
+        m_lineOffsets.reserve(static_cast<size_t>(completeLineCount) + static_cast<size_t>((m_size - previousSize) / 100) + 2);
+        m_lineOffsets.assign(previous.m_lineOffsets.begin(), previous.m_lineOffsets.begin() + completeLineCount);
+        buildLineOffsets(beginOffset);
+        m_trigramBloom = previous.m_trigramBloom;
+        buildTrigramBloom(completeLineCount);
+        copyTailCheck();
+        m_lineageId = previous.m_lineageId;
+        return true;
+    }
+
+    int32_t FileLineIndex::getCompleteLineCount() const{
+        int32_t lineCount = getLineCount();
+        if(lineCount > 0){
+            const MappedFile& lastContent = *m_blocks.back().content;
+            if(lastContent.data()[lastContent.size() - 1] != '\n'){
+                return lineCount - 1;
+            }
+        }
+        return lineCount;
+    }
+
+    const FileLineIndex::ContentBlock& FileLineIndex::getBlock(int32_t lineIndex) const{
+        if(m_blocks.size() == 1){
+            return m_blocks.front();
+        }
+        auto it = std::upper_bound(m_blocks.begin(), m_blocks.end(), lineIndex,
+            [](int32_t index, const ContentBlock& block){ return index < block.firstLine; });
+        return *(it - 1);
+    }
+
+    void FileLineIndex::copyTailCheck(){
+        const MappedFile& lastContent = *m_blocks.back().content;
+        uint64_t checkSize = std::min(lastContent.size(), APPEND_CHECK_SIZE);
+        m_tailCheck.assign(lastContent.data() + (lastContent.size() - checkSize), static_cast<size_t>(checkSize));
+    }
+
+    void FileLineIndex::buildLineOffsets(uint64_t beginOffset){
+        // New lines are only ever found in the last block
+        const ContentBlock& block = m_blocks.back();
+        const char* data = block.content->data();
+        const uint64_t size = m_size;
+        if(size == 0){
+            return;
+        }
+        if(m_lineOffsets.empty()){
+            //rough guess of 100 bytes per line to avoid most reallocations
+            m_lineOffsets.reserve(static_cast<size_t>(size / 100) + 2);
+        }
+        if(beginOffset < size){
+            m_lineOffsets.push_back(beginOffset);
+        }
+        const char* cur = data + (beginOffset - block.offset);
+        const char* end = data + (size - block.offset);
+        while(cur < end){
+            const char* newline = static_cast<const char*>(std::memchr(cur, '\n', static_cast<size_t>(end - cur)));
+            if(newline == nullptr){
+                break;
+            }
+            cur = newline + 1;
+            //a trailing newline does not start another line, same as std::getline
+            if(cur < end){
+                m_lineOffsets.push_back(block.offset + static_cast<uint64_t>(cur - data));
+            }
+        }
+        m_lineOffsets.push_back(size);
+    }
+
+    void FileLineIndex::buildTrigramBloom(int32_t beginLine){
+        if(m_lineOffsets.empty()){
+            return;
+        }
+        const size_t blockCount = static_cast<size_t>((m_size + (uint64_t(1) << TrigramBloom::BLOCK_SHIFT) - 1) >> TrigramBloom::BLOCK_SHIFT);
+        const size_t beginBlock = static_cast<size_t>(m_lineOffsets[beginLine] >> TrigramBloom::BLOCK_SHIFT);
+        m_trigramBloom.resize(blockCount);
+        if(beginBlock >= blockCount){
+            return;
+        }
+        const auto linesEnd = m_lineOffsets.end() - 1;
+        ThreadPool::getInstance().parallelFor(blockCount - beginBlock, [&](size_t i){
+            const size_t block = beginBlock + i;
+            m_trigramBloom.clearBlock(block);
+            auto first = std::lower_bound(m_lineOffsets.begin(), linesEnd, static_cast<uint64_t>(block) << TrigramBloom::BLOCK_SHIFT);
+            auto last = std::lower_bound(first, linesEnd, static_cast<uint64_t>(block + 1) << TrigramBloom::BLOCK_SHIFT);
+            for(auto it = first; it != last; ++it){
+                forEachTrigram(getLine(static_cast<int32_t>(it - m_lineOffsets.begin())), [&](uint32_t trigram){
+                    m_trigramBloom.add(block, trigram);
+                });
+            }
+        });
+    }
+
+    std::string_view FileLineIndex::getLine(int32_t lineIndex) const{
+        assert(lineIndex >= 0 && lineIndex < getLineCount());
+        const ContentBlock& block = getBlock(lineIndex);
+        const char* data = block.content->data();
+        uint64_t begin = m_lineOffsets[lineIndex] - block.offset;
+        uint64_t end = m_lineOffsets[lineIndex + 1] - block.offset;
+        //remove the last \n or \r\n
+        if(end > begin && data[end - 1] == '\n'){
+            --end;
+        }
+        if(end > begin && data[end - 1] == '\r'){
+            --end;
+        }
+        return std::string_view(data + begin, static_cast<size_t>(end - begin));
+    }
+
+} // namespace Core
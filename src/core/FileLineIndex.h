@@ -0,0 +1,88 @@
+#ifndef CORE_FILELINEINDEX_H
+#define CORE_FILELINEINDEX_H
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "LineIndexCache.h"
+#include "MappedFile.h"
+#include "TrigramBloom.h"
+
+namespace Core {
+
+/**
+ * @brief Line boundaries of one loaded file
+ * 
+ * The file content stays in a MappedFile and only the start offset of every line is
+ * kept, so getLine() returns a string_view straight into the mapping. The trailing
+ * "\n" or "\r\n" is excluded from the returned view; any other '\r' is left in place
+ * and normalized when the line is rendered. A gzip, zstd or xz compressed file is
+ * decompressed into memory first, see CompressedInput.
+ *
+ * While indexing, the trigrams of the lines starting in each 64 KB block go into a TrigramBloom,
+ * so searches can skip the blocks that can not contain their literal without reading them.
+ *
+ * A file that only grew since it was indexed can be indexed again with loadAppended(), which
+ * keeps the line offsets found so far and only reads and scans the new tail. The content is
+ * then held in several blocks shared with the previous index; a block is merged into the
+ * next one once that grew as large, so there are only O(log size) blocks.
+ */
+class FileLineIndex {
+public:
+    FileLineIndex() = default;
+
+    // Followed files should not be mapped, a mapping faults when the file is truncated under it.
+    // With a cache, the line offsets of a large file are taken from it or stored in it.
+    bool load(const std::string& path, bool bAllowMapping = true, LineIndexCache* cache = nullptr);
+    // Fails when the file was replaced, truncated or changed before the appended bytes
+    bool loadAppended(const std::string& path, const FileLineIndex& previous);
+
+    bool isLoaded() const { return !m_blocks.empty(); }
+    int32_t getLineCount() const { return static_cast<int32_t>(m_lineOffsets.empty() ? 0 : m_lineOffsets.size() - 1); }
+    std::string_view getLine(int32_t lineIndex) const;
+    uint64_t getSize() const { return m_size; }
+    const FileStatus& getFileStatus() const { return m_status; }
+    bool isMapped() const { return !m_blocks.empty() && m_blocks.front().content->isMapped(); }
+
+    const TrigramBloom& getTrigramBloom() const { return m_trigramBloom; }
+    size_t getTrigramBloomBlock(int32_t lineIndex) const { return static_cast<size_t>(m_lineOffsets[lineIndex] >> TrigramBloom::BLOCK_SHIFT); }
+
+    // Lines ending with a newline, only the last line can be incomplete and still grow
+    int32_t getCompleteLineCount() const;
+    // Indexes loaded with loadAppended() keep the lineage of the index they continue: the
+    // complete lines of an earlier index of the lineage are the same in every later one
+    uint64_t getLineageId() const { return m_lineageId; }
+
+private:
+    struct ContentBlock {
+        std::shared_ptr<const MappedFile> content;
+        uint64_t offset = 0;     // file offset of the first content byte
+        int32_t firstLine = 0;   // the block holds the lines from firstLine up to the next block's
+    };
+
+    bool loadContent(const std::string& path, bool bAllowMapping, LineIndexCache* cache);
+    const ContentBlock& getBlock(int32_t lineIndex) const;
+    void buildLineOffsets(uint64_t beginOffset);
+    // Fills the filters from the block of beginLine on
+    void buildTrigramBloom(int32_t beginLine);
+    void copyTailCheck();
+
+    std::vector<ContentBlock> m_blocks;
+    uint64_t m_size = 0;
+    FileStatus m_status;
+    uint64_t m_lineageId = 0;
+    bool m_bCompressed = false;   // the blocks hold the decompressed content
+    // Copy of the last bytes, a mapping would already show the new content of a file rewritten in place
+    std::string m_tailCheck;
+    // start offset of every line followed by the file size, so line i spans [m_lineOffsets[i], m_lineOffsets[i+1])
+    std::vector<uint64_t> m_lineOffsets;
+    TrigramBloom m_trigramBloom;
+};
+
+using FileLineIndexPtr = std::shared_ptr<FileLineIndex>;
+
+} // namespace Core
+
+#endif // CORE_FILELINEINDEX_H
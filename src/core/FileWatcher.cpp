@@ -0,0 +1,157 @@
+#include "FileWatcher.h"
+#include <filesystem>
+
+#ifdef __linux__
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/inotify.h>
+#include <unistd.h>
+#endif
+
+namespace Core {
+
+FileWatcher::FileWatcher(ChangeCallback callback)
+    : m_callback(std::move(callback)) {
+}
+
+FileWatcher::~FileWatcher() {
+    stop();
+}
+
+void FileWatcher::setPaths(const std::vector<std::string>& paths) {
+    if (paths == m_paths && m_thread.joinable()) {
+        return;
+    }
+    stop();
+    m_paths = paths;
+    if (!m_paths.empty()) {
+        start();
+    }
+}
+
+void FileWatcher::start() {
+#ifdef __linux__
+    m_inotifyFd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if (m_inotifyFd >= 0 && pipe2(m_wakeFds, O_NONBLOCK | O_CLOEXEC) != 0) {
+        ::close(m_inotifyFd);
+        m_inotifyFd = -1;
+    }
+    if (m_inotifyFd >= 0) {
+        for (const auto& path : m_paths) {
+            std::filesystem::path filePath(path);
+            std::string directory = filePath.has_parent_path() ? filePath.parent_path().string() : ".";
+            // A rotation replaces the file, so its directory is watched rather than the file itself
+            int watchDescriptor = inotify_add_watch(m_inotifyFd, directory.c_str(),
+                IN_MODIFY | IN_CLOSE_WRITE | IN_ATTRIB | IN_CREATE | IN_DELETE | IN_MOVED_FROM | IN_MOVED_TO);
+            if (watchDescriptor >= 0) {
+                m_watchedNames[watchDescriptor].insert(filePath.filename().string());
+            }
+        }
+    }
+#endif
+    m_thread = std::thread(&FileWatcher::watchLoop, this);
+}
+
+void FileWatcher::stop() {
+    if (m_thread.joinable()) {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_bStopping = true;
+        }
+        m_condition.notify_all();
+#ifdef __linux__
+        if (m_wakeFds[1] >= 0) {
+            char wake = 0;
+            (void)::write(m_wakeFds[1], &wake, 1);
+        }
+#endif
+        m_thread.join();
+    }
+#ifdef __linux__
+    if (m_inotifyFd >= 0) {
+        ::close(m_inotifyFd);
+        m_inotifyFd = -1;
+    }
+    for (int& fd : m_wakeFds) {
+        if (fd >= 0) {
+            ::close(fd);
+            fd = -1;
+        }
+    }
+    m_watchedNames.clear();
+#endif
+    m_bStopping = false;
+}
+
+void FileWatcher::watchLoop() {
+    std::vector<FileStatus> statuses = readStatuses();
+    while (true) {
+        bool bEvent = waitForEvent(POLL_INTERVAL);
+        if (waitForStop(bEvent ? SETTLE_INTERVAL : std::chrono::milliseconds(0))) {
+            return;
+        }
+        std::vector<FileStatus> currentStatuses = readStatuses();
+        if (currentStatuses != statuses) {
+            statuses = std::move(currentStatuses);
+            m_callback();
+        }
+    }
+}
+
+bool FileWatcher::waitForStop(std::chrono::milliseconds timeout) {
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_condition.wait_for(lock, timeout, [this] { return m_bStopping; });
+    return m_bStopping;
+}
+
+std::vector<FileStatus> FileWatcher::readStatuses() const {
+    std::vector<FileStatus> statuses(m_paths.size());
+    for (size_t i = 0; i < m_paths.size(); i++) {
+        // A file missing in the middle of a rotation keeps the empty status until it is back
+        MappedFile::getStatus(m_paths[i], statuses[i]);
+    }
+    return statuses;
+}
+
+#ifdef __linux__
+bool FileWatcher::waitForEvent(std::chrono::milliseconds timeout) {
+    if (m_inotifyFd < 0) {
+        waitForStop(timeout);
+        return false;
+    }
+    pollfd fds[2] = {{m_inotifyFd, POLLIN, 0}, {m_wakeFds[0], POLLIN, 0}};
+    if (poll(fds, 2, static_cast<int>(timeout.count())) <= 0) {
+        return false;
+    }
+    return (fds[0].revents & POLLIN) && readEvents();
+}
+
+bool FileWatcher::readEvents() {
+    // Only events about the watched names count, other files in the same directories are ignored
+    bool bWatchedFileChanged = false;
+    alignas(inotify_event) char buffer[4096];
+    ssize_t length;
+    while ((length = ::read(m_inotifyFd, buffer, sizeof(buffer))) > 0) {
+        for (char* pos = buffer; pos < buffer + length;) {
+            const inotify_event* event = reinterpret_cast<const inotify_event*>(pos);
+            pos += sizeof(inotify_event) + event->len;
+            if (event->mask & IN_Q_OVERFLOW) {
+                bWatchedFileChanged = true;
+                continue;
+            }
+            auto it = m_watchedNames.find(event->wd);
+            if (it != m_watchedNames.end() && event->len > 0 && it->second.count(event->name) > 0) {
+                bWatchedFileChanged = true;
+            }
+        }
+    }
+    return bWatchedFileChanged;
+}
+#else
+bool FileWatcher::waitForEvent(std::chrono::milliseconds timeout) {
+    waitForStop(timeout);
+    return false;
+}
+#endif
+
+} // namespace Core
@@ -0,0 +1,68 @@
+#ifndef CORE_FILEWATCHER_H
+#define CORE_FILEWATCHER_H
+
+#include <chrono>
+#include <condition_variable>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <set>
+#include <string>
+#include <thread>
+#include <vector>
+#include "MappedFile.h"
+
+namespace Core {
+
+/**
+ * @brief Reports when any of a set of files grows, is replaced or is truncated
+ *
+ * A thread compares the FileStatus of every path with the one it reported last. On Linux
+ * it wakes up on inotify events of the directories holding the files, so a rotation that
+ * creates a new file under a watched path is noticed too. It also checks every
+ * POLL_INTERVAL, which is all it does on other platforms or file systems without events.
+ */
+class FileWatcher {
+public:
+    // Called on the watcher thread
+    using ChangeCallback = std::function<void()>;
+
+    explicit FileWatcher(ChangeCallback callback);
+    ~FileWatcher();
+
+    FileWatcher(const FileWatcher&) = delete;
+    FileWatcher& operator=(const FileWatcher&) = delete;
+
+    // Watches paths instead of the files before, an empty list stops watching
+    void setPaths(const std::vector<std::string>& paths);
+
+private:
+    static constexpr std::chrono::milliseconds POLL_INTERVAL{500};
+    // Writers append in bursts, a change is reported once the burst settled
+    static constexpr std::chrono::milliseconds SETTLE_INTERVAL{100};
+
+    void start();
+    void stop();
+    void watchLoop();
+    bool waitForEvent(std::chrono::milliseconds timeout);
+    bool waitForStop(std::chrono::milliseconds timeout);
+    std::vector<FileStatus> readStatuses() const;
+
+    ChangeCallback m_callback;
+    std::vector<std::string> m_paths;
+    std::thread m_thread;
+    std::mutex m_mutex;
+    std::condition_variable m_condition;
+    bool m_bStopping = false;
+#ifdef __linux__
+    bool readEvents();
+
+    int m_inotifyFd = -1;
+    int m_wakeFds[2] = {-1, -1};
+    std::map<int/*watch descriptor*/, std::set<std::string>/*file names*/> m_watchedNames;
+#endif
+};
+
+} // namespace Core
+
+#endif // CORE_FILEWATCHER_H
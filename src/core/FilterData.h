@@ -7,6 +7,7 @@
 #include <vector>
 #include "Logger.h"
 #include "OutputLine.h"
+#include "PatternMatcher.h"
 #include <nlohmann/json.hpp>
 #include <string_view>
 using json = nlohmann::json;
@@ -43,16 +44,16 @@ public:
     
     // Getters and setters
     const std::string& getPattern() const { return m_filterPattern; }
-    void setPattern(const std::string& pattern) { m_filterPattern = pattern; }
+    void setPattern(const std::string& pattern) { m_filterPattern = pattern; compileMatcher(); }
     
     bool isCaseSensitive() const { return m_caseSensitive; }
-    void setCaseSensitive(bool value) { m_caseSensitive = value; }
+    void setCaseSensitive(bool value) { m_caseSensitive = value; compileMatcher(); }
     
     bool isWholeWord() const { return m_wholeWord; }
-    void setWholeWord(bool value) { m_wholeWord = value; }
+    void setWholeWord(bool value) { m_wholeWord = value; compileMatcher(); }
     
     bool isRegex() const { return m_regex; }
-    void setRegex(bool value) { m_regex = value;}
+    void setRegex(bool value) { m_regex = value; compileMatcher(); }
     
     bool isEnabled() const { return m_enabled; }
     void setEnabled(bool value) { m_enabled = value;}
@@ -62,9 +63,13 @@ public:
 
     void update(const FilterData& filter, bool* pChanged = nullptr);
 
-    void apply( const std::string_view& lineContent, std::list<OutputSubLine>& sublines);
-    void applyNonRegex( const std::string_view& lineContent, std::list<OutputSubLine>& sublines);
-    void applyRegex( const std::string_view& lineContent, std::list<OutputSubLine>& sublines);
+    const PatternMatcherPtr& getMatcher() const { return m_matcher; }
+
+    // Style of the spans this filter matches
+    OutputStyle getStyle() const;
+
+    // Split part, which starts at partOffset in the line, into matched and unmatched spans
+    void apply(std::string_view part, uint32_t partOffset, int32_t styleId, std::vector<OutputSpan>& spans) const;
 private:
     int32_t m_filterId;
     int32_t m_filterRow;
@@ -74,6 +79,9 @@ private:
     bool m_regex = false;
     bool m_enabled = true;
     std::string m_colorString;
+    PatternMatcherPtr m_matcher;   // compiled from pattern, case, whole-word and regex flags, null if invalid
+
+    void compileMatcher();
 };
 
 // Smart pointer type for FilterData
@@ -0,0 +1,152 @@
+#include "FilterSetMatcher.h"
+#include "SubstringSearcher.h"
+#include <algorithm>
+#include <cstring>
+
+namespace Core {
+
+    namespace {
+        struct Piece {
+            size_t start;
+            size_t end;
+            int32_t entryIndex;     // -1 for a part no filter has matched yet
+        };
+
+        // Per-thread buffers reused for every line
+        struct FilterSetScratch {
+            std::vector<AhoCorasick::Occurrence> occurrences;
+            std::vector<std::vector<size_t>> literalStarts;     // per entry, sorted
+            std::vector<Piece> pieces;
+            std::vector<Piece> nextPieces;
+            std::vector<PatternMatch> matches;
+        };
+    }
+
+    FilterSetMatcher::FilterSetMatcher(const std::map<int32_t, std::shared_ptr<FilterData>>& enabledFilters, OutputStyleTable& styles){
+        std::string combinedRegex;
+        for(const auto& [row, filter] : enabledFilters){
+            Entry entry;
+            entry.styleId = styles.addStyle(filter->getStyle());
+            entry.pattern = filter->getPattern();
+            entry.caseSensitive = filter->isCaseSensitive();
+            entry.wholeWord = filter->isWholeWord();
+            entry.regex = filter->isRegex();
+            int32_t entryIndex = static_cast<int32_t>(m_entries.size());
+            if(!entry.regex){
+                if(!entry.pattern.empty()){
+                    m_literals.addPattern(entry.pattern);
+                    m_literalEntries.push_back(entryIndex);
+                }
+            }else{
+                entry.matcher = filter->getMatcher();
+                // Word boundaries are left out, the prefilter only has to accept a superset of the matches
+                if(entry.matcher && AutomatonRegex::compile(entry.pattern, false)){
+                    entry.regexPrefiltered = true;
+                    combinedRegex += (combinedRegex.empty() ? "(?:" : "|(?:") + entry.pattern + ")";
+                }else if(entry.matcher){
+                    m_bHasUnprefilteredRegex = true;
+                }
+            }
+            m_entries.push_back(std::move(entry));
+        }
+        m_literals.build();
+        if(!combinedRegex.empty()){
+            m_regexPrefilter = AutomatonRegex::compile(combinedRegex, false);
+            if(!m_regexPrefilter){
+                m_bHasUnprefilteredRegex = true;
+                for(auto& entry : m_entries){
+                    entry.regexPrefiltered = false;
+                }
+            }
+        }
+    }
+
+    void FilterSetMatcher::apply(std::string_view lineContent, std::vector<OutputSpan>& spans) const{
+        static thread_local FilterSetScratch scratch;
+        const size_t entryCount = m_entries.size();
+
+        // One scan for all literal filters
+        scratch.occurrences.clear();
+        m_literals.findAll(lineContent, scratch.occurrences);
+        if(scratch.literalStarts.size() < entryCount){
+            scratch.literalStarts.resize(entryCount);
+        }
+        for(size_t i = 0; i < entryCount; i++){
+            scratch.literalStarts[i].clear();
+        }
+        bool anyLiteral = false;
+        for(const auto& occurrence : scratch.occurrences){
+            int32_t entryIndex = m_literalEntries[occurrence.patternIndex];
+            const Entry& entry = m_entries[entryIndex];
+            if(entry.caseSensitive
+               && std::memcmp(lineContent.data() + occurrence.position, entry.pattern.data(), entry.pattern.size()) != 0){
+                continue;
+            }
+            scratch.literalStarts[entryIndex].push_back(occurrence.position);
+            anyLiteral = true;
+        }
+        // Occurrences come ordered by end position, which is start order for a single pattern
+        bool regexMayMatch = m_bHasUnprefilteredRegex || (m_regexPrefilter && m_regexPrefilter->mayMatch(lineContent));
+
+        if(!anyLiteral && !regexMayMatch && !lineContent.empty()){
+            // No filter matches, every filter would keep the line as one unmatched part
+            spans.push_back({0, static_cast<uint32_t>(lineContent.size()), OutputStyleTable::PLAIN_STYLE_ID});
+            return;
+        }
+
+        auto& pieces = scratch.pieces;
+        auto& nextPieces = scratch.nextPieces;
+        pieces.clear();
+        pieces.push_back({0, lineContent.size(), -1});
+        for(size_t entryIndex = 0; entryIndex < entryCount; entryIndex++){
+            const Entry& entry = m_entries[entryIndex];
+            const auto& starts = scratch.literalStarts[entryIndex];
+            bool skipRegex = entry.regex && (!entry.matcher || (entry.regexPrefiltered && !regexMayMatch));
+            nextPieces.clear();
+            for(const Piece& piece : pieces){
+                if(piece.entryIndex != -1){
+                    nextPieces.push_back(piece);
+                    continue;
+                }
+                size_t lastPos = piece.start;
+                auto addMatch = [&](size_t position, size_t length){
+                    if(position > lastPos){
+                        nextPieces.push_back({lastPos, position, -1});
+                    }
+                    nextPieces.push_back({position, position + length, static_cast<int32_t>(entryIndex)});
+                    lastPos = position + length;
+                };
+                if(!entry.regex){
+                    // Same walk as LiteralMatcher over the part: non-overlapping, word boundaries relative to the part
+                    const size_t length = entry.pattern.size();
+                    std::string_view part = lineContent.substr(piece.start, piece.end - piece.start);
+                    auto it = std::lower_bound(starts.begin(), starts.end(), piece.start);
+                    while(it != starts.end() && *it + length <= piece.end){
+                        size_t position = *it;
+                        if(!entry.wholeWord || SubstringSearcher::isWholeWordAt(part, position - piece.start, length)){
+                            addMatch(position, length);
+                        }
+                        it = std::lower_bound(it, starts.end(), position + length);
+                    }
+                }else if(!skipRegex){
+                    scratch.matches.clear();
+                    entry.matcher->findAll(lineContent.substr(piece.start, piece.end - piece.start), scratch.matches);
+                    for(const auto& match : scratch.matches){
+                        addMatch(piece.start + match.position, match.length);
+                    }
+                }
+                if(lastPos < piece.end){
+                    nextPieces.push_back({lastPos, piece.end, -1});
+                }
+            }
+            pieces.swap(nextPieces);
+        }
+
+        spans.reserve(spans.size() + pieces.size());
+        for(const Piece& piece : pieces){
+            int32_t styleId = piece.entryIndex != -1 ? m_entries[piece.entryIndex].styleId : OutputStyleTable::PLAIN_STYLE_ID;
+            spans.push_back({static_cast<uint32_t>(piece.start), static_cast<uint32_t>(piece.end - piece.start), styleId});
+        }
+    }
+
+} // namespace Core
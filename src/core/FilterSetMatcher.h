@@ -0,0 +1,63 @@
+#ifndef CORE_FILTERSETMATCHER_H
+#define CORE_FILTERSETMATCHER_H
+
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "AhoCorasick.h"
+#include "AutomatonRegex.h"
+#include "FilterData.h"
+#include "OutputLine.h"
+#include "PatternMatcher.h"
+
+namespace Core {
+
+/**
+ * @brief All enabled filters combined into one matcher
+ *
+ * Built from the enabled filters whenever that set changes. The literal filters share one
+ * Aho-Corasick automaton, so a single scan per line finds the hits of every literal filter.
+ * The regex filters share one DFA prefilter that skips lines none of them can match.
+ *
+ * apply() gives exactly the result of applying the filters one after another in row order,
+ * each to the parts of the line not matched by an earlier filter.
+ * A FilterSetMatcher is immutable once built, it only keeps copies of the filter settings and
+ * the ids of the filter styles it added to the style table.
+ */
+class FilterSetMatcher {
+public:
+    FilterSetMatcher() = default;
+    FilterSetMatcher(const std::map<int32_t/*filterRow*/, std::shared_ptr<FilterData>>& enabledFilters, OutputStyleTable& styles);
+
+    bool empty() const { return m_entries.empty(); }
+
+    // Split lineContent into matched and unmatched spans
+    void apply(std::string_view lineContent, std::vector<OutputSpan>& spans) const;
+
+private:
+    struct Entry {
+        int32_t styleId;
+        std::string pattern;
+        bool caseSensitive;
+        bool wholeWord;
+        bool regex;
+        PatternMatcherPtr matcher;          // regex filters only, null if the pattern is invalid
+        bool regexPrefiltered = false;      // covered by m_regexPrefilter
+    };
+
+    std::vector<Entry> m_entries;           // in row order
+    AhoCorasick m_literals;
+    std::vector<int32_t> m_literalEntries;  // Aho-Corasick pattern index -> entry index
+    bool m_bHasUnprefilteredRegex = false;
+    std::unique_ptr<AutomatonRegex> m_regexPrefilter;
+};
+
+using FilterSetMatcherPtr = std::shared_ptr<const FilterSetMatcher>;
+
+} // namespace Core
+
+#endif // CORE_FILTERSETMATCHER_H
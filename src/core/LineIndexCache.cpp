@@ -0,0 +1,205 @@
+#include "LineIndexCache.h"
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include "AppUtils.h"
+#include "Logger.h"
+
+namespace Core {
+
+    namespace {
+        // The cache is local to this machine, so the header is written in its byte order
+        const char CACHE_MAGIC[8] = {'T', 'L', 'P', 'L', 'I', 'D', 'X', '2'};
+
+        struct CacheHeader {
+            char magic[8];
+            uint64_t device;
+            uint64_t fileIndex;
+            uint64_t size;
+            int64_t modifiedTime;
+            uint64_t pathSize;
+            uint64_t offsetCount;
+            uint64_t offsetDataSize;
+            uint64_t bloomWordCount;
+        };
+
+        // FNV-1a, stable between builds unlike std::hash
+        uint64_t hashPath(const std::string& path){
+            uint64_t hash = 14695981039346656037ull;
+            for(unsigned char c : path){
+                hash = (hash ^ c) * 1099511628211ull;
+            }
+            return hash;
+        }
+    }
+
+    LineIndexCache& LineIndexCache::getInstance(){
+        static LineIndexCache instance(AppUtils::getLineIndexCacheDir());
+        return instance;
+    }
+
+    LineIndexCache::LineIndexCache(std::string directory)
+        : m_directory(std::move(directory))
+    {
+    }
+
+    std::string LineIndexCache::getCacheFilePath(const std::string& path) const{
+        char name[32];
+        std::snprintf(name, sizeof(name), "%016llx.lidx", static_cast<unsigned long long>(hashPath(path)));
+        return m_directory + name;
+    }
+
+    bool LineIndexCache::read(const std::string& path, const FileStatus& status, std::vector<uint64_t>& lineOffsets,
+                              std::vector<uint64_t>& bloomWords) const{
+        if(!m_bEnabled){
+            return false;
+        }
+        const std::string cacheFilePath = getCacheFilePath(path);
+        std::ifstream input(cacheFilePath, std::ios::binary);
+        CacheHeader header;
+        if(!input.read(reinterpret_cast<char*>(&header), sizeof(header)) || std::memcmp(header.magic, CACHE_MAGIC, sizeof(CACHE_MAGIC)) != 0
+           || header.device != status.device || header.fileIndex != status.fileIndex || header.size != status.size
+           || header.modifiedTime != status.modifiedTime || header.pathSize != path.size()){
+            return false;
+        }
+        std::string storedPath(path.size(), '\0');
+        if(!input.read(&storedPath[0], static_cast<std::streamsize>(storedPath.size())) || storedPath != path){
+            return false;
+        }
+        const std::streamoff dataBegin = input.tellg();
+        input.seekg(0, std::ios::end);
+        const std::streamoff dataEnd = input.tellg();
+        input.seekg(dataBegin);
+        if(static_cast<uint64_t>(dataEnd - dataBegin) != header.offsetDataSize + header.bloomWordCount * sizeof(uint64_t)){
+            return false;
+        }
+        std::string data(static_cast<size_t>(header.offsetDataSize), '\0');
+        bloomWords.resize(static_cast<size_t>(header.bloomWordCount));
+        if(!input.read(&data[0], static_cast<std::streamsize>(data.size()))
+           || !input.read(reinterpret_cast<char*>(bloomWords.data()), static_cast<std::streamsize>(bloomWords.size() * sizeof(uint64_t)))){
+            bloomWords.clear();
+            return false;
+        }
+
+        // Deltas of the offsets, 7 bits per byte with the high bit set on all but the last byte
+        lineOffsets.clear();
+        lineOffsets.reserve(static_cast<size_t>(header.offsetCount));
+        const unsigned char* pos = reinterpret_cast<const unsigned char*>(data.data());
+        const unsigned char* end = pos + data.size();
+        uint64_t offset = 0;
+        while(pos < end){
+            uint64_t delta = 0;
+            int shift = 0;
+            while(pos < end && (*pos & 0x80) && shift < 63){
+                delta |= static_cast<uint64_t>(*pos++ & 0x7f) << shift;
+                shift += 7;
+            }
+            if(pos == end){
+                break;
+            }
+            delta |= static_cast<uint64_t>(*pos++) << shift;
+            offset += delta;
+            lineOffsets.push_back(offset);
+        }
+        if(pos != end || lineOffsets.size() != header.offsetCount || (!lineOffsets.empty() && lineOffsets.back() != status.size)){
+            lineOffsets.clear();
+            bloomWords.clear();
+            return false;
+        }
+        // Cache files are removed least recently used first
+        std::error_code error;
+        std::filesystem::last_write_time(cacheFilePath, std::filesystem::file_time_type::clock::now(), error);
+        return true;
+    }
+
+    void LineIndexCache::write(const std::string& path, const FileStatus& status, const std::vector<uint64_t>& lineOffsets,
+                               const std::vector<uint64_t>& bloomWords){
+        if(!m_bEnabled){
+            return;
+        }
+        std::string data;
+        data.reserve(lineOffsets.size() * 2);
+        uint64_t previousOffset = 0;
+        for(uint64_t offset : lineOffsets){
+            uint64_t delta = offset - previousOffset;
+            previousOffset = offset;
+            while(delta >= 0x80){
+                data.push_back(static_cast<char>((delta & 0x7f) | 0x80));
+                delta >>= 7;
+            }
+            data.push_back(static_cast<char>(delta));
+        }
+        CacheHeader header;
+        std::memcpy(header.magic, CACHE_MAGIC, sizeof(CACHE_MAGIC));
+        header.device = status.device;
+        header.fileIndex = status.fileIndex;
+        header.size = status.size;
+        header.modifiedTime = status.modifiedTime;
+        header.pathSize = path.size();
+        header.offsetCount = lineOffsets.size();
+        header.offsetDataSize = data.size();
+        header.bloomWordCount = bloomWords.size();
+
+        std::lock_guard<std::mutex> lock(m_writeMutex);
+        const std::string cacheFilePath = getCacheFilePath(path);
+        const std::string temporaryPath = cacheFilePath + ".tmp";
+        {
+            std::ofstream output(temporaryPath, std::ios::binary | std::ios::trunc);
+            output.write(reinterpret_cast<const char*>(&header), sizeof(header));
+            output.write(path.data(), static_cast<std::streamsize>(path.size()));
+            output.write(data.data(), static_cast<std::streamsize>(data.size()));
+            output.write(reinterpret_cast<const char*>(bloomWords.data()), static_cast<std::streamsize>(bloomWords.size() * sizeof(uint64_t)));
+            if(!output){
+                output.close();
+                std::error_code error;
+                std::filesystem::remove(temporaryPath, error);
+                Logger::getInstance().info("LineIndexCache::write Failed to write " + temporaryPath);
+                return;
+            }
+        }
+        std::error_code error;
+        std::filesystem::rename(temporaryPath, cacheFilePath, error);
+        if(error){
+            std::filesystem::remove(temporaryPath, error);
+            return;
+        }
+        removeLeastRecentlyUsed();
+    }
+
+    void LineIndexCache::removeLeastRecentlyUsed(){
+        struct CacheFile {
+            std::filesystem::path path;
+            std::filesystem::file_time_type lastUsed;
+            uint64_t size;
+        };
+        std::vector<CacheFile> cacheFiles;
+        uint64_t totalSize = 0;
+        std::error_code error;
+        for(std::filesystem::directory_iterator it(m_directory, error), end; !error && it != end; it.increment(error)){
+            if(it->path().extension() != ".lidx"){
+                continue;
+            }
+            std::error_code entryError;
+            CacheFile cacheFile{it->path(), it->last_write_time(entryError), it->file_size(entryError)};
+            if(!entryError){
+                totalSize += cacheFile.size;
+                cacheFiles.push_back(std::move(cacheFile));
+            }
+        }
+        if(totalSize <= MAX_CACHE_SIZE){
+            return;
+        }
+        std::sort(cacheFiles.begin(), cacheFiles.end(), [](const CacheFile& a, const CacheFile& b){ return a.lastUsed < b.lastUsed; });
+        for(const CacheFile& cacheFile : cacheFiles){
+            if(totalSize <= MAX_CACHE_SIZE){
+                break;
+            }
+            if(std::filesystem::remove(cacheFile.path, error)){
+                totalSize -= cacheFile.size;
+            }
+        }
+    }
+
+} // namespace Core
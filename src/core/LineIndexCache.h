@@ -0,0 +1,57 @@
+#ifndef CORE_LINEINDEXCACHE_H
+#define CORE_LINEINDEXCACHE_H
+
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <vector>
+#include "MappedFile.h"
+
+namespace Core {
+
+/**
+ * @brief Line offset tables of large files kept on disk between sessions
+ *
+ * One cache file per log file, named by a hash of its path, holds the path, the FileStatus
+ * the offsets were built for, the offsets as variable length deltas and the words of the
+ * file's TrigramBloom. A table is only
+ * used while the file still has that exact status, so opening an unchanged file again
+ * skips scanning it. Files are written under a temporary name and renamed, and the least
+ * recently used ones are removed once the cache grows over MAX_CACHE_SIZE.
+ */
+class LineIndexCache {
+public:
+    static LineIndexCache& getInstance();
+
+    explicit LineIndexCache(std::string directory);
+
+    LineIndexCache(const LineIndexCache&) = delete;
+    LineIndexCache& operator=(const LineIndexCache&) = delete;
+
+    // Smaller files are scanned faster than their table is read
+    static constexpr uint64_t MIN_FILE_SIZE = 64 * 1024 * 1024;
+
+    void setEnabled(bool bEnabled) { m_bEnabled = bEnabled; }
+    bool isEnabled() const { return m_bEnabled; }
+
+    // Fills lineOffsets and bloomWords with the tables of path if they were stored for status, thread safe
+    bool read(const std::string& path, const FileStatus& status, std::vector<uint64_t>& lineOffsets,
+              std::vector<uint64_t>& bloomWords) const;
+    void write(const std::string& path, const FileStatus& status, const std::vector<uint64_t>& lineOffsets,
+               const std::vector<uint64_t>& bloomWords);
+
+private:
+    static constexpr uint64_t MAX_CACHE_SIZE = 2ull * 1024 * 1024 * 1024;
+
+    std::string getCacheFilePath(const std::string& path) const;
+    void removeLeastRecentlyUsed();
+
+    std::string m_directory;
+    std::atomic<bool> m_bEnabled{true};
+    std::mutex m_writeMutex;
+};
+
+} // namespace Core
+
+#endif // CORE_LINEINDEXCACHE_H
@@ -0,0 +1,41 @@
+#pragma once
+
+#include <algorithm>
+#include <cassert>
+#include <cstdint>
+#include <vector>
+
+namespace Core {
+
+    /**
+     * @brief Sorted set of output line indexes kept in one vector
+     *
+     * Lines are merged in output order, so indexes only ever get appended. Lookups are
+     * binary searches with the std::set names, at 4 bytes per line instead of a tree node.
+     */
+    class LineIndexSet {
+    public:
+        using const_iterator = std::vector<int32_t>::const_iterator;
+
+        // lineIndex has to be larger than all indexes in the set
+        void append(int32_t lineIndex){
+            assert(m_lineIndexes.empty() || m_lineIndexes.back() < lineIndex);
+            m_lineIndexes.push_back(lineIndex);
+        }
+
+        const_iterator begin() const { return m_lineIndexes.begin(); }
+        const_iterator end() const { return m_lineIndexes.end(); }
+        bool empty() const { return m_lineIndexes.empty(); }
+        size_t size() const { return m_lineIndexes.size(); }
+
+        const_iterator lower_bound(int32_t lineIndex) const { return std::lower_bound(begin(), end(), lineIndex); }
+        const_iterator upper_bound(int32_t lineIndex) const { return std::upper_bound(begin(), end(), lineIndex); }
+        const_iterator find(int32_t lineIndex) const{
+            const_iterator it = lower_bound(lineIndex);
+            return it != end() && *it == lineIndex ? it : end();
+        }
+
+    private:
+        std::vector<int32_t> m_lineIndexes;
+    };
+}
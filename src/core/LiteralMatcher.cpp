@@ -0,0 +1,23 @@
+#include "LiteralMatcher.h"
+
+namespace Core {
+
+    LiteralMatcher::LiteralMatcher(const std::string& pattern, bool caseSensitive, bool wholeWord)
+        : m_pattern(pattern), m_searcher(pattern, caseSensitive), m_wholeWord(wholeWord) {}
+
+    void LiteralMatcher::findAll(std::string_view content, std::vector<PatternMatch>& matches) const{
+        const size_t length = m_searcher.getLength();
+        size_t pos = 0;
+        while ((pos = m_searcher.find(content, pos)) != std::string_view::npos) {
+            if (!m_wholeWord || SubstringSearcher::isWholeWordAt(content, pos, length)) {
+                matches.emplace_back(pos, length);
+            }
+            pos += length;
+        }
+    }
+
+    bool LiteralMatcher::mayMatch(std::string_view content) const{
+        return m_searcher.getLength() > 0 && m_searcher.find(content, 0) != std::string_view::npos;
+    }
+
+} // namespace Core
@@ -0,0 +1,29 @@
+#ifndef CORE_LITERALMATCHER_H
+#define CORE_LITERALMATCHER_H
+
+#include "PatternMatcher.h"
+#include "SubstringSearcher.h"
+
+namespace Core {
+
+/**
+ * @brief Plain substring matcher for non-regex patterns
+ */
+class LiteralMatcher : public PatternMatcher {
+public:
+    LiteralMatcher(const std::string& pattern, bool caseSensitive, bool wholeWord);
+
+    void findAll(std::string_view content, std::vector<PatternMatch>& matches) const override;
+    bool mayMatch(std::string_view content) const override;
+    const std::string& getRequiredLiteral() const override { return m_pattern; }
+    const char* getEngineName() const override { return "literal"; }
+
+private:
+    std::string m_pattern;
+    SubstringSearcher m_searcher;
+    bool m_wholeWord = false;
+};
+
+} // namespace Core
+
+#endif // CORE_LITERALMATCHER_H
@@ -11,8 +11,7 @@ Logger& Logger::getInstance() {
     return instance;
 }
 
-Logger::Logger() {
-    // Constructor
+Logger::Logger() : consoleStream(&std::cout) {
 }
 
 Logger::~Logger() {
@@ -57,6 +56,11 @@ bool Logger::setLogFile(const std::string& filePath) {
     return true;
 }
 
+void Logger::setConsoleStream(std::ostream* stream) {
+    std::lock_guard<std::mutex> lock(logMutex);
+    consoleStream = stream;
+}
+
 void Logger::closeLogFile() {
     std::lock_guard<std::mutex> lock(logMutex);
     if (logFile.is_open()) {
@@ -78,7 +82,9 @@ void Logger::log(LogLevel level, const std::string& message) {
     }
     
     // Write to console
-    std::cout << formattedMessage << std::endl;
+    if (consoleStream) {
+        *consoleStream << formattedMessage << std::endl;
+    }
     
     // Call callback if set
     if (logCallback) {
@@ -63,6 +63,9 @@ public:
     // Log to file
     bool setLogFile(const std::string& filePath);
     void closeLogFile();
+
+    // Console the messages are echoed to, std::cout by default and none for nullptr
+    void setConsoleStream(std::ostream* stream);
     
     // Log callback for UI integration
     using LogCallback = std::function<void(LogLevel, const std::string&)>;
@@ -81,6 +84,7 @@ private:
     std::string getLevelString(LogLevel level);
     
     std::ofstream logFile;
+    std::ostream* consoleStream;
     std::mutex logMutex;
     LogCallback logCallback;
     std::ostringstream m_ostringstream;
@@ -0,0 +1,192 @@
+#include "MappedFile.h"
+#include <fstream>
+#include <sstream>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace Core {
+
+    MappedFile::~MappedFile(){
+        close();
+    }
+
+    bool MappedFile::open(const std::string& path, bool bAllowMapping){
+        close();
+        getStatus(path, m_status);
+        if(bAllowMapping && map(path)){
+            m_bOpen = true;
+            m_bMapped = true;
+            return true;
+        }
+        if(read(path, 0)){
+            m_bOpen = true;
+            return true;
+        }
+        return false;
+    }
+
+    bool MappedFile::openRange(const std::string& path, uint64_t offset){
+        close();
+        getStatus(path, m_status);
+        if(read(path, offset)){
+            m_bOpen = true;
+            return true;
+        }
+        return false;
+    }
+
+    void MappedFile::assign(std::string content, const FileStatus& status){
+        close();
+        m_status = status;
+        m_buffer = std::move(content);
+        m_data = m_buffer.data();
+        m_size = m_buffer.size();
+        m_bOpen = true;
+    }
+
+    void MappedFile::close(){
+        if(m_bMapped){
+#ifdef _WIN32
+            UnmapViewOfFile(m_data);
+            CloseHandle(static_cast<HANDLE>(m_mappingHandle));
+            CloseHandle(static_cast<HANDLE>(m_fileHandle));
+            m_mappingHandle = nullptr;
+            m_fileHandle = nullptr;
+#else
+            munmap(const_cast<char*>(m_data), static_cast<size_t>(m_size));
+#endif
+        }
+        m_buffer.clear();
+        m_buffer.shrink_to_fit();
+        m_data = nullptr;
+        m_size = 0;
+        m_status = FileStatus();
+        m_bOpen = false;
+        m_bMapped = false;
+    }
+
+#ifdef _WIN32
+    bool MappedFile::getStatus(const std::string& path, FileStatus& status){
+        HANDLE fileHandle = CreateFileA(path.c_str(), 0, FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE,
+                                        nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+        if(fileHandle == INVALID_HANDLE_VALUE){
+            return false;
+        }
+        BY_HANDLE_FILE_INFORMATION info;
+        bool bOk = GetFileInformationByHandle(fileHandle, &info) != 0;
+        CloseHandle(fileHandle);
+        if(!bOk){
+            return false;
+        }
+        status.device = info.dwVolumeSerialNumber;
+        status.fileIndex = (static_cast<uint64_t>(info.nFileIndexHigh) << 32) | info.nFileIndexLow;
+        status.size = (static_cast<uint64_t>(info.nFileSizeHigh) << 32) | info.nFileSizeLow;
+        status.modifiedTime = static_cast<int64_t>((static_cast<uint64_t>(info.ftLastWriteTime.dwHighDateTime) << 32)
+                                                   | info.ftLastWriteTime.dwLowDateTime);
+        return true;
+    }
+
+    bool MappedFile::map(const std::string& path){
+        //without FILE_SHARE_WRITE this fails while a writer has the file open and keeps writers out
+        //while it is mapped, a mapped file can not be truncated either
+        HANDLE fileHandle = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_DELETE,
+                                        nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+        if(fileHandle == INVALID_HANDLE_VALUE){
+            return false;
+        }
+        LARGE_INTEGER fileSize;
+        if(!GetFileSizeEx(fileHandle, &fileSize) || fileSize.QuadPart <= 0){
+            //an empty file can not be mapped, it is handled by read()
+            CloseHandle(fileHandle);
+            return false;
+        }
+        HANDLE mappingHandle = CreateFileMappingA(fileHandle, nullptr, PAGE_READONLY, 0, 0, nullptr);
+        if(mappingHandle == nullptr){
+            CloseHandle(fileHandle);
+            return false;
+        }
+        const void* data = MapViewOfFile(mappingHandle, FILE_MAP_READ, 0, 0, 0);
+        if(data == nullptr){
+            CloseHandle(mappingHandle);
+            CloseHandle(fileHandle);
+            return false;
+        }
+        m_fileHandle = fileHandle;
+        m_mappingHandle = mappingHandle;
+        m_data = static_cast<const char*>(data);
+        m_size = static_cast<uint64_t>(fileSize.QuadPart);
+        return true;
+    }
+#else
+    bool MappedFile::getStatus(const std::string& path, FileStatus& status){
+        struct stat st;
+        if(::stat(path.c_str(), &st) != 0){
+            return false;
+        }
+        status.device = static_cast<uint64_t>(st.st_dev);
+        status.fileIndex = static_cast<uint64_t>(st.st_ino);
+        status.size = static_cast<uint64_t>(st.st_size);
+#ifdef __APPLE__
+        status.modifiedTime = static_cast<int64_t>(st.st_mtimespec.tv_sec) * 1000000000 + st.st_mtimespec.tv_nsec;
+#else
+        status.modifiedTime = static_cast<int64_t>(st.st_mtim.tv_sec) * 1000000000 + st.st_mtim.tv_nsec;
+#endif
+        return true;
+    }
+
+    bool MappedFile::map(const std::string& path){
+        int fd = ::open(path.c_str(), O_RDONLY);
+        if(fd < 0){
+            return false;
+        }
+        struct stat st;
+        if(fstat(fd, &st) != 0 || !S_ISREG(st.st_mode) || st.st_size <= 0){
+            //an empty file can not be mapped, it is handled by read()
+            ::close(fd);
+            return false;
+        }
+        if((st.st_mode & (S_IWUSR | S_IWGRP | S_IWOTH)) != 0){
+            //nothing stops a writer from truncating the file, e.g. logrotate's copytruncate, and
+            //touching the lost pages would raise SIGBUS, so only read-only files are mapped
+            ::close(fd);
+            return false;
+        }
+        void* data = mmap(nullptr, static_cast<size_t>(st.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+        //the mapping keeps its own reference to the file
+        ::close(fd);
+        if(data == MAP_FAILED){
+            return false;
+        }
+#ifdef MADV_SEQUENTIAL
+        madvise(data, static_cast<size_t>(st.st_size), MADV_SEQUENTIAL);
+#endif
+        m_data = static_cast<const char*>(data);
+        m_size = static_cast<uint64_t>(st.st_size);
+        return true;
+    }
+#endif
+
+    bool MappedFile::read(const std::string& path, uint64_t offset){
+        std::ifstream fileStream(path, std::ios::binary);
+        if(!fileStream.is_open()){
+            return false;
+        }
+        if(offset > 0 && !fileStream.seekg(static_cast<std::streamoff>(offset))){
+            return false;
+        }
+        std::ostringstream content;
+        content << fileStream.rdbuf();
+        m_buffer = content.str();
+        m_data = m_buffer.data();
+        m_size = m_buffer.size();
+        return true;
+    }
+
+} // namespace Core
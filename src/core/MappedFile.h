@@ -0,0 +1,83 @@
+#ifndef CORE_MAPPEDFILE_H
+#define CORE_MAPPEDFILE_H
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+namespace Core {
+
+/**
+ * @brief Identity, size and modification time of a file on disk
+ *
+ * device and fileIndex tell whether a path still names the same file, e.g. after a log rotation
+ * moved it away and created a new one in its place.
+ */
+struct FileStatus {
+    uint64_t device = 0;
+    uint64_t fileIndex = 0;
+    uint64_t size = 0;
+    int64_t modifiedTime = 0;   // nanoseconds on POSIX, 100 ns intervals on Windows
+
+    bool isSameFile(const FileStatus& other) const { return device == other.device && fileIndex == other.fileIndex; }
+    bool operator==(const FileStatus& other) const {
+        return isSameFile(other) && size == other.size && modifiedTime == other.modifiedTime;
+    }
+    bool operator!=(const FileStatus& other) const { return !(*this == other); }
+};
+
+/**
+ * @brief Read-only view of a whole file's bytes
+ * 
+ * The file is memory-mapped when nothing can shrink it while it is mapped, so the content is
+ * paged in on demand and never copied. Touching a mapping past the end of a file that was
+ * truncated meanwhile faults (SIGBUS on POSIX), so every other file, and every file that
+ * fails to map, is read into a heap buffer instead, which keeps the same interface for callers.
+ */
+class MappedFile {
+public:
+    MappedFile() = default;
+    ~MappedFile();
+
+    // Prevent copying, the mapping is owned by exactly one object
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    // Without bAllowMapping the file is always read into the heap buffer, which keeps working
+    // when the file is truncated later, where touching a mapping past the new end faults
+    bool open(const std::string& path, bool bAllowMapping = true);
+    // Reads the bytes from offset to the end of the file into the heap buffer
+    bool openRange(const std::string& path, uint64_t offset);
+    // Holds content derived from the file with the given status, e.g. its decompressed bytes
+    void assign(std::string content, const FileStatus& status);
+    void close();
+
+    static bool getStatus(const std::string& path, FileStatus& status);
+
+    bool isOpen() const { return m_bOpen; }
+    bool isMapped() const { return m_bMapped; }
+    const char* data() const { return m_data; }
+    uint64_t size() const { return m_size; }
+    std::string_view view() const { return std::string_view(m_data, static_cast<size_t>(m_size)); }
+    // Status of the file when it was opened, its size may be larger than size() if it grew meanwhile
+    const FileStatus& getStatus() const { return m_status; }
+
+private:
+    bool map(const std::string& path);
+    bool read(const std::string& path, uint64_t offset);
+
+    const char* m_data = nullptr;
+    uint64_t m_size = 0;
+    FileStatus m_status;
+    bool m_bOpen = false;
+    bool m_bMapped = false;
+    std::string m_buffer;   // only used when the file is not mapped
+#ifdef _WIN32
+    void* m_fileHandle = nullptr;
+    void* m_mappingHandle = nullptr;
+#endif
+};
+
+} // namespace Core
+
+#endif // CORE_MAPPEDFILE_H
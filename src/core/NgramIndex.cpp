@@ -0,0 +1,210 @@
+#include "NgramIndex.h"
+#include <algorithm>
+#include <cstdint>
+#include "Logger.h"
+#include "ThreadPool.h"
+#include "TrigramBloom.h"
+
+namespace Core {
+
+    namespace {
+        // Distinct trigrams of the lines [beginLine, endLine), in no particular order
+        void collectTrigrams(const FileLineIndex& fileLineIndex, int32_t beginLine, int32_t endLine, std::vector<uint32_t>& trigrams){
+            // One bit per possible trigram, only the bits set for this block are cleared again
+            static thread_local std::vector<uint64_t> seen((TRIGRAM_MASK + 1) / 64);
+            trigrams.clear();
+            for(int32_t lineIndex = beginLine; lineIndex < endLine; lineIndex++){
+                forEachTrigram(fileLineIndex.getLine(lineIndex), [&](uint32_t trigram){
+                    uint64_t bit = uint64_t(1) << (trigram & 63);
+                    if(!(seen[trigram >> 6] & bit)){
+                        seen[trigram >> 6] |= bit;
+                        trigrams.push_back(trigram);
+                    }
+                });
+            }
+            for(uint32_t trigram : trigrams){
+                seen[trigram >> 6] = 0;
+            }
+        }
+    }
+
+    NgramMemoryBudget& NgramMemoryBudget::getInstance(){
+        static NgramMemoryBudget instance(DEFAULT_LIMIT);
+        return instance;
+    }
+
+    bool NgramMemoryBudget::tryReserve(size_t bytes){
+        size_t usage = m_usage.load(std::memory_order_relaxed);
+        do{
+            if(bytes > m_limit - usage){
+                return false;
+            }
+        }while(!m_usage.compare_exchange_weak(usage, usage + bytes, std::memory_order_relaxed));
+        return true;
+    }
+
+    void NgramMemoryBudget::release(size_t bytes){
+        m_usage.fetch_sub(bytes, std::memory_order_relaxed);
+    }
+
+    NgramIndex::~NgramIndex(){
+        if(m_memoryBudget){
+            m_memoryBudget->release(m_reservedMemory);
+        }
+    }
+
+    NgramIndexPtr NgramIndex::build(const FileLineIndex& fileLineIndex, NgramMemoryBudget& memoryBudget, const std::function<bool()>& isCancelled){
+        std::shared_ptr<NgramIndex> index(new NgramIndex());
+        index->m_memoryBudget = &memoryBudget;
+        index->m_lineageId = fileLineIndex.getLineageId();
+        index->m_lineCount = fileLineIndex.getCompleteLineCount();
+        // Lines are always scanned in blocks of the initial size, the blocks merged so far decide where they go
+        const int32_t scanBlockCount = (index->m_lineCount + INITIAL_BLOCK_LINE_COUNT - 1) / INITIAL_BLOCK_LINE_COUNT;
+        ThreadPool& pool = ThreadPool::getInstance();
+        // Small batches keep the pool free for the output passes running meanwhile
+        const int32_t batchSize = static_cast<int32_t>(pool.getConcurrency()) * 4;
+        std::vector<std::vector<uint32_t>> trigrams(batchSize);
+        for(int32_t batchBegin = 0; batchBegin < scanBlockCount; batchBegin += batchSize){
+            if(isCancelled()){
+                return nullptr;
+            }
+            const int32_t batchEnd = std::min(scanBlockCount, batchBegin + batchSize);
+            pool.parallelFor(batchEnd - batchBegin, [&](size_t i){
+                int32_t beginLine = (batchBegin + static_cast<int32_t>(i)) * INITIAL_BLOCK_LINE_COUNT;
+                collectTrigrams(fileLineIndex, beginLine, std::min(index->m_lineCount, beginLine + INITIAL_BLOCK_LINE_COUNT), trigrams[i]);
+            });
+            for(int32_t scanBlock = batchBegin; scanBlock < batchEnd; scanBlock++){
+                const uint32_t block = static_cast<uint32_t>(scanBlock / (index->m_blockLineCount / INITIAL_BLOCK_LINE_COUNT));
+                index->addBlock(block, trigrams[scanBlock - batchBegin]);
+                while(!index->updateReservation()){
+                    if(index->m_blockLineCount >= MAX_BLOCK_LINE_COUNT){
+                        Logger::getInstance().warning("NgramIndex::build Index does not fit in the " + std::to_string(memoryBudget.getLimit())
+                            + " bytes shared by all indexes, " + std::to_string(memoryBudget.getUsage()) + " are in use");
+                        return nullptr;
+                    }
+                    index->mergeBlockPairs();
+                }
+            }
+        }
+        return index;
+    }
+
+    bool NgramIndex::updateReservation(){
+        if(m_memoryUsage > m_reservedMemory){
+            if(!m_memoryBudget->tryReserve(m_memoryUsage - m_reservedMemory)){
+                return false;
+            }
+        }else{
+            m_memoryBudget->release(m_reservedMemory - m_memoryUsage);
+        }
+        m_reservedMemory = m_memoryUsage;
+        return true;
+    }
+
+    void NgramIndex::addBlock(uint32_t block, const std::vector<uint32_t>& trigrams){
+        for(uint32_t trigram : trigrams){
+            auto result = m_blocks.try_emplace(trigram);
+            std::vector<uint32_t>& blocks = result.first->second;
+            if(result.second){
+                m_memoryUsage += ENTRY_OVERHEAD;
+            }
+            // Scan blocks merged into one block add it only once
+            if(blocks.empty() || blocks.back() != block){
+                size_t capacity = blocks.capacity();
+                blocks.push_back(block);
+                m_memoryUsage += (blocks.capacity() - capacity) * sizeof(uint32_t);
+            }
+        }
+    }
+
+    void NgramIndex::mergeBlockPairs(){
+        m_blockLineCount *= 2;
+        m_memoryUsage = m_blocks.size() * ENTRY_OVERHEAD;
+        for(auto& it : m_blocks){
+            std::vector<uint32_t>& blocks = it.second;
+            for(uint32_t& block : blocks){
+                block >>= 1;
+            }
+            blocks.erase(std::unique(blocks.begin(), blocks.end()), blocks.end());
+            blocks.shrink_to_fit();
+            m_memoryUsage += blocks.capacity() * sizeof(uint32_t);
+        }
+    }
+
+    void NgramIndex::excludeBlocks(std::string_view literal, int32_t beginBlock, std::vector<uint8_t>& blocks) const{
+        std::vector<uint32_t> trigrams;
+        forEachTrigram(literal, [&](uint32_t trigram){ trigrams.push_back(trigram); });
+        const uint32_t endBlock = static_cast<uint32_t>(beginBlock) + static_cast<uint32_t>(blocks.size());
+        std::vector<uint8_t> hits(blocks.size());
+        for(uint32_t trigram : trigrams){
+            auto it = m_blocks.find(trigram);
+            if(it == m_blocks.end()){
+                std::fill(blocks.begin(), blocks.end(), 0);
+                return;
+            }
+            std::fill(hits.begin(), hits.end(), 0);
+            auto blockIt = std::lower_bound(it->second.begin(), it->second.end(), static_cast<uint32_t>(beginBlock));
+            for(; blockIt != it->second.end() && *blockIt < endBlock; ++blockIt){
+                hits[*blockIt - beginBlock] = 1;
+            }
+            for(size_t block = 0; block < blocks.size(); block++){
+                blocks[block] &= hits[block];
+            }
+        }
+    }
+
+    void NgramCandidateLines::restrict(const NgramIndex& index, const std::vector<std::string_view>& literals, int32_t beginLine, int32_t endLine){
+        for(std::string_view literal : literals){
+            if(literal.size() < 3){
+                return;
+            }
+        }
+        m_coveredLineCount = index.getLineCount();
+        m_blockLineCount = index.getBlockLineCount();
+        endLine = std::min(endLine, m_coveredLineCount);
+        if(beginLine >= endLine){
+            return;
+        }
+        m_bRestricted = true;
+        m_beginBlock = beginLine / m_blockLineCount;
+        const size_t blockCount = static_cast<size_t>((endLine - 1) / m_blockLineCount - m_beginBlock + 1);
+        m_blocks.assign(blockCount, 0);
+        std::vector<uint8_t> literalBlocks;
+        for(std::string_view literal : literals){
+            literalBlocks.assign(blockCount, 1);
+            index.excludeBlocks(literal, m_beginBlock, literalBlocks);
+            for(size_t block = 0; block < blockCount; block++){
+                m_blocks[block] |= literalBlocks[block];
+            }
+        }
+    }
+
+    void NgramCandidateLines::restrict(const FileLineIndex& fileLineIndex, const std::vector<std::string_view>& literals, int32_t beginLine, int32_t endLine){
+        std::vector<std::vector<uint32_t>> literalTrigrams;
+        for(std::string_view literal : literals){
+            if(literal.size() < 3){
+                return;
+            }
+            literalTrigrams.emplace_back();
+            forEachTrigram(literal, [&](uint32_t trigram){ literalTrigrams.back().push_back(trigram); });
+        }
+        const TrigramBloom& bloom = fileLineIndex.getTrigramBloom();
+        m_beginLine = beginLine;
+        m_lineFlags.assign(static_cast<size_t>(endLine - beginLine), 0);
+        // Lines of one block come one after another, the block is only looked up once
+        size_t lastBlock = SIZE_MAX;
+        bool bMayContain = true;
+        for(int32_t lineIndex = beginLine; lineIndex < endLine; lineIndex++){
+            size_t block = fileLineIndex.getTrigramBloomBlock(lineIndex);
+            if(block != lastBlock){
+                lastBlock = block;
+                bMayContain = block >= bloom.getBlockCount();
+                for(size_t i = 0; i < literalTrigrams.size() && !bMayContain; i++){
+                    bMayContain = bloom.mayContainAll(block, literalTrigrams[i]);
+                }
+            }
+            m_lineFlags[lineIndex - beginLine] = bMayContain ? 1 : 0;
+        }
+    }
+
+} // namespace Core
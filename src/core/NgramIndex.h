@@ -0,0 +1,134 @@
+#ifndef CORE_NGRAMINDEX_H
+#define CORE_NGRAMINDEX_H
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+#include "FileLineIndex.h"
+
+namespace Core {
+
+class NgramIndex;
+using NgramIndexPtr = std::shared_ptr<const NgramIndex>;
+
+/**
+ * @brief Memory the n-gram indexes of several files share
+ *
+ * Every NgramIndex reserves the memory of its lists while it is built and releases it when it is
+ * destroyed, so all indexes built against the shared instance stay within its limit together, no
+ * matter how many files or workspaces are loaded. Thread safe.
+ */
+class NgramMemoryBudget {
+public:
+    static constexpr size_t DEFAULT_LIMIT = 256 * 1024 * 1024;
+
+    // Shared by the indexes of all workspaces, limited to DEFAULT_LIMIT
+    static NgramMemoryBudget& getInstance();
+
+    explicit NgramMemoryBudget(size_t limit) : m_limit(limit) {}
+
+    NgramMemoryBudget(const NgramMemoryBudget&) = delete;
+    NgramMemoryBudget& operator=(const NgramMemoryBudget&) = delete;
+
+    // False, and nothing reserved, when bytes more would exceed the limit
+    bool tryReserve(size_t bytes);
+    void release(size_t bytes);
+    size_t getLimit() const { return m_limit; }
+    size_t getUsage() const { return m_usage.load(std::memory_order_relaxed); }
+
+private:
+    const size_t m_limit;
+    std::atomic<size_t> m_usage{0};
+};
+
+/**
+ * @brief Inverted index from the trigrams of a file to the blocks of lines containing them
+ *
+ * Lines are grouped in blocks of getBlockLineCount() lines, and every trigram of ASCII case-folded
+ * bytes within a line maps to the sorted list of blocks it occurs in. A line containing a literal
+ * contains all its trigrams, so only the blocks in the intersection of their lists can hold one.
+ *
+ * build() scans the lines on ThreadPool and reserves the memory of the lists from a NgramMemoryBudget:
+ * when it has no more to give, neighbouring blocks are merged and the block size doubles. The index covers the complete
+ * lines of the file when it was built. Later indexes of the same lineage keep those lines, so it
+ * stays valid for them and only the lines appended since are not covered.
+ */
+class NgramIndex {
+public:
+    static constexpr int32_t INITIAL_BLOCK_LINE_COUNT = 1024;
+
+    // Returns nullptr when cancelled or when even the largest blocks do not fit in what is left of memoryBudget
+    static NgramIndexPtr build(const FileLineIndex& fileLineIndex, NgramMemoryBudget& memoryBudget, const std::function<bool()>& isCancelled);
+
+    ~NgramIndex();
+
+    uint64_t getLineageId() const { return m_lineageId; }
+    int32_t getLineCount() const { return m_lineCount; }
+    int32_t getBlockLineCount() const { return m_blockLineCount; }
+    size_t getMemoryUsage() const { return m_memoryUsage; }
+
+    // Sets blocks[i] to 0 for every block beginBlock + i that can not hold a line containing literal,
+    // leaves the other flags as they are. Literals shorter than a trigram rule nothing out.
+    void excludeBlocks(std::string_view literal, int32_t beginBlock, std::vector<uint8_t>& blocks) const;
+
+private:
+    static constexpr int32_t MAX_BLOCK_LINE_COUNT = 1 << 20;
+    // Bucket, key and list header of one map entry, roughly
+    static constexpr size_t ENTRY_OVERHEAD = 64;
+
+    NgramIndex() = default;
+
+    void addBlock(uint32_t block, const std::vector<uint32_t>& trigrams);
+    void mergeBlockPairs();
+    // Brings the reservation to m_memoryUsage, false if the budget can not cover it
+    bool updateReservation();
+
+    uint64_t m_lineageId = 0;
+    int32_t m_lineCount = 0;
+    int32_t m_blockLineCount = INITIAL_BLOCK_LINE_COUNT;
+    size_t m_memoryUsage = 0;
+    NgramMemoryBudget* m_memoryBudget = nullptr;
+    size_t m_reservedMemory = 0;
+    std::unordered_map<uint32_t/*trigram*/, std::vector<uint32_t/*block*/>> m_blocks;
+};
+
+/**
+ * @brief Lines of one range of a file that may contain any of a set of literals
+ *
+ * Holds one flag per index block of the range, and one per line as far as the trigram Bloom
+ * filters of the file rule lines out. Every line is a candidate until it is restricted, and so
+ * are the lines the index does not cover.
+ */
+class NgramCandidateLines {
+public:
+    // A literal shorter than a trigram keeps every line a candidate, no literals leave none
+    void restrict(const NgramIndex& index, const std::vector<std::string_view>& literals, int32_t beginLine, int32_t endLine);
+    void restrict(const FileLineIndex& fileLineIndex, const std::vector<std::string_view>& literals, int32_t beginLine, int32_t endLine);
+
+    bool contains(int32_t lineIndex) const {
+        if(!m_lineFlags.empty() && !m_lineFlags[lineIndex - m_beginLine]){
+            return false;
+        }
+        if(!m_bRestricted || lineIndex >= m_coveredLineCount){
+            return true;
+        }
+        return m_blocks[lineIndex / m_blockLineCount - m_beginBlock] != 0;
+    }
+
+private:
+    int32_t m_beginLine = 0;
+    std::vector<uint8_t> m_lineFlags;       // by the Bloom filters, empty if they were not asked
+    bool m_bRestricted = false;
+    int32_t m_coveredLineCount = 0;
+    int32_t m_blockLineCount = 1;
+    int32_t m_beginBlock = 0;
+    std::vector<uint8_t> m_blocks;
+};
+
+} // namespace Core
+
+#endif // CORE_NGRAMINDEX_H
@@ -0,0 +1,110 @@
+#include "NgramIndexBuilder.h"
+#include <chrono>
+#include "Logger.h"
+
+namespace Core {
+
+    NgramIndexBuilder::NgramIndexBuilder(NgramMemoryBudget& memoryBudget)
+        : m_memoryBudget(memoryBudget)
+    {
+        m_workerThread = std::thread(&NgramIndexBuilder::workerLoop, this);
+    }
+
+    NgramIndexBuilder::~NgramIndexBuilder(){
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_bStopping = true;
+            m_bCancelBuild = true;
+        }
+        m_condition.notify_all();
+        m_workerThread.join();
+    }
+
+    bool NgramIndexBuilder::needsIndex(const FileLineIndex& fileLineIndex, const NgramIndexPtr& index){
+        if(fileLineIndex.getCompleteLineCount() < MIN_LINE_COUNT){
+            return false;
+        }
+        return !index || index->getLineageId() != fileLineIndex.getLineageId()
+            || index->getLineCount() < fileLineIndex.getCompleteLineCount() / 2;
+    }
+
+    void NgramIndexBuilder::setFiles(const std::map<int32_t, FileLineIndexPtr>& files){
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_pendingFiles.clear();
+            for(auto it = m_indexes.begin(); it != m_indexes.end();){
+                auto fileIt = files.find(it->first);
+                if(fileIt == files.end() || fileIt->second->getLineageId() != it->second->getLineageId()){
+                    it = m_indexes.erase(it);
+                }else{
+                    ++it;
+                }
+            }
+            for(auto& it : files){
+                auto indexIt = m_indexes.find(it.first);
+                if(needsIndex(*it.second, indexIt == m_indexes.end() ? nullptr : indexIt->second)
+                   && m_oversizedLineageIds.count(it.second->getLineageId()) == 0){
+                    m_pendingFiles[it.first] = it.second;
+                }
+            }
+            // The build in flight goes on while the file keeps its lineage, and is not queued twice
+            if(m_buildingFileId != -1){
+                auto pendingIt = m_pendingFiles.find(m_buildingFileId);
+                if(pendingIt != m_pendingFiles.end() && pendingIt->second->getLineageId() == m_buildingLineageId){
+                    m_pendingFiles.erase(pendingIt);
+                }else{
+                    m_bCancelBuild = true;
+                }
+            }
+        }
+        m_condition.notify_all();
+    }
+
+    NgramIndexPtr NgramIndexBuilder::getIndex(int32_t fileId, const FileLineIndex& fileLineIndex) const{
+        std::lock_guard<std::mutex> lock(m_mutex);
+        auto it = m_indexes.find(fileId);
+        if(it == m_indexes.end() || it->second->getLineageId() != fileLineIndex.getLineageId()){
+            return nullptr;
+        }
+        return it->second;
+    }
+
+    void NgramIndexBuilder::workerLoop(){
+        while(true){
+            int32_t fileId = -1;
+            FileLineIndexPtr fileLineIndex;
+            {
+                std::unique_lock<std::mutex> lock(m_mutex);
+                m_buildingFileId = -1;
+                m_condition.wait(lock, [this]{ return !m_pendingFiles.empty() || m_bStopping; });
+                if(m_bStopping){
+                    return;
+                }
+                fileId = m_pendingFiles.begin()->first;
+                fileLineIndex = std::move(m_pendingFiles.begin()->second);
+                m_pendingFiles.erase(m_pendingFiles.begin());
+                m_buildingFileId = fileId;
+                m_buildingLineageId = fileLineIndex->getLineageId();
+                m_bCancelBuild = false;
+            }
+            auto startTime = std::chrono::steady_clock::now();
+            NgramIndexPtr index = NgramIndex::build(*fileLineIndex, m_memoryBudget, [this]{ return m_bCancelBuild.load(std::memory_order_relaxed); });
+            if(!index){
+                std::lock_guard<std::mutex> lock(m_mutex);
+                if(!m_bCancelBuild){
+                    m_oversizedLineageIds.insert(fileLineIndex->getLineageId());
+                }
+                continue;
+            }
+            auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - startTime);
+            Logger::getInstance().info("NgramIndexBuilder Indexed " + std::to_string(index->getLineCount()) + " lines of file "
+                + std::to_string(fileId) + " in blocks of " + std::to_string(index->getBlockLineCount()) + " lines, "
+                + std::to_string(index->getMemoryUsage() / 1024) + " KB, " + std::to_string(elapsed.count()) + " ms");
+            std::lock_guard<std::mutex> lock(m_mutex);
+            if(!m_bCancelBuild){
+                m_indexes[fileId] = std::move(index);
+            }
+        }
+    }
+
+} // namespace Core
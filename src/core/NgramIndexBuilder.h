@@ -0,0 +1,62 @@
+#ifndef CORE_NGRAMINDEXBUILDER_H
+#define CORE_NGRAMINDEXBUILDER_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <set>
+#include <thread>
+#include "FileLineIndex.h"
+#include "NgramIndex.h"
+
+namespace Core {
+
+/**
+ * @brief Builds the NgramIndex of the loaded files on a background thread
+ *
+ * setFiles() hands over the current index of every loaded file. Files without a valid n-gram index,
+ * or that more than doubled since theirs was built, are indexed one after another. A file that is
+ * removed or replaced meanwhile cancels its build, and indexes of files no longer loaded are dropped.
+ *
+ * All builders share one NgramMemoryBudget, by default the process-wide one, so the indexes of every
+ * file of every workspace together stay within its limit. Once it is used up, later indexes get
+ * coarser blocks, and files whose index does not fit even with the largest blocks are not indexed.
+ */
+class NgramIndexBuilder {
+public:
+    // Smaller files are scanned faster than the index is looked up and built
+    static constexpr int32_t MIN_LINE_COUNT = 65536;
+
+    explicit NgramIndexBuilder(NgramMemoryBudget& memoryBudget = NgramMemoryBudget::getInstance());
+    ~NgramIndexBuilder();
+
+    NgramIndexBuilder(const NgramIndexBuilder&) = delete;
+    NgramIndexBuilder& operator=(const NgramIndexBuilder&) = delete;
+
+    void setFiles(const std::map<int32_t/*fileId*/, FileLineIndexPtr>& files);
+
+    // Index of the file if one was built for the lineage of fileLineIndex, thread safe
+    NgramIndexPtr getIndex(int32_t fileId, const FileLineIndex& fileLineIndex) const;
+
+private:
+    static bool needsIndex(const FileLineIndex& fileLineIndex, const NgramIndexPtr& index);
+    void workerLoop();
+
+    NgramMemoryBudget& m_memoryBudget;     // shared with the other builders
+    mutable std::mutex m_mutex;
+    std::condition_variable m_condition;
+    std::map<int32_t/*fileId*/, FileLineIndexPtr> m_pendingFiles;
+    std::map<int32_t/*fileId*/, NgramIndexPtr> m_indexes;
+    std::set<uint64_t/*lineageId*/> m_oversizedLineageIds;   // did not fit in what was left of the budget, not tried again
+    int32_t m_buildingFileId = -1;
+    uint64_t m_buildingLineageId = 0;
+    std::atomic<bool> m_bCancelBuild{false};
+    bool m_bStopping = false;
+    std::thread m_workerThread;
+};
+
+} // namespace Core
+
+#endif // CORE_NGRAMINDEXBUILDER_H
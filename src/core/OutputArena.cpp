@@ -0,0 +1,28 @@
+#include "OutputArena.h"
+
+#include <algorithm>
+#include <cstdint>
+
+namespace Core {
+    OutputArena::OutputArena(size_t firstBlockSize)
+        : m_nextBlockSize(std::max<size_t>(firstBlockSize, 1)){
+    }
+
+    void* OutputArena::allocate(size_t size, size_t alignment){
+        size_t padding = (alignment - reinterpret_cast<uintptr_t>(m_current) % alignment) % alignment;
+        if(!m_current || m_remaining < padding + size){
+            // Blocks come from new char[], which is aligned for any fundamental type
+            size_t blockSize = std::max(m_nextBlockSize, size + alignment);
+            m_blocks.emplace_back(new char[blockSize]);
+            m_current = m_blocks.back().get();
+            m_remaining = blockSize;
+            m_reservedBytes += blockSize;
+            m_nextBlockSize = std::min(m_nextBlockSize * 2, MAX_BLOCK_SIZE);
+            padding = (alignment - reinterpret_cast<uintptr_t>(m_current) % alignment) % alignment;
+        }
+        char* pointer = m_current + padding;
+        m_current = pointer + size;
+        m_remaining -= padding + size;
+        return pointer;
+    }
+}
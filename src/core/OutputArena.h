@@ -0,0 +1,65 @@
+#pragma once
+
+#include <cstddef>
+#include <cstring>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace Core {
+
+    /**
+     * @brief Monotonic buffer for the output lines of one chunk
+     *
+     * Memory is handed out from a few growing blocks and only released all at once when the
+     * arena is destroyed. Only trivially destructible objects go in, so nothing is destroyed
+     * one by one. Not thread safe, every chunk of a pass fills its own arena.
+     */
+    class OutputArena {
+    public:
+        explicit OutputArena(size_t firstBlockSize = FIRST_BLOCK_SIZE);
+
+        OutputArena(const OutputArena&) = delete;
+        OutputArena& operator=(const OutputArena&) = delete;
+
+        void* allocate(size_t size, size_t alignment);
+
+        template <typename T, typename... Args>
+        T* create(Args&&... args){
+            static_assert(std::is_trivially_destructible<T>::value, "OutputArena never destroys its objects");
+            return new (allocate(sizeof(T), alignof(T))) T(std::forward<Args>(args)...);
+        }
+
+        template <typename T>
+        T* copyArray(const T* items, size_t count){
+            static_assert(std::is_trivially_copyable<T>::value, "OutputArena copies arrays bytewise");
+            if(count == 0){
+                return nullptr;
+            }
+            T* copy = static_cast<T*>(allocate(sizeof(T) * count, alignof(T)));
+            std::memcpy(copy, items, sizeof(T) * count);
+            return copy;
+        }
+
+        // Keeps object alive as long as the arena, for data the objects in the arena point into
+        void retain(std::shared_ptr<const void> object){ m_retained.push_back(std::move(object)); }
+
+        size_t getBlockCount() const { return m_blocks.size(); }
+        size_t getReservedBytes() const { return m_reservedBytes; }
+
+    private:
+        static constexpr size_t FIRST_BLOCK_SIZE = 64 * 1024;
+        static constexpr size_t MAX_BLOCK_SIZE = 1024 * 1024;
+
+        std::vector<std::unique_ptr<char[]>> m_blocks;
+        std::vector<std::shared_ptr<const void>> m_retained;
+        char* m_current = nullptr;
+        size_t m_remaining = 0;
+        size_t m_nextBlockSize;
+        size_t m_reservedBytes = 0;
+    };
+
+    using OutputArenaPtr = std::shared_ptr<OutputArena>;
+}
@@ -1,6 +1,10 @@
 #include "OutputData.h"
+#include <algorithm>
+#include <chrono>
 #include <fstream>
+#include "FileSystem.h"
 #include "Logger.h"
+#include "ThreadPool.h"
 
 namespace Core {
     // Define a struct for search matches
@@ -16,7 +20,24 @@ namespace Core {
     }
 
     OutputData::~OutputData(){
-
+        {
+            std::lock_guard<std::mutex> lock(m_loadMutex);
+            m_bLoadStopping = true;
+        }
+        m_loadCondition.notify_all();
+        if(m_loadThread.joinable()){
+            m_loadThread.join();
+        }
+        {
+            std::lock_guard<std::mutex> lock(m_jobMutex);
+            m_bWorkerStopping = true;
+            m_pendingJob.reset();
+        }
+        m_jobGeneration++;
+        m_jobCondition.notify_all();
+        if(m_workerThread.joinable()){
+            m_workerThread.join();
+        }
     }
 
     bool OutputData::isActive() const{
@@ -27,9 +48,11 @@ namespace Core {
         m_bActive = bActive;
         if(m_bActive){
             pauseRefresh();
+            std::vector<std::shared_ptr<FileData>> files;
             for(auto it : m_allFiles){
-                loadFile(it.second);
+                files.push_back(it.second);
             }
+            loadFiles(files, {}, false);
             resumeRefresh();
             refresh();
         }
@@ -42,18 +65,19 @@ namespace Core {
     void OutputData::addFile(std::shared_ptr<FileData> file){
         m_allFiles[file->getFileId()] = file;
         if(m_bActive){
-            loadFile(file);
+            loadFiles({file}, {}, false);
         }
     }
 
     void OutputData::removeFile(int32_t id){
         std::map<int32_t, std::shared_ptr<FileData>>::iterator it = m_allFiles.find(id);
         if(it != m_allFiles.end()){
-            int32_t fileRow = it->second->getFileRow();
             m_loadedFiles.erase(id);
-            auto fileLineInfosIt = m_allFileLineInfos.find(id);
-            if(fileLineInfosIt != m_allFileLineInfos.end()){
-                m_allFileLineInfos.erase(fileLineInfosIt);
+            updateFileWatcher();
+            auto fileLineIndexIt = m_allFileLineIndexes.find(id);
+            if(fileLineIndexIt != m_allFileLineIndexes.end()){
+                m_allFileLineIndexes.erase(fileLineIndexIt);
+                updateNgramIndexes();
                 recreateOutputLines();
             }
             m_allFiles.erase(it);
@@ -64,50 +88,272 @@ namespace Core {
         recreateOutputLines();
     }
 
-    void OutputData::loadFile(std::shared_ptr<FileData> file){
-        if(m_loadedFiles.find(file->getFileId()) != m_loadedFiles.end()){
+    void OutputData::loadFiles(const std::vector<std::shared_ptr<FileData>>& files,
+                               const std::map<int32_t, FileLineIndexPtr>& previousFileLineIndexes, bool bReload){
+        auto load = std::make_shared<FileLoad>();
+        for(const auto& file : files){
+            const int32_t fileId = file->getFileId();
+            if(bReload || (m_loadedFiles.find(fileId) == m_loadedFiles.end() && m_loadingFileIds.find(fileId) == m_loadingFileIds.end())){
+                load->files.push_back(file);
+            }
+        }
+        if(load->files.empty() && !bReload){
+            return;
+        }
+        load->previousFileLineIndexes = previousFileLineIndexes;
+        load->bReload = bReload;
+        load->bAllowMapping = !m_bFollowFiles;
+        load->fileLineIndexes.resize(load->files.size());
+        for(const auto& file : load->files){
+            file->setLoadState(FileLoadState::Loading);
+        }
+        bool bQueued = false;
+        if(m_fileLoadCallback){
+            std::lock_guard<std::mutex> lock(m_loadMutex);
+            // A reload without files has nothing to wait for, unless an earlier load has to be taken in first
+            if(!load->files.empty() || !m_fileLoads.empty()){
+                m_fileLoads.push_back(load);
+                if(!m_loadThread.joinable()){
+                    m_loadThread = std::thread(&OutputData::loadWorkerLoop, this);
+                }
+                bQueued = true;
+            }
+        }
+        if(bQueued){
+            for(const auto& file : load->files){
+                m_loadingFileIds.insert(file->getFileId());
+            }
+            m_loadCondition.notify_all();
             return;
         }
-        m_loadedFiles[file->getFileId()] = file;
-        std::vector<std::shared_ptr<FileLineInfo>>& fileLineInfos = m_allFileLineInfos[file->getFileId()];
-        fileLineInfos.clear();
-        std::ifstream fileStream(file->getPath());
-        std::string line;
-        int32_t lineIndex = 0;
-        while (std::getline(fileStream, line)) {
-            //remove the last \n or \r\n
-            if(!line.empty() && line.back() == '\n'){
-                line.pop_back();
+        indexFiles(*load);
+        if(applyFileLoad(*load)){
+            recreateOutputLines();
+        }
+    }
+
+    void OutputData::loadWorkerLoop(){
+        while(true){
+            std::shared_ptr<FileLoad> load;
+            {
+                std::unique_lock<std::mutex> lock(m_loadMutex);
+                auto findNext = [this]{
+                    return std::find_if(m_fileLoads.begin(), m_fileLoads.end(), [](const auto& item){ return !item->bStarted; });
+                };
+                m_loadCondition.wait(lock, [&]{ return m_bLoadStopping || findNext() != m_fileLoads.end(); });
+                if(m_bLoadStopping){
+                    return;
+                }
+                load = *findNext();
+                load->bStarted = true;
+            }
+            indexFiles(*load);
+        }
+    }
+
+    void OutputData::indexFiles(FileLoad& load){
+        // Files are read and indexed at the same time, the pass over all of them runs once afterwards
+        ThreadPool::getInstance().parallelFor(load.files.size(), [&](size_t i){
+            if(m_bLoadStopping){
+                return;
+            }
+            FileData& file = *load.files[i];
+            FileLineIndexPtr fileLineIndex;
+            auto previousIt = load.previousFileLineIndexes.find(file.getFileId());
+            if(previousIt != load.previousFileLineIndexes.end()){
+                fileLineIndex = updateFileLineIndex(file, previousIt->second, false);
+            }else{
+                fileLineIndex = std::make_shared<FileLineIndex>();
+                if(!fileLineIndex->load(file.getPath(), load.bAllowMapping, &LineIndexCache::getInstance())){
+                    (Logger::getInstance() << "OutputData::loadFiles Failed to open file: " << file.getPath()).error();
+                }
+            }
+            const bool bLoaded = fileLineIndex->isLoaded();
+            {
+                // Stored before the callback, so the owner finds the load done after the callback of its last file
+                std::lock_guard<std::mutex> lock(m_loadMutex);
+                load.fileLineIndexes[i] = std::move(fileLineIndex);
+                load.loadedCount++;
             }
-            if(!line.empty() && line.back() == '\r'){
-                line.pop_back();
+            if(m_fileLoadCallback){
+                m_fileLoadCallback(file.getFileId(), bLoaded);
             }
-            //replay \r in the line with ' '
-            for(int32_t i = 0; i < line.size(); i++){
-                if(line[i] == '\r'){
-                    line[i] = ' ';
+        });
+    }
+
+    bool OutputData::updateLoadedFiles(){
+        std::vector<std::shared_ptr<FileLoad>> loads;
+        {
+            std::lock_guard<std::mutex> lock(m_loadMutex);
+            for(const auto& load : m_fileLoads){
+                for(size_t i = 0; i < load->files.size(); i++){
+                    if(load->fileLineIndexes[i]){
+                        load->files[i]->setLoadState(load->fileLineIndexes[i]->isLoaded() ? FileLoadState::Loaded : FileLoadState::Failed);
+                    }
                 }
             }
-            fileLineInfos.push_back(std::make_shared<FileLineInfo>(file->getFileId(), file->getFileRow(), lineIndex++, line, ""));
+            while(!m_fileLoads.empty() && m_fileLoads.front()->loadedCount == m_fileLoads.front()->files.size()){
+                loads.push_back(std::move(m_fileLoads.front()));
+                m_fileLoads.pop_front();
+            }
         }
-        if(!fileLineInfos.empty()){
+        bool bRecreate = false;
+        for(const auto& load : loads){
+            for(const auto& file : load->files){
+                m_loadingFileIds.erase(file->getFileId());
+            }
+            bRecreate = applyFileLoad(*load) || bRecreate;
+        }
+        if(bRecreate){
             recreateOutputLines();
         }
+        return !loads.empty();
+    }
+
+    bool OutputData::applyFileLoad(const FileLoad& load){
+        if(load.bReload){
+            m_loadedFiles.clear();
+            m_allFileLineIndexes.clear();
+        }
+        bool bHasLines = false;
+        for(size_t i = 0; i < load.files.size(); i++){
+            const auto& file = load.files[i];
+            const FileLineIndexPtr& fileLineIndex = load.fileLineIndexes[i];
+            file->setLoadState(fileLineIndex->isLoaded() ? FileLoadState::Loaded : FileLoadState::Failed);
+            // A file removed while it was loading is not taken in
+            if(m_allFiles.find(file->getFileId()) == m_allFiles.end()){
+                continue;
+            }
+            m_loadedFiles[file->getFileId()] = file;
+            m_allFileLineIndexes[file->getFileId()] = fileLineIndex;
+            bHasLines = bHasLines || fileLineIndex->getLineCount() > 0;
+        }
+        // A reload dropped the files loaded before, so the pass runs even when no file has lines now
+        bool bReload = load.bReload && !load.previousFileLineIndexes.empty();
+        if(!load.files.empty() || bReload){
+            updateFileWatcher();
+            updateNgramIndexes();
+        }
+        return bHasLines || bReload;
     }
 
     void OutputData::reloadFiles(){
+        // Files that are loaded already keep their index if their fingerprint did not change, and
+        // only read the appended lines if they grew, so the pass after it reuses their output.
+        // The files loaded so far stay in the output until the reloaded ones are taken in.
         pauseRefresh();
-        m_loadedFiles.clear();
-        m_allFileLineInfos.clear();
+        std::vector<std::shared_ptr<FileData>> files;
         for(auto it : m_allFiles){
             if(it.second->isSelected()){
-                loadFile(it.second);
+                files.push_back(it.second);
             }
         }
-        recreateOutputLines();
+        loadFiles(files, m_allFileLineIndexes, true);
         resumeRefresh();
         refresh();
     }
+
+    void OutputData::setFileLoadCallback(FileLoadCallback callback){
+        m_fileLoadCallback = std::move(callback);
+    }
+
+    void OutputData::setFollowFiles(bool bFollow){
+        m_bFollowFiles = bFollow;
+        updateFileWatcher();
+        if(m_bFollowFiles){
+            // Catch up with what was written while not following
+            updateFollowedFiles();
+        }
+    }
+
+    bool OutputData::isFollowingFiles() const{
+        return m_bFollowFiles;
+    }
+
+    void OutputData::setFileChangeCallback(FileChangeCallback callback){
+        // The watcher holds its own copy of the callback, so it is started again with the new one
+        m_fileWatcher.reset();
+        m_fileChangeCallback = std::move(callback);
+        updateFileWatcher();
+    }
+
+    void OutputData::updateFileWatcher(){
+        if(!m_bFollowFiles || !m_fileChangeCallback){
+            m_fileWatcher.reset();
+            return;
+        }
+        if(!m_fileWatcher){
+            m_fileWatcher = std::make_unique<FileWatcher>(m_fileChangeCallback);
+        }
+        std::vector<std::string> paths;
+        for(auto& it : m_loadedFiles){
+            paths.push_back(it.second->getPath());
+        }
+        m_fileWatcher->setPaths(paths);
+    }
+
+    void OutputData::updateNgramIndexes(){
+        if(!m_bNgramIndexEnabled){
+            m_ngramIndexBuilder.reset();
+            return;
+        }
+        if(!m_ngramIndexBuilder){
+            m_ngramIndexBuilder = std::make_unique<NgramIndexBuilder>();
+        }
+        m_ngramIndexBuilder->setFiles(m_allFileLineIndexes);
+    }
+
+    bool OutputData::updateFollowedFiles(){
+        bool bChanged = false;
+        for(auto& it : m_loadedFiles){
+            auto fileLineIndexIt = m_allFileLineIndexes.find(it.first);
+            if(fileLineIndexIt == m_allFileLineIndexes.end()){
+                continue;
+            }
+            // A file missing in the middle of a rotation keeps its lines until the new one is there
+            FileLineIndexPtr nextFileLineIndex = updateFileLineIndex(*it.second, fileLineIndexIt->second, true);
+            if(nextFileLineIndex != fileLineIndexIt->second){
+                fileLineIndexIt->second = nextFileLineIndex;
+                bChanged = true;
+            }
+        }
+        if(bChanged){
+            updateNgramIndexes();
+            recreateOutputLines();
+        }
+        return bChanged;
+    }
+
+    FileLineIndexPtr OutputData::updateFileLineIndex(FileData& file, const FileLineIndexPtr& fileLineIndex, bool bKeepMissingFile) const{
+        const std::string& path = file.getPath();
+        FileStatus status;
+        const bool bExists = MappedFile::getStatus(path, status);
+        if(!bExists && bKeepMissingFile){
+            return fileLineIndex;
+        }
+        // A file loaded before following started is still mapped and is read once more into memory
+        const bool bRemap = m_bFollowFiles && fileLineIndex->isMapped();
+        if(bExists && status == fileLineIndex->getFileStatus() && !bRemap){
+            return fileLineIndex;
+        }
+        auto nextFileLineIndex = std::make_shared<FileLineIndex>();
+        bool bAppended = bExists && !bRemap && status.isSameFile(fileLineIndex->getFileStatus()) && status.size > fileLineIndex->getSize()
+            && nextFileLineIndex->loadAppended(path, *fileLineIndex);
+        if(!bAppended){
+            if(!bRemap){
+                Logger::getInstance().info("OutputData::updateFileLineIndex File was replaced or truncated, loading it again: " + path);
+            }
+            nextFileLineIndex = std::make_shared<FileLineIndex>();
+            if(!nextFileLineIndex->load(path, !m_bFollowFiles, &LineIndexCache::getInstance())){
+                (Logger::getInstance() << "OutputData::updateFileLineIndex Failed to open file: " << path).error();
+            }
+        }
+        file.setFileSize(static_cast<int64_t>(nextFileLineIndex->getSize()));
+        if(bExists){
+            file.setModifiedTime(FileSystem::toTimeT(FileSystem::lastWriteTime(path)));
+        }
+        return nextFileLineIndex;
+    }
     ////////////////////////////////////////////////////////////
     // Filter management
     ////////////////////////////////////////////////////////////
@@ -116,6 +362,7 @@ namespace Core {
         m_filters[filter->getId()] = filter;
         if(filter->isEnabled()){
             m_enabledFilters[filter->getRow()] = filter;
+            m_bFilterSetChanged = true;
             recreateOutputLines();
         }
     }
@@ -126,6 +373,7 @@ namespace Core {
             auto filterRow = it->second->getRow();
             if(m_enabledFilters.find(filterRow) != m_enabledFilters.end()){
                 m_enabledFilters.erase(filterRow);
+                m_bFilterSetChanged = true;
                 recreateOutputLines();
             }
             m_filters.erase(it);
@@ -134,6 +382,7 @@ namespace Core {
 
     void OutputData::refreshByFilterRowsChanged(){
         m_enabledFilters.clear();
+        m_bFilterSetChanged = true;
         for(auto it : m_filters){
             if(it.second->isEnabled()){
                 m_enabledFilters[it.second->getRow()] = it.second;
@@ -146,6 +395,7 @@ namespace Core {
         m_filters.clear();
         if(m_enabledFilters.size() > 0){
             m_enabledFilters.clear();
+            m_bFilterSetChanged = true;
             recreateOutputLines();
         }
     }
@@ -154,6 +404,7 @@ namespace Core {
         auto it = m_filters.find(filter.getId());
         if(it != m_filters.end()){  
             it->second->update(filter);
+            m_bFilterSetChanged = true;
             if(filter.isEnabled()){
                 m_enabledFilters[filter.getRow()] = it->second;
             }else{
@@ -164,6 +415,7 @@ namespace Core {
     }
 
     std::map<int32_t, int32_t> OutputData::getFilterMatchCounts() const{
+        std::lock_guard<std::mutex> lock(m_outputMutex);
         return m_filterMatchCount;
     }
 
@@ -223,6 +475,7 @@ namespace Core {
     }
 
     std::map<int32_t, int32_t> OutputData::getSearchMatchCounts() const{
+        std::lock_guard<std::mutex> lock(m_outputMutex);
         return m_searchMatchCount;
     }
 
@@ -253,255 +506,702 @@ namespace Core {
             return;
         }
         m_bHasPendingRecreateOutputLines = false;
-        m_outputLines.clear();
-        m_outputLinesAfterFilters.clear();
-        m_outputLinesAfterSearches.clear();
-        m_filterMatchCount.clear();
-        m_filterLineMap.clear();
-        m_searchMatchCount.clear();
-        m_searchLineMap.clear();
-        // Apply filters first
-        applyEnabledFilters();
-        // Then apply searches
-        applyEnabledSearches();
-        combineFiltersAndSearches();
-        m_outputWindow.setLinesCount(m_outputLines.size());
-        (Logger::getInstance() << "Recreating output lines, total lines: " << m_outputLines.size()).info();
+        std::shared_ptr<OutputJob> job = createOutputJob();
+        if(!m_outputUpdateCallback){
+            runOutputJob(job);
+            return;
+        }
+        {
+            std::lock_guard<std::mutex> lock(m_jobMutex);
+            m_pendingJob = job;
+            if(!m_workerThread.joinable()){
+                m_workerThread = std::thread(&OutputData::workerLoop, this);
+            }
+        }
+        m_jobCondition.notify_all();
     }
 
-    void OutputData::applyEnabledFilters(){
-        //loop m_allFileLineInfos, apply filters
-        std::map<int32_t/*fileRow*/, int32_t/*fileId*/> fileRowToId;
-        //sort the fileIds by fileRow
-        for(auto it: m_allFileLineInfos){
-            auto fileId = it.first;
-            auto fileRow = m_allFiles[fileId]->getFileRow();
-            fileRowToId[fileRow] = fileId;
+    void OutputData::setOutputUpdateCallback(OutputUpdateCallback callback){
+        // The worker reads the callback without locking, so only swap it while no job runs
+        waitForRefresh();
+        m_outputUpdateCallback = std::move(callback);
+    }
+
+    void OutputData::cancelRefresh(){
+        {
+            std::lock_guard<std::mutex> lock(m_jobMutex);
+            m_pendingJob.reset();
         }
-        for(auto it : fileRowToId){
-            auto fileId = it.second;
-            auto fileRow = it.first;
-            for(auto itLine : m_allFileLineInfos[fileId]){
-                std::shared_ptr<OutputLine> outputLine = std::make_shared<OutputLine>();
-                outputLine->setFileId(fileId);
-                outputLine->setFileRow(fileRow);
-                outputLine->setLineIndex(itLine->fileLineIndex);
-                outputLine->setContent(std::string_view(itLine->lineContent));
-
-                std::list<OutputSubLine> subLines;
-                OutputSubLine subLine;
-                subLine.setContent(std::string_view(itLine->lineContent));
-                subLines.push_back(subLine);
-
-                if(!m_enabledFilters.empty()){
-                    for(auto itFilter : m_enabledFilters){
-                        std::list<OutputSubLine> subLines2;
-                        for(auto& subLine : subLines){
-                            if(subLine.getFilterId() != -1){
-                                subLines2.push_back(subLine);
-                            }else{
-                                itFilter.second->apply(subLine.getContent(), subLines2);
-                            }
-                        }
-                        subLines = subLines2;
-                    }
-                    bool matched = false;
-                    int32_t outputLineIndex = (int32_t)m_outputLinesAfterFilters.size();
-                    int32_t outputSubLineIndex = 0;
-                    for(auto& subLine : subLines){
-                        if(subLine.getFilterId() != -1){
-                            matched = true;
-                            m_filterMatchCount[subLine.getFilterId()]++;
-                            m_filterLineMap[subLine.getFilterId()].insert(outputLineIndex);
-                        }
-                        outputLine->addSubLine(subLine);
-                        outputSubLineIndex++;
-                    }
-                    if(matched){
-                        m_outputLinesAfterFilters.push_back(outputLine);
-                    }
-                }else
-                {
-                    for(auto& subLine : subLines){
-                        outputLine->addSubLine(subLine);
-                    }
-                    m_outputLinesAfterFilters.push_back(outputLine);
+        m_jobGeneration++;
+    }
+
+    bool OutputData::isRefreshing() const{
+        std::lock_guard<std::mutex> lock(m_jobMutex);
+        return m_pendingJob || m_bWorkerBusy;
+    }
+
+    void OutputData::waitForRefresh(){
+        std::unique_lock<std::mutex> lock(m_jobMutex);
+        m_jobCondition.wait(lock, [this]{ return !m_pendingJob && !m_bWorkerBusy; });
+    }
+
+    std::shared_ptr<OutputData::OutputJob> OutputData::createOutputJob(){
+        // Styles are only added to a copy, so lines of earlier passes still resolve against the new table
+        auto styles = m_styleTable ? std::make_shared<OutputStyleTable>(*m_styleTable) : std::make_shared<OutputStyleTable>();
+        if(m_bFilterSetChanged || !m_filterSetMatcher){
+            m_filterSetMatcher = std::make_shared<FilterSetMatcher>(m_enabledFilters, *styles);
+            m_bFilterSetChanged = false;
+        }
+        auto job = std::make_shared<OutputJob>();
+        job->generation = ++m_jobGeneration;
+        job->bParallel = m_bParallelEnabled;
+        job->chunks = createOutputChunks();
+        job->filterSetMatcher = m_filterSetMatcher;
+        job->filters.reserve(m_enabledFilters.size());
+        for(auto& it : m_enabledFilters){
+            job->filters.push_back(*it.second);
+        }
+        job->searches.reserve(m_enabledSearches.size());
+        for(auto& it : m_enabledSearches){
+            job->searches.push_back(*it.second);
+            job->searchStyleIds.push_back(styles->addStyle(it.second->getStyle()));
+        }
+        if(!m_styleTable || styles->size() != m_styleTable->size()){
+            std::lock_guard<std::mutex> lock(m_outputMutex);
+            m_styleTable = styles;
+        }
+        job->styles = m_styleTable;
+        return job;
+    }
+
+    bool OutputData::isOutputJobCancelled(const OutputJob& job) const{
+        return job.generation != m_jobGeneration.load(std::memory_order_relaxed);
+    }
+
+    void OutputData::workerLoop(){
+        while(true){
+            std::shared_ptr<OutputJob> job;
+            {
+                std::unique_lock<std::mutex> lock(m_jobMutex);
+                m_bWorkerBusy = false;
+                m_jobCondition.notify_all();
+                m_jobCondition.wait(lock, [this]{ return m_pendingJob || m_bWorkerStopping; });
+                if(m_bWorkerStopping){
+                    return;
+                }
+                job = std::move(m_pendingJob);
+                m_bWorkerBusy = true;
+            }
+            bool bCompleted = runOutputJob(job);
+            if(!bCompleted){
+                // Superseded jobs stay silent, the next one reports. A cancelRefresh() leaves the partial output in place.
+                std::lock_guard<std::mutex> lock(m_jobMutex);
+                if(m_pendingJob || m_bWorkerStopping){
+                    continue;
                 }
             }
+            m_outputUpdateCallback(true);
         }
     }
-    
-    
-    void OutputData::applyEnabledSearches() {
-        for(auto& filteredLine : m_outputLinesAfterFilters){
-            auto fileId = filteredLine->getFileId();
-            auto fileRow = filteredLine->getFileRow();
-            auto lineIndex = filteredLine->getLineIndex();
-
-            auto& fileLines = m_allFileLineInfos[fileId];
-            assert(lineIndex < fileLines.size());
-            auto& fileLine = fileLines[lineIndex];
-
-            std::shared_ptr<OutputLine> outputLine = std::make_shared<OutputLine>();
-            outputLine->setFileId(fileId);
-            outputLine->setFileRow(fileRow);
-            outputLine->setLineIndex(lineIndex);
-
-            std::list<OutputSubLine> subLines;
-            OutputSubLine subLine;
-            subLine.setContent(std::string_view(fileLine->lineContent));
-            subLines.push_back(subLine);
-
-            if(!m_enabledSearches.empty()){
-                for(auto itSearch : m_enabledSearches){
-                    std::list<OutputSubLine> subLines2;
-                    for(auto& subLine : subLines){
-                        if(subLine.getSearchId() != -1){
-                            subLines2.push_back(subLine);
-                        }else{
-                            itSearch.second->apply(subLine.getContent(), subLines2);
-                        }
-                    }
-                    subLines = subLines2;
-                }
-                bool matched = false;
-                int32_t outputLineIndex = (int32_t)m_outputLinesAfterSearches.size();
-                int32_t outputSubLineIndex = 0;
-                for(auto& subLine : subLines){
-                    if(subLine.getSearchId() != -1){
-                        matched = true;
-                        m_searchMatchCount[subLine.getSearchId()]++;
-                        m_searchLineMap[subLine.getSearchId()].insert(outputLineIndex);
-                    }
-                    outputLine->addSubLine(subLine);
-                    outputSubLineIndex++;
+
+    bool OutputData::runOutputJob(const std::shared_ptr<const OutputJob>& job){
+        auto startTime = std::chrono::steady_clock::now();
+        PreviousOutput previous;
+        {
+            std::lock_guard<std::mutex> lock(m_outputMutex);
+            previous.job = std::move(m_completedJob);
+            previous.chunkOffsets.swap(m_completedChunkOffsets);
+            previous.linesAfterFilters.swap(m_outputLinesAfterFilters);
+            previous.linesAfterSearches.swap(m_outputLinesAfterSearches);
+            previous.filterLineMap.swap(m_filterLineMap);
+            previous.searchLineMap.swap(m_searchLineMap);
+            previous.fileLineIndexes.swap(m_outputFileLineIndexes);
+            m_completedJob.reset();
+            m_filterMatchCount.clear();
+            m_searchMatchCount.clear();
+            for(auto& chunk : job->chunks){
+                if(m_outputFileLineIndexes.empty() || m_outputFileLineIndexes.back() != chunk.fileLineIndex){
+                    m_outputFileLineIndexes.push_back(chunk.fileLineIndex);
+                }
+            }
+            m_outputWindow.setLinesCount(0);
+        }
+
+        // When the last pass completed and only some filters or searches changed since, lines none
+        // of the changes can affect keep their output from that pass
+        OutputUpdatePlan plan;
+        bool bIncremental = previous.job && createOutputUpdatePlan(*previous.job, *job, plan);
+        std::vector<PreviousMatchedLines> previousMatchedLines;
+        if(bIncremental){
+            previousMatchedLines = collectPreviousMatchedLines(previous, plan);
+        }else{
+            previous = PreviousOutput();
+        }
+
+        // Lines are independent, so chunks of lines run through the whole pipeline on their own.
+        // In the background, chunks go in batches that are merged and published one after another,
+        // so the first lines can be shown early and a newer job can stop this one between chunks.
+        size_t batchSize = job->chunks.size();
+        if(m_outputUpdateCallback){
+            batchSize = job->bParallel ? ThreadPool::getInstance().getConcurrency() * 2 : 1;
+        }
+        std::vector<int32_t> chunkOffsets;
+        chunkOffsets.reserve(job->chunks.size() + 1);
+        int64_t evaluatedLineCount = 0;
+        auto lastNotifyTime = startTime;
+        bool bNotified = false;
+        for(size_t batchBegin = 0; batchBegin < job->chunks.size(); batchBegin += batchSize){
+            size_t batchEnd = std::min(job->chunks.size(), batchBegin + batchSize);
+            std::vector<OutputChunkResult> results(batchEnd - batchBegin);
+            auto processChunk = [&](size_t index){
+                if(isOutputJobCancelled(*job)){
+                    return;
+                }
+                size_t chunkIndex = batchBegin + index;
+                int32_t previousChunkIndex = bIncremental ? plan.previousChunkIndexes[chunkIndex] : -1;
+                if(previousChunkIndex >= 0){
+                    updateOutputChunk(*job, chunkIndex, previous, previousMatchedLines[previousChunkIndex], plan, results[index]);
+                }else{
+                    createOutputChunk(*job, job->chunks[chunkIndex], results[index]);
                 }
-                m_outputLinesAfterSearches.push_back(outputLine);
+            };
+            if(job->bParallel){
+                ThreadPool::getInstance().parallelFor(results.size(), processChunk);
             }else{
-                for(auto& subLine : subLines){
-                    outputLine->addSubLine(subLine);
+                for(size_t i = 0; i < results.size(); i++){
+                    processChunk(i);
+                }
+            }
+            if(isOutputJobCancelled(*job)){
+                Logger::getInstance().info("Recreating output lines cancelled after " + std::to_string(batchBegin) + " of " + std::to_string(job->chunks.size()) + " chunks");
+                return false;
+            }
+            {
+                std::lock_guard<std::mutex> lock(m_outputMutex);
+                for(auto& result : results){
+                    chunkOffsets.push_back((int32_t)m_outputLinesAfterFilters.size());
+                    evaluatedLineCount += result.evaluatedLineCount;
+                    mergeOutputChunkResult(result);
+                }
+                m_outputWindow.setLinesCount(m_outputLinesAfterFilters.size());
+            }
+            if(m_outputUpdateCallback && batchEnd < job->chunks.size()){
+                auto now = std::chrono::steady_clock::now();
+                if(!bNotified || now - lastNotifyTime >= std::chrono::milliseconds(PROGRESS_INTERVAL_MS)){
+                    m_outputUpdateCallback(false);
+                    bNotified = true;
+                    lastNotifyTime = now;
                 }
-                m_outputLinesAfterSearches.push_back(outputLine);
             }
         }
+        {
+            std::lock_guard<std::mutex> lock(m_outputMutex);
+            chunkOffsets.push_back((int32_t)m_outputLinesAfterFilters.size());
+            m_completedChunkOffsets = std::move(chunkOffsets);
+            m_completedJob = job;
+        }
+        auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - startTime);
+        Logger::getInstance().info("Recreating output lines, total lines: " + std::to_string(m_outputLinesAfterFilters.size())
+            + ", evaluated lines: " + std::to_string(evaluatedLineCount) + (bIncremental ? " (incremental)" : "")
+            + ", " + std::to_string(elapsed.count()) + " ms");
+        return true;
     }
 
-    void OutputData::combineFiltersAndSearches(){
-        m_outputLines.clear();
-        assert(m_outputLinesAfterFilters.size() == m_outputLinesAfterSearches.size());
-        for(int32_t i = 0; i < m_outputLinesAfterFilters.size(); i++){
-            auto& filteredLine = m_outputLinesAfterFilters[i];
-            auto& searchedLine = m_outputLinesAfterSearches[i];
+    namespace {
+        // Copies the line and its spans into the arena, the returned pointer shares the ownership of the arena
+        std::shared_ptr<OutputLine> copyToArena(const OutputLine& line, const OutputArenaPtr& arena){
+            OutputSpanRange spans = line.getSpans();
+            OutputLine* arenaLine = arena->create<OutputLine>(line);
+            arenaLine->setSpans(OutputSpanRange(arena->copyArray(spans.begin(), spans.size()), spans.size()));
+            return std::shared_ptr<OutputLine>(arena, arenaLine);
+        }
 
-            auto& filteredSubLines = filteredLine->getSubLines();
-            auto& searchedSubLines = searchedLine->getSubLines();
-            
-            // Create a new OutputLine for the result
-            auto combinedLine = std::make_shared<OutputLine>();
-            combinedLine->setFileId(filteredLine->getFileId());
-            combinedLine->setFileRow(filteredLine->getFileRow());
-            combinedLine->setLineIndex(filteredLine->getLineIndex());
-            
-            // If there's no sublines in either, just continue
-            if (filteredSubLines.empty() && searchedSubLines.empty()) {
-                m_outputLines.push_back(combinedLine);
-                continue;
+        bool isInArena(const std::shared_ptr<OutputLine>& line, const OutputArenaPtr& arena){
+            return !line.owner_before(arena) && !arena.owner_before(line);
+        }
+
+        // Settings that decide where a filter or search matches
+        template <typename T>
+        bool isSameMatchSetting(const T& a, const T& b){
+            return a.getPattern() == b.getPattern() && a.isCaseSensitive() == b.isCaseSensitive()
+                && a.isWholeWord() == b.isWholeWord() && a.isRegex() == b.isRegex();
+        }
+
+        // Settings copied into the sublines
+        template <typename T>
+        bool isSameDisplaySetting(const T& a, const T& b){
+            return a.getId() == b.getId() && a.getRow() == b.getRow() && a.getColor() == b.getColor();
+        }
+
+        // Filters and searches both apply one after another on what the earlier ones left unmatched.
+        // As long as the ones kept from the previous pass keep their order, one that matches nothing
+        // in a line leaves it as it is, so only lines an added or changed one may match, and lines a
+        // removed or changed one did match, can differ. Returns false when the order changed.
+        template <typename T>
+        bool diffPatternLists(const std::vector<T>& previous, const std::vector<T>& current,
+                              std::vector<PatternMatcherPtr>& candidateMatchers, std::set<int32_t>& previousIds,
+                              bool& bEmptyLinesAffected){
+            std::map<int32_t/*id*/, size_t/*position*/> previousPositions;
+            for(size_t i = 0; i < previous.size(); i++){
+                previousPositions[previous[i].getId()] = i;
             }
-            
-            // If there's no search sublines, just use filter sublines
-            if (searchedSubLines.empty()) {
-                for (auto& subLine : filteredSubLines) {
-                    combinedLine->addSubLine(subLine);
+            std::set<int32_t> keptIds;
+            bool bHasKept = false;
+            size_t lastPosition = 0;
+            for(auto& item : current){
+                auto it = previousPositions.find(item.getId());
+                if(it == previousPositions.end()){
+                    if(item.getMatcher()){
+                        candidateMatchers.push_back(item.getMatcher());
+                    }
+                    continue;
+                }
+                if(bHasKept && it->second < lastPosition){
+                    return false;
+                }
+                bHasKept = true;
+                lastPosition = it->second;
+                keptIds.insert(item.getId());
+                const T& previousItem = previous[it->second];
+                if(!isSameMatchSetting(previousItem, item)){
+                    previousIds.insert(item.getId());
+                    if(item.getMatcher()){
+                        candidateMatchers.push_back(item.getMatcher());
+                    }
+                }else if(!isSameDisplaySetting(previousItem, item)){
+                    previousIds.insert(item.getId());
                 }
-                m_outputLines.push_back(combinedLine);
-                continue;
             }
-            
-            // If there's no filter sublines, just use search sublines
-            if (filteredSubLines.empty()) {
-                for (auto& subLine : searchedSubLines) {
-                    combinedLine->addSubLine(subLine);
+            for(auto& item : previous){
+                if(keptIds.find(item.getId()) == keptIds.end()){
+                    previousIds.insert(item.getId());
                 }
-                m_outputLines.push_back(combinedLine);
-                continue;
             }
-            
-            std::list<OutputSubLine> combinedSubLines;
-            for(auto& filteredSubLine : filteredSubLines){
-                combinedSubLines.push_back(filteredSubLine);
+            // Later ones never see an empty line, only the first gets to match it
+            if(previous.empty() || current.empty()){
+                bEmptyLinesAffected = previous.size() != current.size();
+            }else{
+                bEmptyLinesAffected = previous.front().getId() != current.front().getId()
+                    || !isSameMatchSetting(previous.front(), current.front());
             }
-            for(auto& searchedSubLine : searchedSubLines){
-                if(searchedSubLine.getSearchId() == -1){
+            return true;
+        }
+
+        void collectLineIndexes(const std::map<int32_t, LineIndexSet>& lineMap, const std::set<int32_t>& ids,
+                                const std::vector<int32_t>& offsets, const std::vector<std::shared_ptr<OutputLine>>& lines,
+                                std::vector<std::vector<int32_t>*>& chunkLines){
+            for(int32_t id : ids){
+                auto it = lineMap.find(id);
+                if(it == lineMap.end()){
                     continue;
                 }
-                std::string_view searchContent = searchedSubLine.getContent();
-                const char* search_first = searchContent.data();
-                const char* search_last = search_first + searchContent.size() - 1;
-                
-                std::list<OutputSubLine> combinedSubLines2;
-                for(auto& combinedSubLine : combinedSubLines){
-                    std::string_view combinedContent = combinedSubLine.getContent();
-                    const char* combined_first = combinedContent.data();
-                    const char* combined_last = combined_first + combinedContent.size() - 1;
-                    if(search_first > combined_last){
-                        combinedSubLines2.push_back(combinedSubLine);
-                        continue;
-                    }
-                    if(search_last < combined_first){
-                        combinedSubLines2.push_back(combinedSubLine);
-                        continue;
-                    }
-                    size_t total_size = combinedContent.size();
-                    size_t left_combined_size = 0;
-                    size_t middle_searched_size = 0;
-                    size_t right_combined_size = 0;
-
-                    const char* middle_searched_first = nullptr;
-                    const char* middle_searched_last = nullptr;
-                    if(combined_first < search_first){
-                        left_combined_size = search_first - combined_first;
-                        middle_searched_first = search_first;
-                    }else{
-                        middle_searched_first = combined_first;
-                    }
-                    if(combined_last > search_last){
-                        right_combined_size = combined_last - search_last;
-                        middle_searched_last = search_last;
+                for(int32_t outputLineIndex : it->second){
+                    size_t chunkIndex = std::upper_bound(offsets.begin(), offsets.end(), outputLineIndex) - offsets.begin() - 1;
+                    chunkLines[chunkIndex]->push_back(lines[outputLineIndex]->getLineIndex());
+                }
+            }
+            for(auto* lineIndexes : chunkLines){
+                std::sort(lineIndexes->begin(), lineIndexes->end());
+                lineIndexes->erase(std::unique(lineIndexes->begin(), lineIndexes->end()), lineIndexes->end());
+            }
+        }
+    }
+
+    bool OutputData::createOutputUpdatePlan(const OutputJob& previous, const OutputJob& job, OutputUpdatePlan& plan) const{
+        // A chunk continues the previous one at the same place of the same file, or of an index appended to it
+        std::map<std::pair<int32_t/*fileId*/, int32_t/*beginLine*/>, int32_t/*chunkIndex*/> previousChunkIndexes;
+        for(size_t i = 0; i < previous.chunks.size(); i++){
+            previousChunkIndexes[{previous.chunks[i].fileId, previous.chunks[i].beginLine}] = (int32_t)i;
+        }
+        plan.previousChunkIndexes.assign(job.chunks.size(), -1);
+        for(size_t i = 0; i < job.chunks.size(); i++){
+            const OutputChunk& b = job.chunks[i];
+            auto it = previousChunkIndexes.find({b.fileId, b.beginLine});
+            if(it == previousChunkIndexes.end()){
+                continue;
+            }
+            const OutputChunk& a = previous.chunks[it->second];
+            if(a.fileRow == b.fileRow && (a.fileLineIndex == b.fileLineIndex
+               || a.fileLineIndex->getLineageId() == b.fileLineIndex->getLineageId())){
+                plan.previousChunkIndexes[i] = it->second;
+            }
+        }
+        if(!diffPatternLists(previous.filters, job.filters, plan.filters.candidateMatchers,
+                             plan.filters.previousIds, plan.filters.bEmptyLinesAffected)){
+            return false;
+        }
+        // Without filters every line is shown
+        if(!plan.filters.isEmpty() && (previous.filters.empty() || job.filters.empty())){
+            return false;
+        }
+        return diffPatternLists(previous.searches, job.searches, plan.searches.candidateMatchers,
+                                plan.searches.previousIds, plan.searches.bEmptyLinesAffected);
+    }
+
+    std::vector<OutputData::PreviousMatchedLines> OutputData::collectPreviousMatchedLines(const PreviousOutput& previous, const OutputUpdatePlan& plan) const{
+        std::vector<PreviousMatchedLines> matchedLines(previous.chunkOffsets.size() - 1);
+        std::vector<std::vector<int32_t>*> filterLines;
+        std::vector<std::vector<int32_t>*> searchLines;
+        for(auto& chunkLines : matchedLines){
+            filterLines.push_back(&chunkLines.filterLines);
+            searchLines.push_back(&chunkLines.searchLines);
+        }
+        collectLineIndexes(previous.filterLineMap, plan.filters.previousIds, previous.chunkOffsets, previous.linesAfterFilters, filterLines);
+        collectLineIndexes(previous.searchLineMap, plan.searches.previousIds, previous.chunkOffsets, previous.linesAfterFilters, searchLines);
+        return matchedLines;
+    }
+
+    void OutputData::setParallelEnabled(bool bEnabled){
+        m_bParallelEnabled = bEnabled;
+    }
+
+    bool OutputData::isParallelEnabled() const{
+        return m_bParallelEnabled;
+    }
+
+    void OutputData::setNgramIndexEnabled(bool bEnabled){
+        m_bNgramIndexEnabled = bEnabled;
+        updateNgramIndexes();
+    }
+
+    bool OutputData::isNgramIndexEnabled() const{
+        return m_bNgramIndexEnabled;
+    }
+
+    std::vector<OutputData::OutputChunk> OutputData::createOutputChunks() const{
+        std::vector<OutputChunk> chunks;
+        //sort the fileIds by fileRow
+        std::map<int32_t/*fileRow*/, int32_t/*fileId*/> fileRowToId;
+        for(auto& it : m_allFileLineIndexes){
+            auto fileId = it.first;
+            auto fileRow = m_allFiles.at(fileId)->getFileRow();
+            fileRowToId[fileRow] = fileId;
+        }
+        for(auto& it : fileRowToId){
+            auto& fileLineIndex = m_allFileLineIndexes.at(it.second);
+            NgramIndexPtr ngramIndex = m_ngramIndexBuilder ? m_ngramIndexBuilder->getIndex(it.second, *fileLineIndex) : nullptr;
+            int32_t lineCount = fileLineIndex->getLineCount();
+            for(int32_t beginLine = 0; beginLine < lineCount; beginLine += CHUNK_LINE_COUNT){
+                OutputChunk chunk;
+                chunk.fileId = it.second;
+                chunk.fileRow = it.first;
+                chunk.fileLineIndex = fileLineIndex;
+                chunk.ngramIndex = ngramIndex;
+                chunk.beginLine = beginLine;
+                chunk.endLine = std::min(lineCount, beginLine + CHUNK_LINE_COUNT);
+                chunks.push_back(chunk);
+            }
+        }
+        return chunks;
+    }
+
+    void OutputData::mergeOutputChunkResult(OutputChunkResult& result){
+        int32_t lineOffset = (int32_t)m_outputLinesAfterFilters.size();
+        for(auto& it : result.filterMatchCount){
+            m_filterMatchCount[it.first] += it.second;
+        }
+        for(auto& it : result.filterLineMap){
+            auto& lineSet = m_filterLineMap[it.first];
+            for(int32_t outputLineIndex : it.second){
+                lineSet.append(lineOffset + outputLineIndex);
+            }
+        }
+        for(auto& it : result.searchMatchCount){
+            m_searchMatchCount[it.first] += it.second;
+        }
+        for(auto& it : result.searchLineMap){
+            auto& lineSet = m_searchLineMap[it.first];
+            for(int32_t outputLineIndex : it.second){
+                lineSet.append(lineOffset + outputLineIndex);
+            }
+        }
+        m_outputLinesAfterFilters.insert(m_outputLinesAfterFilters.end(), result.linesAfterFilters.begin(), result.linesAfterFilters.end());
+        m_outputLinesAfterSearches.insert(m_outputLinesAfterSearches.end(), result.linesAfterSearches.begin(), result.linesAfterSearches.end());
+    }
+
+    OutputData::ChunkCandidates OutputData::createChunkCandidates(const OutputJob& job, const OutputChunk& chunk){
+        ChunkCandidates candidates;
+        candidates.searchLines.resize(job.searches.size());
+        // The Bloom filters of the file are there from the start, the index once it is built
+        auto restrict = [&](NgramCandidateLines& lines, const std::vector<std::string_view>& literals){
+            lines.restrict(*chunk.fileLineIndex, literals, chunk.beginLine, chunk.endLine);
+            if(chunk.ngramIndex){
+                lines.restrict(*chunk.ngramIndex, literals, chunk.beginLine, chunk.endLine);
+            }
+        };
+        // Without filters every line is shown. A filter or search with an invalid pattern matches nothing.
+        std::vector<std::string_view> literals;
+        if(!job.filters.empty()){
+            for(auto& filter : job.filters){
+                if(filter.getMatcher()){
+                    literals.push_back(filter.getMatcher()->getRequiredLiteral());
+                }
+            }
+            restrict(candidates.filterLines, literals);
+        }
+        for(size_t i = 0; i < job.searches.size(); i++){
+            literals.clear();
+            if(job.searches[i].getMatcher()){
+                literals.push_back(job.searches[i].getMatcher()->getRequiredLiteral());
+            }
+            restrict(candidates.searchLines[i], literals);
+        }
+        return candidates;
+    }
+
+    void OutputData::createOutputChunk(const OutputJob& job, const OutputChunk& chunk, OutputChunkResult& result) const{
+        result.arena = std::make_shared<OutputArena>();
+        result.arena->retain(chunk.fileLineIndex);
+        ChunkCandidates candidates = createChunkCandidates(job, chunk);
+        for(int32_t lineIndex = chunk.beginLine; lineIndex < chunk.endLine; lineIndex++){
+            createOutputLine(job, chunk, lineIndex, candidates, result);
+        }
+        result.evaluatedLineCount = chunk.endLine - chunk.beginLine;
+    }
+
+    void OutputData::updateOutputChunk(const OutputJob& job, size_t chunkIndex, const PreviousOutput& previous,
+                                       const PreviousMatchedLines& previousMatchedLines, const OutputUpdatePlan& plan,
+                                       OutputChunkResult& result) const{
+        const OutputChunk& chunk = job.chunks[chunkIndex];
+        int32_t previousChunkIndex = plan.previousChunkIndexes[chunkIndex];
+        const OutputChunk& previousChunk = previous.job->chunks[previousChunkIndex];
+        int32_t previousIndex = previous.chunkOffsets[previousChunkIndex];
+        int32_t previousEnd = previous.chunkOffsets[previousChunkIndex + 1];
+        // Of a file appended to since, lines are reused up to the last one that was complete
+        const FileLineIndex* appendedFileLineIndex = nullptr;
+        int32_t reusableEndLine = previousChunk.endLine;
+        if(previousChunk.fileLineIndex != chunk.fileLineIndex){
+            appendedFileLineIndex = chunk.fileLineIndex.get();
+            reusableEndLine = std::min(reusableEndLine, previousChunk.fileLineIndex->getCompleteLineCount());
+        }
+        size_t filterMatchedPos = 0;
+        size_t searchMatchedPos = 0;
+        result.arena = std::make_shared<OutputArena>();
+        result.arena->retain(chunk.fileLineIndex);
+        ChunkCandidates candidates = createChunkCandidates(job, chunk);
+        if(plan.filters.isEmpty()){
+            // The filtered lines stay the same, only the searches run again on the ones they may change
+            for(; previousIndex < previousEnd; previousIndex++){
+                const OutputLine& filteredLine = *previous.linesAfterFilters[previousIndex];
+                if(filteredLine.getLineIndex() >= reusableEndLine){
+                    break;
+                }
+                if(isLineAffected(plan.searches, previousMatchedLines.searchLines, searchMatchedPos,
+                                  filteredLine.getLineIndex(), filteredLine.getContent())){
+                    updateOutputLineSearches(job, previous, previousIndex, candidates, result);
+                    result.evaluatedLineCount++;
+                }else{
+                    appendOutputLine(result, *job.styles, previous.linesAfterFilters[previousIndex],
+                                     previous.linesAfterSearches[previousIndex]);
+                }
+            }
+        }else{
+            for(int32_t lineIndex = chunk.beginLine; lineIndex < reusableEndLine; lineIndex++){
+                bool bHasPrevious = previousIndex < previousEnd && previous.linesAfterFilters[previousIndex]->getLineIndex() == lineIndex;
+                std::string_view lineContent = chunk.fileLineIndex->getLine(lineIndex);
+                if(isLineAffected(plan.filters, previousMatchedLines.filterLines, filterMatchedPos, lineIndex, lineContent)){
+                    createOutputLine(job, chunk, lineIndex, candidates, result);
+                    result.evaluatedLineCount++;
+                }else if(bHasPrevious){
+                    if(isLineAffected(plan.searches, previousMatchedLines.searchLines, searchMatchedPos, lineIndex, lineContent)){
+                        updateOutputLineSearches(job, previous, previousIndex, candidates, result);
+                        result.evaluatedLineCount++;
                     }else{
-                        middle_searched_last = combined_last;
-                    }
-                    assert(nullptr != middle_searched_first);
-                    assert(nullptr != middle_searched_last);
-                    middle_searched_size = total_size - left_combined_size - right_combined_size;
-                    size_t middle_searched_size2 = middle_searched_last - middle_searched_first + 1;
-                    assert(middle_searched_size == middle_searched_size2);
-                    if(0 < left_combined_size){
-                        OutputSubLine leftSubLine = combinedSubLine;
-                        leftSubLine.setContent(std::string_view(combined_first, left_combined_size));
-                        combinedSubLines2.push_back(leftSubLine);
-                    }
-                    if(0 < middle_searched_size){
-                        OutputSubLine middleSubLine = searchedSubLine;
-                        middleSubLine.setContent(std::string_view(middle_searched_first, middle_searched_size));
-                        combinedSubLines2.push_back(middleSubLine);
-                    }
-                    if(0 < right_combined_size){
-                        OutputSubLine rightSubLine = combinedSubLine;
-                        rightSubLine.setContent(std::string_view(combined_first + left_combined_size + middle_searched_size, right_combined_size));
-                        combinedSubLines2.push_back(rightSubLine);
+                        appendOutputLine(result, *job.styles, previous.linesAfterFilters[previousIndex],
+                                         previous.linesAfterSearches[previousIndex]);
                     }
                 }
-                combinedSubLines = combinedSubLines2;
+                if(bHasPrevious){
+                    previousIndex++;
+                }
+            }
+        }
+        // Lines that were incomplete or not there in the previous pass
+        for(int32_t lineIndex = reusableEndLine; lineIndex < chunk.endLine; lineIndex++){
+            createOutputLine(job, chunk, lineIndex, candidates, result);
+            result.evaluatedLineCount++;
+        }
+        moveReusedLinesToArena(appendedFileLineIndex, result);
+    }
+
+    void OutputData::moveReusedLinesToArena(const FileLineIndex* appendedFileLineIndex, OutputChunkResult& result){
+        // A chunk nothing changed in keeps the arena of the previous pass. Otherwise its reused lines
+        // are copied over, so the previous arena is not kept alive by a few of its lines. Lines of a
+        // file appended to are pointed at its new index, so the old one can go with its arena.
+        if(result.evaluatedLineCount == 0 && !appendedFileLineIndex){
+            result.arena.reset();
+            return;
+        }
+        for(auto* lines : {&result.linesAfterFilters, &result.linesAfterSearches}){
+            for(auto& line : *lines){
+                if(!isInArena(line, result.arena)){
+                    line = copyToArena(*line, result.arena);
+                }
+                if(appendedFileLineIndex){
+                    line->setContent(appendedFileLineIndex->getLine(line->getLineIndex()));
+                }
+            }
+        }
+    }
+
+    bool OutputData::isLineAffected(const PatternListChange& change, const std::vector<int32_t>& previousMatchedLines,
+                                    size_t& previousMatchedPos, int32_t lineIndex, std::string_view lineContent){
+        // Lines are visited in order, so the sorted matched lines are walked along
+        while(previousMatchedPos < previousMatchedLines.size() && previousMatchedLines[previousMatchedPos] < lineIndex){
+            previousMatchedPos++;
+        }
+        if(previousMatchedPos < previousMatchedLines.size() && previousMatchedLines[previousMatchedPos] == lineIndex){
+            return true;
+        }
+        if(change.bEmptyLinesAffected && lineContent.empty()){
+            return true;
+        }
+        for(auto& matcher : change.candidateMatchers){
+            if(matcher->mayMatch(lineContent)){
+                return true;
+            }
+        }
+        return false;
+    }
+
+    void OutputData::updateOutputLineSearches(const OutputJob& job, const PreviousOutput& previous, int32_t previousIndex,
+                                              const ChunkCandidates& candidates, OutputChunkResult& result) const{
+        const std::shared_ptr<OutputLine>& filteredLine = previous.linesAfterFilters[previousIndex];
+        std::shared_ptr<OutputLine> searchedLine = applyEnabledSearches(job, *filteredLine, candidates, result.arena);
+        appendOutputLine(result, *job.styles, filteredLine, std::move(searchedLine));
+    }
+
+    void OutputData::createOutputLine(const OutputJob& job, const OutputChunk& chunk, int32_t lineIndex, const ChunkCandidates& candidates,
+                                      OutputChunkResult& result) const{
+        if(!candidates.filterLines.contains(lineIndex)){
+            return;
+        }
+        // Apply filters first
+        std::shared_ptr<OutputLine> filteredLine = applyEnabledFilters(job, chunk, lineIndex, result.arena);
+        if(!filteredLine){
+            return;
+        }
+        // Then apply searches
+        std::shared_ptr<OutputLine> searchedLine = applyEnabledSearches(job, *filteredLine, candidates, result.arena);
+        appendOutputLine(result, *job.styles, std::move(filteredLine), std::move(searchedLine));
+    }
+
+    void OutputData::appendOutputLine(OutputChunkResult& result, const OutputStyleTable& styles, std::shared_ptr<OutputLine> filteredLine,
+                                      std::shared_ptr<OutputLine> searchedLine){
+        int32_t outputLineIndex = (int32_t)result.linesAfterFilters.size();
+        for(auto& span : filteredLine->getSpans()){
+            int32_t filterId = styles.getStyle(span.styleId).filterId;
+            if(filterId != -1){
+                result.filterMatchCount[filterId]++;
+                auto& lineIndexes = result.filterLineMap[filterId];
+                if(lineIndexes.empty() || lineIndexes.back() != outputLineIndex){
+                    lineIndexes.push_back(outputLineIndex);
+                }
             }
-            for(auto& subLine : combinedSubLines){
-                combinedLine->addSubLine(subLine);
+        }
+        for(auto& span : searchedLine->getSpans()){
+            int32_t searchId = styles.getStyle(span.styleId).searchId;
+            if(searchId != -1){
+                result.searchMatchCount[searchId]++;
+                auto& lineIndexes = result.searchLineMap[searchId];
+                if(lineIndexes.empty() || lineIndexes.back() != outputLineIndex){
+                    lineIndexes.push_back(outputLineIndex);
+                }
             }
-            m_outputLines.push_back(combinedLine);
         }
+        result.linesAfterFilters.push_back(std::move(filteredLine));
+        result.linesAfterSearches.push_back(std::move(searchedLine));
+    }
+
+    std::shared_ptr<OutputLine> OutputData::applyEnabledFilters(const OutputJob& job, const OutputChunk& chunk, int32_t lineIndex,
+                                                                const OutputArenaPtr& arena) const{
+        std::string_view lineContent = chunk.fileLineIndex->getLine(lineIndex);
+        // Spans are collected in a per-thread buffer, the line keeps an exactly sized copy in the arena
+        static thread_local std::vector<OutputSpan> spans;
+        spans.clear();
+        if(!job.filterSetMatcher->empty()){
+            job.filterSetMatcher->apply(lineContent, spans);
+            bool matched = false;
+            for(auto& span : spans){
+                if(span.styleId != OutputStyleTable::PLAIN_STYLE_ID){
+                    matched = true;
+                    break;
+                }
+            }
+            if(!matched){
+                return nullptr;
+            }
+        }else
+        {
+            spans.push_back({0, static_cast<uint32_t>(lineContent.size()), OutputStyleTable::PLAIN_STYLE_ID});
+        }
+        OutputLine outputLine;
+        outputLine.setFileId(chunk.fileId);
+        outputLine.setFileRow(chunk.fileRow);
+        outputLine.setLineIndex(lineIndex);
+        outputLine.setContent(lineContent);
+        outputLine.setSpans(spans);
+        return copyToArena(outputLine, arena);
+    }
+    
+    std::shared_ptr<OutputLine> OutputData::applyEnabledSearches(const OutputJob& job, const OutputLine& filteredLine,
+                                                                 const ChunkCandidates& candidates, const OutputArenaPtr& arena) const{
+        std::string_view lineContent = filteredLine.getContent();
+
+        OutputLine outputLine = filteredLine;
+
+        static thread_local std::vector<OutputSpan> spans;
+        static thread_local std::vector<OutputSpan> nextSpans;
+        spans.clear();
+        spans.push_back({0, static_cast<uint32_t>(lineContent.size()), OutputStyleTable::PLAIN_STYLE_ID});
+        for(size_t i = 0; i < job.searches.size(); i++){
+            if(!candidates.searchLines[i].contains(filteredLine.getLineIndex())){
+                continue;
+            }
+            nextSpans.clear();
+            for(auto& span : spans){
+                if(span.styleId != OutputStyleTable::PLAIN_STYLE_ID){
+                    nextSpans.push_back(span);
+                }else{
+                    job.searches[i].apply(lineContent.substr(span.offset, span.length), span.offset, job.searchStyleIds[i], nextSpans);
+                }
+            }
+            spans.swap(nextSpans);
+        }
+        outputLine.setSpans(spans);
+        return copyToArena(outputLine, arena);
+    }
+
+    std::shared_ptr<OutputLine> OutputData::combineFiltersAndSearches(const OutputLine& filteredLine, const OutputLine& searchedLine,
+                                                                      const OutputArenaPtr& arena) const{
+        OutputLine combinedLine = filteredLine;
+        static thread_local std::vector<OutputSpan> combinedSpans;
+        combineOutputSpans(filteredLine.getSpans(), searchedLine.getSpans(), combinedSpans);
+        combinedLine.setSpans(combinedSpans);
+        return copyToArena(combinedLine, arena);
     }
     
        
+    void OutputData::setOutputWindow(int32_t topLineIndex, int32_t visiableLineCount){
+        std::lock_guard<std::mutex> lock(m_outputMutex);
+        m_outputWindow.setVisiableLines(topLineIndex, visiableLineCount);
+    }
+
+    int32_t OutputData::getOutputLineCount() const{
+        std::lock_guard<std::mutex> lock(m_outputMutex);
+        return m_outputWindow.getTotalLines();
+    }
+
+    int32_t OutputData::getMaxFileLineCount() const{
+        int32_t maxLineCount = 0;
+        for(auto& it : m_allFileLineIndexes){
+            maxLineCount = std::max(maxLineCount, it.second->getLineCount());
+        }
+        return maxLineCount;
+    }
+
     std::vector<std::shared_ptr<OutputLine>> OutputData::getOutputStringList() const {
+        std::lock_guard<std::mutex> lock(m_outputMutex);
         std::vector<std::shared_ptr<OutputLine>> result;
         if(m_outputWindow.getTotalLines() == 0){
             return result;
@@ -514,17 +1214,56 @@ namespace Core {
         if(topIndex > bottomIndex){
             return result;
         }
-        if(topIndex >= m_outputLines.size() || bottomIndex >= m_outputLines.size()){
+        if(topIndex >= (int32_t)m_outputLinesAfterFilters.size() || bottomIndex >= (int32_t)m_outputLinesAfterFilters.size()){
             return result;
         }
-        for(int32_t i = topIndex; i <= bottomIndex; i++){
-            result.push_back(m_outputLines[i]);
+        return combineOutputLines(topIndex, bottomIndex + 1);
+    }
+
+    std::vector<std::shared_ptr<OutputLine>> OutputData::getOutputLines(int32_t beginLine, int32_t lineCount) const{
+        std::lock_guard<std::mutex> lock(m_outputMutex);
+        int32_t totalLineCount = (int32_t)m_outputLinesAfterFilters.size();
+        beginLine = std::max(0, std::min(beginLine, totalLineCount));
+        int32_t endLine = (int32_t)std::min<int64_t>((int64_t)beginLine + std::max(0, lineCount), totalLineCount);
+        return combineOutputLines(beginLine, endLine);
+    }
+
+    std::vector<std::shared_ptr<OutputLine>> OutputData::combineOutputLines(int32_t beginLine, int32_t endLine) const{
+        // Only the lines asked for get their spans combined. A line no search matched is handed out as it was filtered.
+        std::vector<std::shared_ptr<OutputLine>> result;
+        OutputArenaPtr arena;
+        result.reserve(endLine - beginLine);
+        for(int32_t outputLineIndex = beginLine; outputLineIndex < endLine; outputLineIndex++){
+            const std::shared_ptr<OutputLine>& filteredLine = m_outputLinesAfterFilters[outputLineIndex];
+            const OutputLine& searchedLine = *m_outputLinesAfterSearches[outputLineIndex];
+            bool bSearched = false;
+            for(auto& span : searchedLine.getSpans()){
+                if(span.styleId != OutputStyleTable::PLAIN_STYLE_ID){
+                    bSearched = true;
+                    break;
+                }
+            }
+            if(!bSearched){
+                result.push_back(filteredLine);
+                continue;
+            }
+            if(!arena){
+                arena = std::make_shared<OutputArena>(WINDOW_ARENA_BLOCK_SIZE);
+            }
+            arena->retain(filteredLine);
+            result.push_back(combineFiltersAndSearches(*filteredLine, searchedLine, arena));
         }
         return result;
     }
 
+    OutputStyleTablePtr OutputData::getOutputStyleTable() const{
+        std::lock_guard<std::mutex> lock(m_outputMutex);
+        return m_styleTable ? m_styleTable : std::make_shared<const OutputStyleTable>();
+    }
+
     bool OutputData::getNextMatchByFilter(int32_t filterId, int32_t lineIndex, int32_t charIndex,
                               int32_t& matchLineIndex, int32_t& matchCharStartIndex, int32_t& matchCharEndIndex){
+        std::lock_guard<std::mutex> lock(m_outputMutex);
         auto it = m_filterLineMap.find(filterId);
         if(it == m_filterLineMap.end()){
             return false;
@@ -538,18 +1277,18 @@ namespace Core {
             int32_t outputLineIndex = *it2;
             auto& outputLine = m_outputLinesAfterFilters[outputLineIndex];
             int32_t outputLineCharIndex = 0;
-            for(auto& subLine : outputLine->getSubLines()){
+            for(auto& span : outputLine->getSpans()){
                 if(outputLineCharIndex < charIndex){
-                    outputLineCharIndex += subLine.getContent().size();
+                    outputLineCharIndex += span.length;
                     continue;
                 }
-                if(subLine.getFilterId() == filterId){
+                if(m_styleTable->getStyle(span.styleId).filterId == filterId){
                     matchLineIndex = outputLineIndex;
                     matchCharStartIndex = outputLineCharIndex;
-                    matchCharEndIndex = outputLineCharIndex + subLine.getContent().size();
+                    matchCharEndIndex = outputLineCharIndex + span.length;
                     return true;
                 }
-                outputLineCharIndex += subLine.getContent().size();
+                outputLineCharIndex += span.length;
             }
         }
         it2 = lineSet.upper_bound(lineIndex);
@@ -560,14 +1299,14 @@ namespace Core {
             int32_t outputLineIndex = *it2;
             auto& outputLine = m_outputLinesAfterFilters[outputLineIndex];
             int32_t outputLineCharIndex = 0;
-            for(auto& subLine : outputLine->getSubLines()){
-                if(subLine.getFilterId() == filterId){
+            for(auto& span : outputLine->getSpans()){
+                if(m_styleTable->getStyle(span.styleId).filterId == filterId){
                     matchLineIndex = outputLineIndex;
                     matchCharStartIndex = outputLineCharIndex;
-                    matchCharEndIndex = outputLineCharIndex + subLine.getContent().size();
+                    matchCharEndIndex = outputLineCharIndex + span.length;
                     return true;
                 }
-                outputLineCharIndex += subLine.getContent().size();
+                outputLineCharIndex += span.length;
             }
         }
 
@@ -576,6 +1315,7 @@ namespace Core {
 
     bool OutputData::getPreviousMatchByFilter(int32_t filterId, int32_t lineIndex, int32_t charIndex,
                               int32_t& matchLineIndex, int32_t& matchCharStartIndex, int32_t& matchCharEndIndex){
+        std::lock_guard<std::mutex> lock(m_outputMutex);
         auto it = m_filterLineMap.find(filterId);
         if(it == m_filterLineMap.end()){
             return false;
@@ -589,19 +1329,19 @@ namespace Core {
             int32_t outputLineIndex = *it2;
             auto& outputLine = m_outputLinesAfterFilters[outputLineIndex];
             int32_t outputLineCharIndex = 0;
-            auto& subLines = outputLine->getSubLines();
-            for(auto& subLine : subLines){
-                outputLineCharIndex += subLine.getContent().size();
+            OutputSpanRange spans = outputLine->getSpans();
+            for(auto& span : spans){
+                outputLineCharIndex += span.length;
             }
-            for(auto it = subLines.rbegin(); it != subLines.rend(); it++){
-                outputLineCharIndex -= it->getContent().size();
+            for(auto it = spans.rbegin(); it != spans.rend(); it++){
+                outputLineCharIndex -= it->length;
                 if(outputLineCharIndex >= charIndex){
                     continue;
                 }
-                if(it->getFilterId() == filterId){
+                if(m_styleTable->getStyle(it->styleId).filterId == filterId){
                     matchLineIndex = outputLineIndex;
                     matchCharStartIndex = outputLineCharIndex;
-                    matchCharEndIndex = outputLineCharIndex + it->getContent().size();
+                    matchCharEndIndex = outputLineCharIndex + it->length;
                     return true;
                 }
             }
@@ -622,17 +1362,17 @@ namespace Core {
             int32_t outputLineIndex = *it2;
             auto& outputLine = m_outputLinesAfterFilters[outputLineIndex];
             //loop in reverse order
-            auto& subLines = outputLine->getSubLines();
+            OutputSpanRange spans = outputLine->getSpans();
             int32_t outputLineCharIndex = 0;
-            for(auto& subLine : subLines){
-                outputLineCharIndex += subLine.getContent().size();
+            for(auto& span : spans){
+                outputLineCharIndex += span.length;
             }
-            for(auto it = subLines.rbegin(); it != subLines.rend(); it++){
-                outputLineCharIndex -= it->getContent().size();
-                if(it->getFilterId() == filterId){
+            for(auto it = spans.rbegin(); it != spans.rend(); it++){
+                outputLineCharIndex -= it->length;
+                if(m_styleTable->getStyle(it->styleId).filterId == filterId){
                     matchLineIndex = outputLineIndex;
                     matchCharStartIndex = outputLineCharIndex;
-                    matchCharEndIndex = outputLineCharIndex + it->getContent().size();
+                    matchCharEndIndex = outputLineCharIndex + it->length;
                     return true;    
                 }
             }
@@ -642,6 +1382,7 @@ namespace Core {
 
     bool OutputData::getNextMatchBySearch(int32_t searchId, int32_t lineIndex, int32_t charIndex,
                                        int32_t& matchLineIndex, int32_t& matchCharStartIndex, int32_t& matchCharEndIndex) {
+        std::lock_guard<std::mutex> lock(m_outputMutex);
         auto it = m_searchLineMap.find(searchId);
         if(it == m_searchLineMap.end()){
             return false;
@@ -655,18 +1396,18 @@ namespace Core {
             int32_t outputLineIndex = *it2;
             auto& outputLine = m_outputLinesAfterSearches[outputLineIndex];
             int32_t outputLineCharIndex = 0;
-            for(auto& subLine : outputLine->getSubLines()){
+            for(auto& span : outputLine->getSpans()){
                 if(outputLineCharIndex < charIndex){
-                    outputLineCharIndex += subLine.getContent().size();
+                    outputLineCharIndex += span.length;
                     continue;
                 }
-                if(subLine.getSearchId() == searchId){
+                if(m_styleTable->getStyle(span.styleId).searchId == searchId){
                     matchLineIndex = outputLineIndex;
                     matchCharStartIndex = outputLineCharIndex;
-                    matchCharEndIndex = outputLineCharIndex + subLine.getContent().size();
+                    matchCharEndIndex = outputLineCharIndex + span.length;
                     return true;
                 }
-                outputLineCharIndex += subLine.getContent().size();
+                outputLineCharIndex += span.length;
             }
         }
         it2 = lineSet.upper_bound(lineIndex);
@@ -677,14 +1418,14 @@ namespace Core {
             int32_t outputLineIndex = *it2;
             auto& outputLine = m_outputLinesAfterSearches[outputLineIndex];
             int32_t outputLineCharIndex = 0;
-            for(auto& subLine : outputLine->getSubLines()){
-                if(subLine.getSearchId() == searchId){
+            for(auto& span : outputLine->getSpans()){
+                if(m_styleTable->getStyle(span.styleId).searchId == searchId){
                     matchLineIndex = outputLineIndex;
                     matchCharStartIndex = outputLineCharIndex;
-                    matchCharEndIndex = outputLineCharIndex + subLine.getContent().size();
+                    matchCharEndIndex = outputLineCharIndex + span.length;
                     return true;
                 }
-                outputLineCharIndex += subLine.getContent().size();
+                outputLineCharIndex += span.length;
             }
         }
 
@@ -693,6 +1434,7 @@ namespace Core {
     
     bool OutputData::getPreviousMatchBySearch(int32_t searchId, int32_t lineIndex, int32_t charIndex,
                                           int32_t& matchLineIndex, int32_t& matchCharStartIndex, int32_t& matchCharEndIndex) {
+        std::lock_guard<std::mutex> lock(m_outputMutex);
         auto it = m_searchLineMap.find(searchId);
         if(it == m_searchLineMap.end()){
             return false;
@@ -706,19 +1448,19 @@ namespace Core {
             int32_t outputLineIndex = *it2;
             auto& outputLine = m_outputLinesAfterSearches[outputLineIndex];
             int32_t outputLineCharIndex = 0;
-            auto& subLines = outputLine->getSubLines();
-            for(auto& subLine : subLines){
-                outputLineCharIndex += subLine.getContent().size();
+            OutputSpanRange spans = outputLine->getSpans();
+            for(auto& span : spans){
+                outputLineCharIndex += span.length;
             }
-            for(auto it = subLines.rbegin(); it != subLines.rend(); it++){
-                outputLineCharIndex -= it->getContent().size();
+            for(auto it = spans.rbegin(); it != spans.rend(); it++){
+                outputLineCharIndex -= it->length;
                 if(outputLineCharIndex >= charIndex){
                     continue;
                 }
-                if(it->getSearchId() == searchId){
+                if(m_styleTable->getStyle(it->styleId).searchId == searchId){
                     matchLineIndex = outputLineIndex;
                     matchCharStartIndex = outputLineCharIndex;
-                    matchCharEndIndex = outputLineCharIndex + it->getContent().size();
+                    matchCharEndIndex = outputLineCharIndex + it->length;
                     return true;
                 }
             }
@@ -739,17 +1481,17 @@ namespace Core {
             int32_t outputLineIndex = *it2;
             auto& outputLine = m_outputLinesAfterSearches[outputLineIndex];
             //loop in reverse order
-            auto& subLines = outputLine->getSubLines();
+            OutputSpanRange spans = outputLine->getSpans();
             int32_t outputLineCharIndex = 0;
-            for(auto& subLine : subLines){
-                outputLineCharIndex += subLine.getContent().size();
+            for(auto& span : spans){
+                outputLineCharIndex += span.length;
             }
-            for(auto it = subLines.rbegin(); it != subLines.rend(); it++){
-                outputLineCharIndex -= it->getContent().size();
-                if(it->getSearchId() == searchId){
+            for(auto it = spans.rbegin(); it != spans.rend(); it++){
+                outputLineCharIndex -= it->length;
+                if(m_styleTable->getStyle(it->styleId).searchId == searchId){
                     matchLineIndex = outputLineIndex;
                     matchCharStartIndex = outputLineCharIndex;
-                    matchCharEndIndex = outputLineCharIndex + it->getContent().size();
+                    matchCharEndIndex = outputLineCharIndex + it->length;
                     return true;    
                 }
             }
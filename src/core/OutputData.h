@@ -1,46 +1,72 @@
 #pragma once
 
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
 #include <list>
 #include <map>
 #include <set>
 #include <memory>
+#include <mutex>
+#include <string_view>
+#include <thread>
 #include <vector>
 #include <utility>
 
 #include "FileData.h"
+#include "FileLineIndex.h"
+#include "FileWatcher.h"
 #include "FilterData.h"
+#include "FilterSetMatcher.h"
+#include "LineIndexSet.h"
+#include "NgramIndexBuilder.h"
 #include "SearchData.h"
+#include "OutputArena.h"
 #include "OutputLine.h"
 #include "OutputWindow.h"
 
 namespace Core {
 
-    struct FileLineInfo{
-        int32_t fileId;
-        int32_t fileRow;
-        int32_t fileLineIndex;
-        std::string lineContent;
-        std::string color;
-
-        FileLineInfo(int32_t id, int32_t row, int32_t lineIndex, const std::string& content, const std::string& col)
-            : fileId(id)
-            , fileRow(row)
-            , fileLineIndex(lineIndex)
-            , lineContent(content)
-            , color(col)
-        {}
-    };
-
     /**
      * @brief Pure C++ class representing output data
      * 
      * This class manages the output display data, including file content, filters, and searches.
+     *
+     * Without an output update callback the output is recreated before each call returns. With one,
+     * recreation runs on a worker thread: a newer edit aborts the pass in flight, the getters return
+     * the lines merged so far, and the callback reports progress and completion.
+     *
+     * Without a file load callback the files are indexed before each call returns. With one, they
+     * are indexed on a loader thread and the callback reports every file as it is done; the owner then
+     * calls updateLoadedFiles() on its thread, which takes the files in once all of a load are indexed.
+     *
+     * In follow mode the loaded files are watched. updateFollowedFiles() indexes only what was
+     * appended to them, and the next pass runs only the new lines through the pipeline.
+     *
+     * Passes skip the blocks of lines that can not contain the literal every match of the filters
+     * or of a search needs, as told by the trigram Bloom filters of each file and, for large files,
+     * by an NgramIndex built in the background.
+     *
+     * A pass keeps the filter and the search spans of every shown line apart. Only the lines of the
+     * output window, or of the rows getOutputLines() is asked for, get them combined into their final spans.
      */
     class OutputData {
     public:
+        // Called on the worker thread, bFinished is false while only part of the files is processed
+        using OutputUpdateCallback = std::function<void(bool bFinished)>;
+        // Called on the watcher thread when a followed file changed, the owner then calls updateFollowedFiles() on its thread
+        using FileChangeCallback = std::function<void()>;
+        // Called on a pool thread as soon as a file is indexed, bLoaded is false if it could not be read.
+        // The owner then calls updateLoadedFiles() on its thread.
+        using FileLoadCallback = std::function<void(int32_t fileId, bool bLoaded)>;
+
         OutputData();
         virtual ~OutputData();
 
+        OutputData(const OutputData&) = delete;
+        OutputData& operator=(const OutputData&) = delete;
+
     public:
         bool isActive() const;
         void setActive(bool bActive);
@@ -50,6 +76,14 @@ namespace Core {
         void removeFile(int32_t id);
         void updateFileRow(int32_t id, int32_t row);
         void reloadFiles();
+        void setFileLoadCallback(FileLoadCallback callback);
+        // Takes in the files of the loads that are done and runs one pass over them, returns whether any load was done
+        bool updateLoadedFiles();
+        void setFollowFiles(bool bFollow);
+        bool isFollowingFiles() const;
+        void setFileChangeCallback(FileChangeCallback callback);
+        // Picks up appended, replaced and truncated files, returns whether any loaded file changed
+        bool updateFollowedFiles();
 
         // Filter management
         void addFilter(std::shared_ptr<FilterData> filter);
@@ -68,10 +102,29 @@ namespace Core {
         std::map<int32_t, int32_t> getSearchMatchCounts() const;
 
         // Display management
+        void setParallelEnabled(bool bEnabled);
+        bool isParallelEnabled() const;
+        void setNgramIndexEnabled(bool bEnabled);
+        bool isNgramIndexEnabled() const;
         void pauseRefresh();
         void resumeRefresh();
         void refresh();
+        void setOutputUpdateCallback(OutputUpdateCallback callback);
+        void cancelRefresh();
+        bool isRefreshing() const;
+        void waitForRefresh();
+
+        // Output window: the view asks for the lines [topLineIndex, topLineIndex + visiableLineCount)
+        // it shows, and only those are handed out. Until it does, the window holds all lines.
+        void setOutputWindow(int32_t topLineIndex, int32_t visiableLineCount);
+        int32_t getOutputLineCount() const;
+        int32_t getMaxFileLineCount() const;
+        // Lines of the window with their filter and search spans combined, they share one arena made for the call
         std::vector<std::shared_ptr<OutputLine>> getOutputStringList() const;
+        // Same for the lines [beginLine, beginLine + lineCount) clamped to the output, regardless of the window
+        std::vector<std::shared_ptr<OutputLine>> getOutputLines(int32_t beginLine, int32_t lineCount) const;
+        // Resolves the span styles of every line handed out before
+        OutputStyleTablePtr getOutputStyleTable() const;
         
         // Filter navigation
         bool getNextMatchByFilter(int32_t filterId, int32_t lineIndex, int32_t charIndex,
@@ -86,11 +139,142 @@ namespace Core {
                                   int32_t& matchLineIndex, int32_t& matchCharStartIndex, int32_t& matchCharEndIndex);
     
     protected:
-        void loadFile(std::shared_ptr<FileData> file);
+        // Files indexed together, taken in at once when all of them are done
+        struct FileLoad {
+            std::vector<std::shared_ptr<FileData>> files;
+            std::map<int32_t/*fileId*/, FileLineIndexPtr> previousFileLineIndexes;
+            bool bReload = false;                       // replaces all loaded files
+            bool bAllowMapping = true;
+            bool bStarted = false;                      // guarded by m_loadMutex
+            std::vector<FileLineIndexPtr> fileLineIndexes;  // per file, set as each is done, guarded by m_loadMutex
+            size_t loadedCount = 0;                     // guarded by m_loadMutex
+        };
+
+        // Indexes the files in parallel, a file with an index in previousFileLineIndexes is only read again as far
+        // as it changed since. On a reload all files are indexed, otherwise only the ones not loaded or loading yet.
+        // Runs one pass afterwards, or once updateLoadedFiles() takes them in with a file load callback.
+        void loadFiles(const std::vector<std::shared_ptr<FileData>>& files,
+                       const std::map<int32_t, FileLineIndexPtr>& previousFileLineIndexes, bool bReload);
+        void indexFiles(FileLoad& load);
+        // Returns whether the output has to be recreated
+        bool applyFileLoad(const FileLoad& load);
+        void loadWorkerLoop();
+        void updateFileWatcher();
+        void updateNgramIndexes();
+        // Returns fileLineIndex itself if the file did not change since, otherwise the index of the appended or reloaded file
+        FileLineIndexPtr updateFileLineIndex(FileData& file, const FileLineIndexPtr& fileLineIndex, bool bKeepMissingFile) const;
         void recreateOutputLines();
-        void applyEnabledFilters();
-        void applyEnabledSearches();
-        void combineFiltersAndSearches();
+
+        // Lines [beginLine, endLine) of one file
+        struct OutputChunk {
+            int32_t fileId = -1;
+            int32_t fileRow = -1;
+            FileLineIndexPtr fileLineIndex;
+            NgramIndexPtr ngramIndex;       // null until the file is indexed
+            int32_t beginLine = 0;
+            int32_t endLine = 0;
+        };
+
+        // Lines of one chunk the n-gram index leaves to the filters and to each search, in row order
+        struct ChunkCandidates {
+            NgramCandidateLines filterLines;
+            std::vector<NgramCandidateLines> searchLines;
+        };
+
+        // Pipeline output of one chunk, line indexes are relative to the chunk. All its lines live in
+        // one arena and share its ownership, so the arena goes away with the last of them.
+        struct OutputChunkResult {
+            OutputArenaPtr arena;
+            std::vector<std::shared_ptr<OutputLine>> linesAfterFilters;
+            std::vector<std::shared_ptr<OutputLine>> linesAfterSearches;
+            std::map<int32_t/*filterId*/, int32_t/*matchCount*/> filterMatchCount;
+            std::map<int32_t/*filterId*/, std::vector<int32_t/*outputLineIndex*/>> filterLineMap;
+            std::map<int32_t/*searchId*/, int32_t/*matchCount*/> searchMatchCount;
+            std::map<int32_t/*searchId*/, std::vector<int32_t/*outputLineIndex*/>> searchLineMap;
+            int32_t evaluatedLineCount = 0;     // lines run through the pipeline instead of reused
+        };
+
+        // Inputs of one recreateOutputLines() pass, copied so the worker never reads live state
+        struct OutputJob {
+            uint64_t generation = 0;
+            bool bParallel = true;
+            std::vector<OutputChunk> chunks;
+            FilterSetMatcherPtr filterSetMatcher;
+            OutputStyleTablePtr styles;         // has the styles of filterSetMatcher and searchStyleIds
+            std::vector<FilterData> filters;    // enabled filters in row order
+            std::vector<SearchData> searches;   // enabled searches in row order
+            std::vector<int32_t> searchStyleIds;
+        };
+
+        // Output of the last completed pass, taken over by the next pass
+        struct PreviousOutput {
+            std::shared_ptr<const OutputJob> job;
+            std::vector<int32_t> chunkOffsets;  // first output line of each chunk, then the line count
+            std::vector<std::shared_ptr<OutputLine>> linesAfterFilters;
+            std::vector<std::shared_ptr<OutputLine>> linesAfterSearches;
+            std::map<int32_t/*filterId*/, LineIndexSet> filterLineMap;
+            std::map<int32_t/*searchId*/, LineIndexSet> searchLineMap;
+            std::vector<FileLineIndexPtr> fileLineIndexes;
+        };
+
+        // Changes of the enabled filters or searches since the previous pass
+        struct PatternListChange {
+            std::vector<PatternMatcherPtr> candidateMatchers;   // added or rematched, lines they may match
+            std::set<int32_t/*id*/> previousIds;                // removed or changed, lines they matched
+            bool bEmptyLinesAffected = false;                   // the first one changed
+            bool isEmpty() const { return candidateMatchers.empty() && previousIds.empty() && !bEmptyLinesAffected; }
+        };
+
+        // Lines of an incremental pass that have to run through the pipeline again. Lines only
+        // the search changes affect keep their filtered line and only run through the searches.
+        // A chunk of a file that was appended to continues the chunk of the previous pass, lines
+        // that were incomplete or did not exist then always run through the pipeline.
+        struct OutputUpdatePlan {
+            PatternListChange filters;
+            PatternListChange searches;
+            std::vector<int32_t> previousChunkIndexes;  // per chunk of the job, -1 for a new chunk
+        };
+
+        // Line indexes of one chunk that changed filters or searches matched in the previous pass, sorted
+        struct PreviousMatchedLines {
+            std::vector<int32_t> filterLines;
+            std::vector<int32_t> searchLines;
+        };
+
+        static constexpr int32_t CHUNK_LINE_COUNT = 16384;
+        static constexpr int32_t PROGRESS_INTERVAL_MS = 200;
+        static constexpr size_t WINDOW_ARENA_BLOCK_SIZE = 16 * 1024;   // combined lines of one getOutputLines() call
+
+        std::shared_ptr<OutputJob> createOutputJob();
+        bool runOutputJob(const std::shared_ptr<const OutputJob>& job);
+        bool isOutputJobCancelled(const OutputJob& job) const;
+        void workerLoop();
+        bool createOutputUpdatePlan(const OutputJob& previous, const OutputJob& job, OutputUpdatePlan& plan) const;
+        std::vector<PreviousMatchedLines> collectPreviousMatchedLines(const PreviousOutput& previous, const OutputUpdatePlan& plan) const;
+        std::vector<OutputChunk> createOutputChunks() const;
+        static ChunkCandidates createChunkCandidates(const OutputJob& job, const OutputChunk& chunk);
+        void createOutputChunk(const OutputJob& job, const OutputChunk& chunk, OutputChunkResult& result) const;
+        void updateOutputChunk(const OutputJob& job, size_t chunkIndex, const PreviousOutput& previous,
+                               const PreviousMatchedLines& previousMatchedLines, const OutputUpdatePlan& plan,
+                               OutputChunkResult& result) const;
+        static bool isLineAffected(const PatternListChange& change, const std::vector<int32_t>& previousMatchedLines,
+                                   size_t& previousMatchedPos, int32_t lineIndex, std::string_view lineContent);
+        void updateOutputLineSearches(const OutputJob& job, const PreviousOutput& previous, int32_t previousIndex,
+                                      const ChunkCandidates& candidates, OutputChunkResult& result) const;
+        void createOutputLine(const OutputJob& job, const OutputChunk& chunk, int32_t lineIndex, const ChunkCandidates& candidates,
+                              OutputChunkResult& result) const;
+        static void appendOutputLine(OutputChunkResult& result, const OutputStyleTable& styles, std::shared_ptr<OutputLine> filteredLine,
+                                     std::shared_ptr<OutputLine> searchedLine);
+        static void moveReusedLinesToArena(const FileLineIndex* appendedFileLineIndex, OutputChunkResult& result);
+        std::shared_ptr<OutputLine> applyEnabledFilters(const OutputJob& job, const OutputChunk& chunk, int32_t lineIndex,
+                                                        const OutputArenaPtr& arena) const;
+        std::shared_ptr<OutputLine> applyEnabledSearches(const OutputJob& job, const OutputLine& filteredLine,
+                                                         const ChunkCandidates& candidates, const OutputArenaPtr& arena) const;
+        std::shared_ptr<OutputLine> combineFiltersAndSearches(const OutputLine& filteredLine, const OutputLine& searchedLine,
+                                                              const OutputArenaPtr& arena) const;
+        void mergeOutputChunkResult(OutputChunkResult& result);
+        // Lines [beginLine, endLine) with their spans combined, called with m_outputMutex held
+        std::vector<std::shared_ptr<OutputLine>> combineOutputLines(int32_t beginLine, int32_t endLine) const;
 
         void initOutputWindowInfo();
     
@@ -98,28 +282,63 @@ namespace Core {
         bool m_bActive = false;
         std::map<int32_t/*fileId*/, std::shared_ptr<FileData>> m_allFiles;  
         std::map<int32_t/*fileId*/, std::shared_ptr<FileData>> m_loadedFiles;
-        std::map<int32_t/*fileId*/, std::vector<std::shared_ptr<FileLineInfo>>> m_allFileLineInfos;
+        std::map<int32_t/*fileId*/, FileLineIndexPtr> m_allFileLineIndexes;
+        bool m_bFollowFiles = false;
+        FileChangeCallback m_fileChangeCallback;
+        FileLoadCallback m_fileLoadCallback;    // set: loadFiles() hands loads to m_loadThread
+        std::set<int32_t/*fileId*/> m_loadingFileIds;   // handed to m_loadThread and not taken in yet
+        std::unique_ptr<FileWatcher> m_fileWatcher;     // watches m_loadedFiles while following
+        bool m_bNgramIndexEnabled = true;
+        std::unique_ptr<NgramIndexBuilder> m_ngramIndexBuilder;     // indexes m_allFileLineIndexes while enabled
 
         // Filter management
         std::vector<std::shared_ptr<OutputLine>> m_outputLinesAfterFilters;
         std::map<int32_t/*filterId*/, std::shared_ptr<FilterData>> m_filters;
         std::map<int32_t/*filterRow*/, std::shared_ptr<FilterData>> m_enabledFilters;
         std::map<int32_t/*filterId*/, int32_t/*matchCount*/> m_filterMatchCount;
-        std::map<int32_t/*filterId*/, std::set<int32_t/*outputLineIndex*/>> m_filterLineMap;
+        std::map<int32_t/*filterId*/, LineIndexSet> m_filterLineMap;
+        FilterSetMatcherPtr m_filterSetMatcher;     // rebuilt from m_enabledFilters when m_bFilterSetChanged
+        bool m_bFilterSetChanged = true;
 
         // Search management
         std::vector<std::shared_ptr<OutputLine>> m_outputLinesAfterSearches;
         std::map<int32_t/*searchId*/, std::shared_ptr<SearchData>> m_searches;
         std::map<int32_t/*searchRow*/, std::shared_ptr<SearchData>> m_enabledSearches;
         std::map<int32_t/*searchId*/, int32_t/*matchCount*/> m_searchMatchCount;
-        std::map<int32_t/*searchId*/, std::set<int32_t/*outputLineIndex*/>> m_searchLineMap;
+        std::map<int32_t/*searchId*/, LineIndexSet> m_searchLineMap;
 
         // Output data
-        std::vector<std::shared_ptr<OutputLine>> m_outputLines;
+        OutputStyleTablePtr m_styleTable;       // styles of all passes so far, replaced by a larger copy when a pass adds styles
+        std::vector<FileLineIndexPtr> m_outputFileLineIndexes;  // keep the files the output lines point into mapped
 
         OutputWindow m_outputWindow;
 
+        // Last pass that ran to completion, the base of incremental updates
+        std::shared_ptr<const OutputJob> m_completedJob;
+        std::vector<int32_t> m_completedChunkOffsets;
+
+        // Guards the output lines, match counts, line maps, m_styleTable, m_outputWindow and the completed pass while a job merges into them
+        mutable std::mutex m_outputMutex;
+
+        bool m_bParallelEnabled = true;     // run the pipeline on ThreadPool
         bool m_bRefreshPaused = false;
         bool m_bHasPendingRecreateOutputLines = false;
+
+        // Background refresh
+        OutputUpdateCallback m_outputUpdateCallback;   // set: recreateOutputLines() hands jobs to m_workerThread
+        std::thread m_workerThread;
+        mutable std::mutex m_jobMutex;
+        std::condition_variable m_jobCondition;
+        std::shared_ptr<OutputJob> m_pendingJob;
+        bool m_bWorkerBusy = false;
+        bool m_bWorkerStopping = false;
+        std::atomic<uint64_t> m_jobGeneration{0};     // bumped by every new job and cancelRefresh()
+
+        // Background loading
+        std::thread m_loadThread;
+        std::mutex m_loadMutex;
+        std::condition_variable m_loadCondition;
+        std::deque<std::shared_ptr<FileLoad>> m_fileLoads;     // in order, until updateLoadedFiles() takes them in
+        std::atomic<bool> m_bLoadStopping{false};
     };
 }
@@ -1,48 +1,65 @@
 #include "OutputLine.h"
 
+#include <algorithm>
+
 namespace Core {
-    OutputSubLine::OutputSubLine(){}
-    void OutputSubLine::setFileId(int32_t fileId){
-        m_fileId = fileId;
-    }
-    int32_t OutputSubLine::getFileId() const{
-        return m_fileId;
-    }
-    void OutputSubLine::setContent(std::string_view content){
-        m_content = content;
-    }
-    std::string_view OutputSubLine::getContent() const{
-        return m_content;
-    }
-    void OutputSubLine::setColor(const std::string& color){
-        m_color = color;
+    OutputStyleTable::OutputStyleTable(){
+        addStyle(OutputStyle());
+    }
+    int32_t OutputStyleTable::addStyle(const OutputStyle& style){
+        StyleKey key(style.color, style.filterId, style.filterRow, style.searchId, style.searchRow);
+        auto it = m_styleIds.find(key);
+        if(it != m_styleIds.end()){
+            return it->second;
+        }
+        int32_t styleId = static_cast<int32_t>(m_styles.size());
+        m_styles.push_back(style);
+        m_styleIds.emplace(std::move(key), styleId);
+        return styleId;
     }
-    const std::string& OutputSubLine::getColor() const{
-        return m_color;
-    }
-    void OutputSubLine::setFilterId(int32_t filterId){
-        m_filterId = filterId;
-    }
-    int32_t OutputSubLine::getFilterId() const{
-        return m_filterId;
-    }
-    void OutputSubLine::setFilterRow(int32_t filterRow){
-        m_filterRow = filterRow;
-    }
-    int32_t OutputSubLine::getFilterRow() const{
-        return m_filterRow;
-    }
-    void OutputSubLine::setSearchId(int32_t searchId){
-        m_searchId = searchId;
-    }
-    int32_t OutputSubLine::getSearchId() const{
-        return m_searchId;
-    }
-    void OutputSubLine::setSearchRow(int32_t searchRow){
-        m_searchRow = searchRow;
-    }
-    int32_t OutputSubLine::getSearchRow() const{
-        return m_searchRow;
+
+    void combineOutputSpans(OutputSpanRange filteredSpans, OutputSpanRange searchedSpans,
+                            std::vector<OutputSpan>& combinedSpans){
+        if(searchedSpans.empty()){
+            combinedSpans.assign(filteredSpans.begin(), filteredSpans.end());
+            return;
+        }
+        if(filteredSpans.empty()){
+            combinedSpans.assign(searchedSpans.begin(), searchedSpans.end());
+            return;
+        }
+        combinedSpans.assign(filteredSpans.begin(), filteredSpans.end());
+        static thread_local std::vector<OutputSpan> nextSpans;
+        for(const OutputSpan& searchedSpan : searchedSpans){
+            if(searchedSpan.styleId == OutputStyleTable::PLAIN_STYLE_ID){
+                continue;
+            }
+            // Inclusive byte ranges, an empty span ends before it starts
+            int64_t searchFirst = searchedSpan.offset;
+            int64_t searchLast = searchFirst + searchedSpan.length - 1;
+            nextSpans.clear();
+            for(const OutputSpan& combinedSpan : combinedSpans){
+                int64_t combinedFirst = combinedSpan.offset;
+                int64_t combinedLast = combinedFirst + combinedSpan.length - 1;
+                if(searchFirst > combinedLast || searchLast < combinedFirst){
+                    nextSpans.push_back(combinedSpan);
+                    continue;
+                }
+                uint32_t leftSize = combinedFirst < searchFirst ? static_cast<uint32_t>(searchFirst - combinedFirst) : 0;
+                uint32_t rightSize = combinedLast > searchLast ? static_cast<uint32_t>(combinedLast - searchLast) : 0;
+                uint32_t middleSize = combinedSpan.length - leftSize - rightSize;
+                if(0 < leftSize){
+                    nextSpans.push_back({combinedSpan.offset, leftSize, combinedSpan.styleId});
+                }
+                if(0 < middleSize){
+                    nextSpans.push_back({combinedSpan.offset + leftSize, middleSize, searchedSpan.styleId});
+                }
+                if(0 < rightSize){
+                    nextSpans.push_back({combinedSpan.offset + leftSize + middleSize, rightSize, combinedSpan.styleId});
+                }
+            }
+            combinedSpans.swap(nextSpans);
+        }
     }
 
     OutputLine::OutputLine(){}
@@ -70,10 +87,10 @@ namespace Core {
     std::string_view OutputLine::getContent() const{
         return m_content;
     }
-    void OutputLine::addSubLine(const OutputSubLine& subLine){
-        m_subLines.push_back(subLine);
+    void OutputLine::setSpans(OutputSpanRange spans){
+        m_spans = spans;
     }
-    const std::list<OutputSubLine>& OutputLine::getSubLines() const{
-        return m_subLines;
+    OutputSpanRange OutputLine::getSpans() const{
+        return m_spans;
     }
-}
\ No newline at end of file
+}
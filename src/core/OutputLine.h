@@ -1,42 +1,82 @@
 #pragma once
 
+#include <cstdint>
+#include <iterator>
+#include <map>
+#include <memory>
 #include <string>
-#include <list>
 #include <string_view>
+#include <tuple>
+#include <vector>
 
 namespace Core {
 
-    class OutputSubLine{
-    public:
-        OutputSubLine();
-        void setFileId(int32_t fileId);
-        int32_t getFileId() const;
-        void setContent(std::string_view content);
-        std::string_view getContent() const;
+    // Color of a span and the filter or search that matched it
+    struct OutputStyle {
+        std::string color;
+        int32_t filterId = -1;
+        int32_t filterRow = -1;
+        int32_t searchId = -1;
+        int32_t searchRow = -1;
+    };
 
-        void setColor(const std::string& color);
-        const std::string& getColor() const;
+    /**
+     * @brief Styles referenced by OutputSpan::styleId
+     *
+     * Styles are only ever added, so an id stays valid in every later copy of the table.
+     * Style 0 is the unstyled text.
+     */
+    class OutputStyleTable {
+    public:
+        static constexpr int32_t PLAIN_STYLE_ID = 0;
 
-        void setFilterId(int32_t filterId);
-        int32_t getFilterId() const;
-        void setFilterRow(int32_t filterRow);
-        int32_t getFilterRow() const;
+        OutputStyleTable();
 
-        void setSearchId(int32_t searchId);
-        int32_t getSearchId() const;
-        void setSearchRow(int32_t searchRow);
-        int32_t getSearchRow() const;
+        // Returns the id of an equal style when there is one
+        int32_t addStyle(const OutputStyle& style);
+        const OutputStyle& getStyle(int32_t styleId) const { return m_styles[styleId]; }
+        size_t size() const { return m_styles.size(); }
     private:
-        int32_t m_fileId;
-        std::string_view m_content;
-        std::string m_color;
+        using StyleKey = std::tuple<std::string, int32_t, int32_t, int32_t, int32_t>;
 
-        int32_t m_filterId = -1;
-        int32_t m_filterRow = -1;
-        int32_t m_searchId = -1;
-        int32_t m_searchRow = -1;
+        std::vector<OutputStyle> m_styles;
+        std::map<StyleKey, int32_t> m_styleIds;
     };
 
+    using OutputStyleTablePtr = std::shared_ptr<const OutputStyleTable>;
+
+    // A part of an output line, offset and length are in bytes of the line content
+    struct OutputSpan {
+        uint32_t offset;
+        uint32_t length;
+        int32_t styleId;
+    };
+
+    // Spans of one line, stored by whoever built the line
+    class OutputSpanRange {
+    public:
+        using const_reverse_iterator = std::reverse_iterator<const OutputSpan*>;
+
+        OutputSpanRange() = default;
+        OutputSpanRange(const OutputSpan* spans, size_t count) : m_begin(spans), m_end(spans + count) {}
+        OutputSpanRange(const std::vector<OutputSpan>& spans) : m_begin(spans.data()), m_end(spans.data() + spans.size()) {}
+
+        const OutputSpan* begin() const { return m_begin; }
+        const OutputSpan* end() const { return m_end; }
+        const_reverse_iterator rbegin() const { return const_reverse_iterator(m_end); }
+        const_reverse_iterator rend() const { return const_reverse_iterator(m_begin); }
+        size_t size() const { return static_cast<size_t>(m_end - m_begin); }
+        bool empty() const { return m_begin == m_end; }
+        const OutputSpan& operator[](size_t index) const { return m_begin[index]; }
+    private:
+        const OutputSpan* m_begin = nullptr;
+        const OutputSpan* m_end = nullptr;
+    };
+
+    // Puts the styled spans of searchedSpans over filteredSpans, splitting the filter spans they overlap
+    void combineOutputSpans(OutputSpanRange filteredSpans, OutputSpanRange searchedSpans,
+                            std::vector<OutputSpan>& combinedSpans);
+
     class OutputLine {
     public:
         OutputLine();
@@ -48,13 +88,15 @@ namespace Core {
         int32_t getFileRow() const;
         int32_t getLineIndex() const;
         std::string_view getContent() const;
-        void addSubLine(const OutputSubLine& subLine);
-        const std::list<OutputSubLine>& getSubLines() const;
+        // The line only points at the spans, they have to live as long as the line does
+        void setSpans(OutputSpanRange spans);
+        OutputSpanRange getSpans() const;
+        std::string_view getSpanContent(const OutputSpan& span) const { return m_content.substr(span.offset, span.length); }
     private:
         int32_t m_fileId;
         int32_t m_fileRow;
         int32_t m_lineIndex;
         std::string_view m_content;
-        std::list<OutputSubLine> m_subLines;
+        OutputSpanRange m_spans;
     };
-}
\ No newline at end of file
+}
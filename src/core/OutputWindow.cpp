@@ -2,6 +2,8 @@
 
 #include "OutputData.h"
 
+#include <algorithm>
+
 namespace Core{
     OutputWindow::OutputWindow(OutputData& outputData)
         : m_outputData(outputData)
@@ -31,17 +33,17 @@ namespace Core{
         if(m_currentLineIndex < 0){
             m_currentLineIndex = 0;
         }
-        if(m_visiableTopLineIndex < 0){
-            m_visiableTopLineIndex = 0;
-        }
-        m_visiableBottomLineIndex = m_visiableTopLineIndex + m_visiableLineCount - 1;
-        if(m_visiableBottomLineIndex >= m_totalLines){
-            m_visiableBottomLineIndex = m_totalLines - 1;
-            m_visiableTopLineIndex = m_visiableBottomLineIndex - m_visiableLineCount + 1;
-            if(m_visiableTopLineIndex < 0){
-                m_visiableTopLineIndex = 0;
-            }
-        }  
+        // The requested top is kept while the line count changes, so the view stays where it was scrolled to.
+        // A top past the end shows the last full page, e.g. after filters shrank the output
+        int32_t lastPageTopLineIndex = (int32_t)std::max<int64_t>(0, (int64_t)m_totalLines - m_visiableLineCount);
+        m_visiableTopLineIndex = std::min(m_requestedTopLineIndex, lastPageTopLineIndex);
+        m_visiableBottomLineIndex = (int32_t)std::min<int64_t>((int64_t)m_visiableTopLineIndex + m_visiableLineCount, m_totalLines) - 1;
+    }
+
+    void OutputWindow::setVisiableLines(int32_t topLineIndex, int32_t visiableLineCount){
+        m_requestedTopLineIndex = std::max(0, topLineIndex);
+        m_visiableLineCount = std::max(1, visiableLineCount);
+        setLinesCount(m_totalLines);
     }
 
     void OutputWindow::clearAllLines(){
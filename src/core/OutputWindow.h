@@ -1,6 +1,7 @@
 #pragma once
 
 #include <cstdint>
+#include <limits>
 
 namespace Core{
     class OutputData;
@@ -12,6 +13,7 @@ namespace Core{
 
     public:
         void setLinesCount(int32_t lineCount);
+        void setVisiableLines(int32_t topLineIndex, int32_t visiableLineCount);
         void clearAllLines();
 
         int32_t getVisiableLineCount() const { return m_visiableLineCount; }
@@ -24,9 +26,10 @@ namespace Core{
         void reset();
     private:
         OutputData& m_outputData;
-        int32_t m_visiableLineCount = 100000;       //number of lines visible in the output window
+        int32_t m_visiableLineCount = std::numeric_limits<int32_t>::max();  //number of lines visible in the output window, all lines until the view sets it
         int32_t m_totalLines;                   //total lines in the output window
-        int32_t m_visiableTopLineIndex;         //top visible line index in the output window, between 0 and total lines - 1
+        int32_t m_requestedTopLineIndex = 0;    //top line index the view asked for, may be past the total lines
+        int32_t m_visiableTopLineIndex;         //top visible line index in the output window, between 0 and total lines - visible line count
         int32_t m_visiableBottomLineIndex;      //bottom visible line index in the output window, between 0 and total lines - 1
         int32_t m_currentLineIndex;             //current line index in the output window, between top and bottom visible line index
     };
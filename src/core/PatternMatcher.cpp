@@ -0,0 +1,118 @@
+#include "PatternMatcher.h"
+#include "LiteralMatcher.h"
+#include "StdRegexMatcher.h"
+#include "AutomatonRegexMatcher.h"
+#include <atomic>
+#include <cctype>
+#include <regex>
+
+namespace Core {
+
+    namespace {
+        std::atomic<RegexEngine> s_defaultRegexEngine{RegexEngine::Automaton};
+
+        // Literal bytes every match of an ECMAScript pattern starts with, after leading ^ and \b.
+        // Stops at the first byte that is not a plain literal, and gives up on any alternation.
+        std::string getRegexLiteralPrefix(const std::string& pattern){
+            bool bInClass = false;
+            for(size_t i = 0; i < pattern.size(); i++){
+                if(pattern[i] == '\\'){
+                    i++;
+                }else if(pattern[i] == '['){
+                    bInClass = true;
+                }else if(pattern[i] == ']'){
+                    bInClass = false;
+                }else if(pattern[i] == '|' && !bInClass){
+                    return std::string();
+                }
+            }
+            size_t pos = 0;
+            while(pos < pattern.size()){
+                if(pattern[pos] == '^'){
+                    pos++;
+                }else if(pattern.compare(pos, 2, "\\b") == 0){
+                    pos += 2;
+                }else{
+                    break;
+                }
+            }
+            static const std::string metaChars = "^$.|?*+()[]{}";
+            std::string literal;
+            while(pos < pattern.size()){
+                char c = pattern[pos];
+                size_t length = 1;
+                if(c == '\\'){
+                    // Escaped letters and digits are classes, assertions or control characters
+                    if(pos + 1 >= pattern.size() || std::isalnum(static_cast<unsigned char>(pattern[pos + 1]))){
+                        break;
+                    }
+                    c = pattern[pos + 1];
+                    length = 2;
+                }else if(metaChars.find(c) != std::string::npos){
+                    break;
+                }
+                pos += length;
+                // A quantifier that allows zero repetitions makes the byte optional
+                if(pos < pattern.size() && (pattern[pos] == '?' || pattern[pos] == '*' || pattern[pos] == '{')){
+                    break;
+                }
+                literal.push_back(c);
+                if(pos < pattern.size() && pattern[pos] == '+'){
+                    break;
+                }
+            }
+            return literal;
+        }
+    }
+
+    void PatternMatcher::setDefaultRegexEngine(RegexEngine engine){
+        s_defaultRegexEngine.store(engine);
+    }
+
+    RegexEngine PatternMatcher::getDefaultRegexEngine(){
+        return s_defaultRegexEngine.load();
+    }
+
+    PatternMatcherPtr PatternMatcher::create(const std::string& pattern, bool caseSensitive, bool wholeWord, bool regex,
+                                             std::string& error){
+        return create(pattern, caseSensitive, wholeWord, regex, getDefaultRegexEngine(), error);
+    }
+
+    PatternMatcherPtr PatternMatcher::create(const std::string& pattern, bool caseSensitive, bool wholeWord, bool regex,
+                                             RegexEngine engine, std::string& error){
+        error.clear();
+        if(!regex){
+            return std::make_shared<LiteralMatcher>(pattern, caseSensitive, wholeWord);
+        }
+
+        // Prepare regex pattern
+        std::string regexPattern = pattern;
+        if (wholeWord) {
+            // Add word boundary assertions
+            regexPattern = "\\b" + regexPattern + "\\b";
+        }
+
+        // std::regex stays the reference for which patterns are valid, even when it does not run them
+        std::shared_ptr<const std::regex> compiledRegex;
+        try {
+            std::regex::flag_type flags = std::regex::ECMAScript;
+            if (!caseSensitive) {
+                flags |= std::regex::icase;
+            }
+            compiledRegex = std::make_shared<const std::regex>(regexPattern, flags);
+        }
+        catch (const std::regex_error& e) {
+            error = e.what();
+            return nullptr;
+        }
+
+        if(engine == RegexEngine::Automaton){
+            auto automaton = AutomatonRegex::compile(regexPattern, caseSensitive);
+            if(automaton){
+                return std::make_shared<AutomatonRegexMatcher>(std::move(automaton), getRegexLiteralPrefix(regexPattern));
+            }
+        }
+        return std::make_shared<StdRegexMatcher>(std::move(compiledRegex), getRegexLiteralPrefix(regexPattern));
+    }
+
+} // namespace Core
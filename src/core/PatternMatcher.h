@@ -0,0 +1,68 @@
+#ifndef CORE_PATTERNMATCHER_H
+#define CORE_PATTERNMATCHER_H
+
+#include <string>
+#include <string_view>
+#include <vector>
+#include <memory>
+
+namespace Core {
+
+struct PatternMatch {
+    size_t position;
+    size_t length;
+
+    PatternMatch(size_t pos, size_t len) : position(pos), length(len) {}
+};
+
+/**
+ * @brief Regex engine used for regex patterns
+ *
+ * Automaton runs the linear-time AutomatonRegex engine and falls back to std::regex for syntax
+ * it does not support. StdRegex always uses the ECMAScript std::regex engine.
+ */
+enum class RegexEngine {
+    Automaton,
+    StdRegex
+};
+
+class PatternMatcher;
+using PatternMatcherPtr = std::shared_ptr<const PatternMatcher>;
+
+/**
+ * @brief Compiled form of a filter or search pattern
+ * 
+ * FilterData and SearchData compile their pattern once whenever the pattern, case,
+ * whole-word or regex flag changes, and reuse the result for every line instead of
+ * building a new std::regex per line. Matchers are immutable after creation, so they
+ * can be shared between copies of their owner and used from several threads.
+ */
+class PatternMatcher {
+public:
+    virtual ~PatternMatcher() = default;
+
+    // Append all matches in content, in order, to matches
+    virtual void findAll(std::string_view content, std::vector<PatternMatch>& matches) const = 0;
+
+    // Quick check, false means findAll() finds nothing in content or in any part of it
+    virtual bool mayMatch(std::string_view content) const = 0;
+
+    // Bytes every match contains, compared without ASCII case, empty if there are none
+    virtual const std::string& getRequiredLiteral() const = 0;
+
+    virtual const char* getEngineName() const = 0;
+
+    // Returns nullptr and sets error if the pattern is not a valid ECMAScript regex
+    static PatternMatcherPtr create(const std::string& pattern, bool caseSensitive, bool wholeWord, bool regex,
+                                    std::string& error);
+    static PatternMatcherPtr create(const std::string& pattern, bool caseSensitive, bool wholeWord, bool regex,
+                                    RegexEngine engine, std::string& error);
+
+    // Engine used by create() for regex patterns, applies to matchers created afterwards
+    static void setDefaultRegexEngine(RegexEngine engine);
+    static RegexEngine getDefaultRegexEngine();
+};
+
+} // namespace Core
+
+#endif // CORE_PATTERNMATCHER_H
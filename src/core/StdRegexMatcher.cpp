@@ -0,0 +1,17 @@
+#include "StdRegexMatcher.h"
+
+namespace Core {
+
+    StdRegexMatcher::StdRegexMatcher(std::shared_ptr<const std::regex> regex, std::string requiredLiteral)
+        : m_regex(std::move(regex)), m_requiredLiteral(std::move(requiredLiteral)) {}
+
+    void StdRegexMatcher::findAll(std::string_view content, std::vector<PatternMatch>& matches) const{
+        // Iterate the line in place, no copy into a std::string is needed
+        std::cregex_iterator begin(content.data(), content.data() + content.size(), *m_regex);
+        std::cregex_iterator end;
+        for (std::cregex_iterator it = begin; it != end; ++it) {
+            matches.emplace_back(static_cast<size_t>(it->position()), static_cast<size_t>(it->length()));
+        }
+    }
+
+} // namespace Core
@@ -0,0 +1,28 @@
+#ifndef CORE_STDREGEXMATCHER_H
+#define CORE_STDREGEXMATCHER_H
+
+#include "PatternMatcher.h"
+#include <regex>
+
+namespace Core {
+
+/**
+ * @brief Regex matcher running the ECMAScript std::regex engine
+ */
+class StdRegexMatcher : public PatternMatcher {
+public:
+    StdRegexMatcher(std::shared_ptr<const std::regex> regex, std::string requiredLiteral);
+
+    void findAll(std::string_view content, std::vector<PatternMatch>& matches) const override;
+    bool mayMatch(std::string_view) const override { return true; }
+    const std::string& getRequiredLiteral() const override { return m_requiredLiteral; }
+    const char* getEngineName() const override { return "std::regex"; }
+
+private:
+    std::shared_ptr<const std::regex> m_regex;
+    std::string m_requiredLiteral;
+};
+
+} // namespace Core
+
+#endif // CORE_STDREGEXMATCHER_H
@@ -0,0 +1,216 @@
+#include "SubstringSearcher.h"
+#include <algorithm>
+#include <cctype>
+#include <cstdint>
+#include <cstring>
+
+#if defined(__x86_64__) || defined(_M_X64)
+#define CORE_SUBSTRING_X86 1
+#include <immintrin.h>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+#endif
+
+#if defined(_MSC_VER)
+#define CORE_TARGET_AVX2
+#else
+#define CORE_TARGET_AVX2 __attribute__((target("avx2")))
+#endif
+
+namespace Core {
+
+    namespace {
+        // Index of the lowest set bit, mask must not be zero
+        inline unsigned lowestBit(uint32_t mask){
+#if defined(_MSC_VER)
+            unsigned long index;
+            _BitScanForward(&index, mask);
+            return static_cast<unsigned>(index);
+#else
+            return static_cast<unsigned>(__builtin_ctz(mask));
+#endif
+        }
+
+        inline unsigned char toLowerAscii(unsigned char c){
+            return (c >= 'A' && c <= 'Z') ? static_cast<unsigned char>(c | 0x20) : c;
+        }
+
+        // 0x20 when the byte is a letter, so (c | fold) == lower matches both cases of that letter only
+        inline unsigned char foldMask(unsigned char lower){
+            return (lower >= 'a' && lower <= 'z') ? 0x20 : 0x00;
+        }
+
+        inline bool equalsAt(const char* text, const std::string& pattern, bool caseSensitive){
+            if(caseSensitive){
+                return std::memcmp(text, pattern.data(), pattern.size()) == 0;
+            }
+            for(size_t i = 0; i < pattern.size(); i++){
+                if(toLowerAscii(static_cast<unsigned char>(text[i])) != static_cast<unsigned char>(pattern[i])){
+                    return false;
+                }
+            }
+            return true;
+        }
+
+        size_t findScalar(std::string_view content, const std::string& pattern, size_t from, bool caseSensitive){
+            if(caseSensitive){
+                return content.find(pattern, from);
+            }
+            const size_t length = pattern.size();
+            const unsigned char first = static_cast<unsigned char>(pattern[0]);
+            const unsigned char fold = foldMask(first);
+            for(size_t pos = from; pos + length <= content.size(); pos++){
+                if((static_cast<unsigned char>(content[pos]) | fold) == first
+                   && equalsAt(content.data() + pos, pattern, false)){
+                    return pos;
+                }
+            }
+            return std::string_view::npos;
+        }
+
+#ifdef CORE_SUBSTRING_X86
+        size_t findSse2(std::string_view content, const std::string& pattern, size_t from, bool caseSensitive){
+            const size_t length = pattern.size();
+            const unsigned char first = static_cast<unsigned char>(pattern[0]);
+            const unsigned char last = static_cast<unsigned char>(pattern[length - 1]);
+            const unsigned char firstFold = caseSensitive ? 0 : foldMask(first);
+            const unsigned char lastFold = caseSensitive ? 0 : foldMask(last);
+            const __m128i firstVector = _mm_set1_epi8(static_cast<char>(first));
+            const __m128i lastVector = _mm_set1_epi8(static_cast<char>(last));
+            const __m128i firstFoldVector = _mm_set1_epi8(static_cast<char>(firstFold));
+            const __m128i lastFoldVector = _mm_set1_epi8(static_cast<char>(lastFold));
+            const char* data = content.data();
+
+            size_t pos = from;
+            for(; pos + length + 15 <= content.size(); pos += 16){
+                __m128i blockFirst = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + pos));
+                __m128i blockLast = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + pos + length - 1));
+                __m128i eqFirst = _mm_cmpeq_epi8(_mm_or_si128(blockFirst, firstFoldVector), firstVector);
+                __m128i eqLast = _mm_cmpeq_epi8(_mm_or_si128(blockLast, lastFoldVector), lastVector);
+                uint32_t mask = static_cast<uint32_t>(_mm_movemask_epi8(_mm_and_si128(eqFirst, eqLast)));
+                while(mask != 0){
+                    size_t candidate = pos + lowestBit(mask);
+                    if(equalsAt(data + candidate, pattern, caseSensitive)){
+                        return candidate;
+                    }
+                    mask &= mask - 1;
+                }
+            }
+            return findScalar(content, pattern, pos, caseSensitive);
+        }
+
+        CORE_TARGET_AVX2
+        size_t findAvx2(std::string_view content, const std::string& pattern, size_t from, bool caseSensitive){
+            const size_t length = pattern.size();
+            const unsigned char first = static_cast<unsigned char>(pattern[0]);
+            const unsigned char last = static_cast<unsigned char>(pattern[length - 1]);
+            const unsigned char firstFold = caseSensitive ? 0 : foldMask(first);
+            const unsigned char lastFold = caseSensitive ? 0 : foldMask(last);
+            const __m256i firstVector = _mm256_set1_epi8(static_cast<char>(first));
+            const __m256i lastVector = _mm256_set1_epi8(static_cast<char>(last));
+            const __m256i firstFoldVector = _mm256_set1_epi8(static_cast<char>(firstFold));
+            const __m256i lastFoldVector = _mm256_set1_epi8(static_cast<char>(lastFold));
+            const char* data = content.data();
+
+            size_t pos = from;
+            for(; pos + length + 31 <= content.size(); pos += 32){
+                __m256i blockFirst = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + pos));
+                __m256i blockLast = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + pos + length - 1));
+                __m256i eqFirst = _mm256_cmpeq_epi8(_mm256_or_si256(blockFirst, firstFoldVector), firstVector);
+                __m256i eqLast = _mm256_cmpeq_epi8(_mm256_or_si256(blockLast, lastFoldVector), lastVector);
+                uint32_t mask = static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_and_si256(eqFirst, eqLast)));
+                while(mask != 0){
+                    size_t candidate = pos + lowestBit(mask);
+                    if(equalsAt(data + candidate, pattern, caseSensitive)){
+                        return candidate;
+                    }
+                    mask &= mask - 1;
+                }
+            }
+            return findSse2(content, pattern, pos, caseSensitive);
+        }
+
+        bool cpuSupportsAvx2(){
+#if defined(_MSC_VER)
+            int info[4];
+            __cpuid(info, 0);
+            if(info[0] < 7){
+                return false;
+            }
+            __cpuid(info, 1);
+            bool osUsesXsave = (info[2] & (1 << 27)) != 0;
+            bool hasAvx = (info[2] & (1 << 28)) != 0;
+            if(!osUsesXsave || !hasAvx || (_xgetbv(0) & 0x6) != 0x6){
+                return false;
+            }
+            __cpuidex(info, 7, 0);
+            return (info[1] & (1 << 5)) != 0;
+#else
+            __builtin_cpu_init();
+            return __builtin_cpu_supports("avx2");
+#endif
+        }
+#endif
+    }
+
+    SubstringSearcher::SubstringSearcher(const std::string& pattern, bool caseSensitive)
+        : SubstringSearcher(pattern, caseSensitive, getBestKernel()) {}
+
+    SubstringSearcher::SubstringSearcher(const std::string& pattern, bool caseSensitive, Kernel kernel)
+        : m_pattern(pattern), m_caseSensitive(caseSensitive), m_kernel(kernel) {
+        if (!m_caseSensitive) {
+            std::transform(m_pattern.begin(), m_pattern.end(), m_pattern.begin(),
+                           [](char c) { return static_cast<char>(toLowerAscii(static_cast<unsigned char>(c))); });
+        }
+#ifndef CORE_SUBSTRING_X86
+        m_kernel = Kernel::Scalar;
+#endif
+    }
+
+    size_t SubstringSearcher::find(std::string_view content, size_t from) const{
+        if(m_pattern.empty() || from > content.size() || content.size() - from < m_pattern.size()){
+            return std::string_view::npos;
+        }
+#ifdef CORE_SUBSTRING_X86
+        switch(m_kernel){
+            case Kernel::AVX2:
+                return findAvx2(content, m_pattern, from, m_caseSensitive);
+            case Kernel::SSE2:
+                return findSse2(content, m_pattern, from, m_caseSensitive);
+            case Kernel::Scalar:
+                break;
+        }
+#endif
+        return findScalar(content, m_pattern, from, m_caseSensitive);
+    }
+
+    bool SubstringSearcher::isWholeWordAt(std::string_view content, size_t pos, size_t length){
+        bool hasLeftBoundary = (pos == 0 || !std::isalnum(static_cast<unsigned char>(content[pos - 1])));
+        bool hasRightBoundary = (pos + length == content.length() ||
+                               !std::isalnum(static_cast<unsigned char>(content[pos + length])));
+        return hasLeftBoundary && hasRightBoundary;
+    }
+
+    SubstringSearcher::Kernel SubstringSearcher::getBestKernel(){
+#ifdef CORE_SUBSTRING_X86
+        static const Kernel kernel = cpuSupportsAvx2() ? Kernel::AVX2 : Kernel::SSE2;
+        return kernel;
+#else
+        return Kernel::Scalar;
+#endif
+    }
+
+    const char* SubstringSearcher::getKernelName(Kernel kernel){
+        switch(kernel){
+            case Kernel::AVX2:
+                return "avx2";
+            case Kernel::SSE2:
+                return "sse2";
+            case Kernel::Scalar:
+                break;
+        }
+        return "scalar";
+    }
+
+} // namespace Core
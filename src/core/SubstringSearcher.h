@@ -0,0 +1,47 @@
+#ifndef CORE_SUBSTRINGSEARCHER_H
+#define CORE_SUBSTRINGSEARCHER_H
+
+#include <string>
+#include <string_view>
+
+namespace Core {
+
+/**
+ * @brief Vectorized search for one plain-text pattern
+ *
+ * Candidate positions are found by comparing the first and the last pattern byte against
+ * 16 (SSE2) or 32 (AVX2) haystack positions at once, then verified byte by byte. Case-insensitive
+ * search folds ASCII letters on the fly, so the line is neither copied nor lower-cased.
+ * The kernel is chosen once at runtime from the CPU features, other platforms use a scalar loop.
+ */
+class SubstringSearcher {
+public:
+    enum class Kernel {
+        Scalar,
+        SSE2,
+        AVX2
+    };
+
+    SubstringSearcher(const std::string& pattern, bool caseSensitive);
+    SubstringSearcher(const std::string& pattern, bool caseSensitive, Kernel kernel);
+
+    // Position of the first occurrence at or after from, npos if there is none
+    size_t find(std::string_view content, size_t from) const;
+
+    size_t getLength() const { return m_pattern.size(); }
+
+    // True if the match at pos is not preceded or followed by a letter or digit
+    static bool isWholeWordAt(std::string_view content, size_t pos, size_t length);
+
+    static Kernel getBestKernel();
+    static const char* getKernelName(Kernel kernel);
+
+private:
+    std::string m_pattern;      // lower-cased when matching case-insensitively
+    bool m_caseSensitive;
+    Kernel m_kernel;
+};
+
+} // namespace Core
+
+#endif // CORE_SUBSTRINGSEARCHER_H
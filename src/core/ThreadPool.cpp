@@ -0,0 +1,97 @@
+#include "ThreadPool.h"
+#include <algorithm>
+#include <atomic>
+#include <memory>
+
+namespace Core {
+
+ThreadPool& ThreadPool::getInstance() {
+    static ThreadPool instance(std::max(1u, std::thread::hardware_concurrency()) - 1);
+    return instance;
+}
+
+ThreadPool::ThreadPool(size_t workerCount) {
+    m_workers.reserve(workerCount);
+    for (size_t i = 0; i < workerCount; i++) {
+        m_workers.emplace_back(&ThreadPool::workerLoop, this);
+    }
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_bStopping = true;
+    }
+    m_condition.notify_all();
+    for (auto& worker : m_workers) {
+        worker.join();
+    }
+}
+
+void ThreadPool::workerLoop() {
+    while (true) {
+        std::function<void()> job;
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_condition.wait(lock, [this] { return m_bStopping || !m_jobs.empty(); });
+            if (m_jobs.empty()) {
+                return;
+            }
+            job = std::move(m_jobs.front());
+            m_jobs.pop_front();
+        }
+        job();
+    }
+}
+
+void ThreadPool::parallelFor(size_t count, const std::function<void(size_t)>& task) {
+    if (count == 0) {
+        return;
+    }
+    if (count == 1 || m_workers.empty()) {
+        for (size_t i = 0; i < count; i++) {
+            task(i);
+        }
+        return;
+    }
+
+    struct Batch {
+        std::atomic<size_t> nextIndex{0};
+        size_t doneCount = 0;
+        std::mutex mutex;
+        std::condition_variable condition;
+    };
+    auto batch = std::make_shared<Batch>();
+
+    // Every participant takes indexes until none are left
+    auto runTasks = [batch, count, &task]() {
+        size_t done = 0;
+        size_t index;
+        while ((index = batch->nextIndex.fetch_add(1)) < count) {
+            task(index);
+            done++;
+        }
+        if (done > 0) {
+            std::lock_guard<std::mutex> lock(batch->mutex);
+            batch->doneCount += done;
+            if (batch->doneCount == count) {
+                batch->condition.notify_all();
+            }
+        }
+    };
+
+    size_t helperCount = std::min(m_workers.size(), count - 1);
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        for (size_t i = 0; i < helperCount; i++) {
+            m_jobs.emplace_back(runTasks);
+        }
+    }
+    m_condition.notify_all();
+
+    runTasks();
+    std::unique_lock<std::mutex> lock(batch->mutex);
+    batch->condition.wait(lock, [&batch, count] { return batch->doneCount == count; });
+}
+
+} // namespace Core
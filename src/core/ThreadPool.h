@@ -0,0 +1,48 @@
+#ifndef CORE_THREADPOOL_H
+#define CORE_THREADPOOL_H
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace Core {
+
+/**
+ * @brief Fixed set of worker threads shared by the data processing code
+ *
+ * The shared instance starts one worker less than the number of hardware threads,
+ * because the thread calling parallelFor() takes part in the work.
+ */
+class ThreadPool {
+public:
+    static ThreadPool& getInstance();
+
+    explicit ThreadPool(size_t workerCount);
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    // Number of threads working on a parallelFor(), including the caller
+    size_t getConcurrency() const { return m_workers.size() + 1; }
+
+    // Call task(i) for every i in [0, count) and return when all calls are done.
+    // Indexes are handed out in increasing order, tasks must not throw.
+    void parallelFor(size_t count, const std::function<void(size_t)>& task);
+
+private:
+    void workerLoop();
+
+    std::vector<std::thread> m_workers;
+    std::mutex m_mutex;
+    std::condition_variable m_condition;
+    std::deque<std::function<void()>> m_jobs;
+    bool m_bStopping = false;
+};
+
+} // namespace Core
+
+#endif // CORE_THREADPOOL_H
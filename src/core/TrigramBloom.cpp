@@ -0,0 +1,41 @@
+#include "TrigramBloom.h"
+#include <algorithm>
+
+namespace Core {
+
+    namespace {
+        constexpr uint32_t BLOCK_BITS = TrigramBloom::BLOCK_WORDS * 64;
+
+        // Two bit positions in a block from one multiplicative hash
+        inline void getBitPositions(uint32_t trigram, uint32_t& first, uint32_t& second){
+            uint64_t hash = trigram * 0x9E3779B97F4A7C15ull;
+            first = static_cast<uint32_t>(hash >> 32) % BLOCK_BITS;
+            second = static_cast<uint32_t>(hash >> 8) % BLOCK_BITS;
+        }
+    }
+
+    void TrigramBloom::clearBlock(size_t block){
+        std::fill(m_words.begin() + block * BLOCK_WORDS, m_words.begin() + (block + 1) * BLOCK_WORDS, 0);
+    }
+
+    void TrigramBloom::add(size_t block, uint32_t trigram){
+        uint64_t* words = m_words.data() + block * BLOCK_WORDS;
+        uint32_t first, second;
+        getBitPositions(trigram, first, second);
+        words[first >> 6] |= uint64_t(1) << (first & 63);
+        words[second >> 6] |= uint64_t(1) << (second & 63);
+    }
+
+    bool TrigramBloom::mayContainAll(size_t block, const std::vector<uint32_t>& trigrams) const{
+        const uint64_t* words = m_words.data() + block * BLOCK_WORDS;
+        for(uint32_t trigram : trigrams){
+            uint32_t first, second;
+            getBitPositions(trigram, first, second);
+            if(!(words[first >> 6] & (uint64_t(1) << (first & 63))) || !(words[second >> 6] & (uint64_t(1) << (second & 63)))){
+                return false;
+            }
+        }
+        return true;
+    }
+
+} // namespace Core
@@ -0,0 +1,61 @@
+#ifndef CORE_TRIGRAMBLOOM_H
+#define CORE_TRIGRAMBLOOM_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+#include <vector>
+
+namespace Core {
+
+constexpr uint32_t TRIGRAM_MASK = 0xffffff;
+
+inline uint32_t foldTrigramByte(char c){
+    unsigned char byte = static_cast<unsigned char>(c);
+    return (byte >= 'A' && byte <= 'Z') ? byte + ('a' - 'A') : byte;
+}
+
+// Calls f(trigram) for the three ASCII case-folded bytes at every position of text, duplicates included
+template <typename F>
+inline void forEachTrigram(std::string_view text, F&& f){
+    if(text.size() < 3){
+        return;
+    }
+    uint32_t trigram = (foldTrigramByte(text[0]) << 8) | foldTrigramByte(text[1]);
+    for(size_t i = 2; i < text.size(); i++){
+        trigram = ((trigram << 8) | foldTrigramByte(text[i])) & TRIGRAM_MASK;
+        f(trigram);
+    }
+}
+
+/**
+ * @brief One Bloom filter of trigrams per 64 KB block of a file
+ *
+ * A block holds the trigrams of the lines starting in it. Each filter is 2 KB and sets two bits
+ * per trigram, so a block with a few thousand distinct trigrams answers a literal of a dozen bytes
+ * with almost no false positives, at about 3% of the file size. Filters of different blocks do not
+ * share memory, so blocks can be filled from several threads at once.
+ */
+class TrigramBloom {
+public:
+    static constexpr int BLOCK_SHIFT = 16;
+    static constexpr size_t BLOCK_WORDS = 256;
+
+    size_t getBlockCount() const { return m_words.size() / BLOCK_WORDS; }
+    // Keeps the filters of the first blocks, added ones are empty
+    void resize(size_t blockCount) { m_words.resize(blockCount * BLOCK_WORDS); }
+    void clearBlock(size_t block);
+    void add(size_t block, uint32_t trigram);
+    // False means no line of the block contains all of trigrams
+    bool mayContainAll(size_t block, const std::vector<uint32_t>& trigrams) const;
+
+    const std::vector<uint64_t>& getWords() const { return m_words; }
+    std::vector<uint64_t>& getWords() { return m_words; }
+
+private:
+    std::vector<uint64_t> m_words;
+};
+
+} // namespace Core
+
+#endif // CORE_TRIGRAMBLOOM_H
@@ -192,6 +192,30 @@ void WorkspaceData::reloadFiles() {
     m_outputData.reloadFiles();
 }
 
+void WorkspaceData::setFollowFiles(bool bFollow) {
+    m_outputData.setFollowFiles(bFollow);
+}
+
+bool WorkspaceData::isFollowingFiles() const {
+    return m_outputData.isFollowingFiles();
+}
+
+void WorkspaceData::setFileChangeCallback(OutputData::FileChangeCallback callback) {
+    m_outputData.setFileChangeCallback(std::move(callback));
+}
+
+void WorkspaceData::setFileLoadCallback(OutputData::FileLoadCallback callback) {
+    m_outputData.setFileLoadCallback(std::move(callback));
+}
+
+bool WorkspaceData::updateLoadedFiles() {
+    return m_outputData.updateLoadedFiles();
+}
+
+bool WorkspaceData::updateFollowedFiles() {
+    return m_outputData.updateFollowedFiles();
+}
+
 ////////////////////////////////////////////////////////////
 // Filter management
 ////////////////////////////////////////////////////////////
@@ -379,10 +403,42 @@ std::string WorkspaceData::getNextSearchColor() {
 ///     Output management
 ////////////////////////////////////////////////////////////////
 
+void WorkspaceData::setOutputUpdateCallback(OutputData::OutputUpdateCallback callback) {
+    m_outputData.setOutputUpdateCallback(std::move(callback));
+}
+
+void WorkspaceData::cancelOutputUpdate() {
+    m_outputData.cancelRefresh();
+}
+
+void WorkspaceData::waitForOutputUpdate() {
+    m_outputData.waitForRefresh();
+}
+
+void WorkspaceData::setOutputWindow(int32_t topLineIndex, int32_t visiableLineCount) {
+    m_outputData.setOutputWindow(topLineIndex, visiableLineCount);
+}
+
+int32_t WorkspaceData::getOutputLineCount() const {
+    return m_outputData.getOutputLineCount();
+}
+
+int32_t WorkspaceData::getMaxFileLineCount() const {
+    return m_outputData.getMaxFileLineCount();
+}
+
 std::vector<std::shared_ptr<OutputLine>> WorkspaceData::getOutputStringList() const {
     return m_outputData.getOutputStringList();
 }
 
+std::vector<std::shared_ptr<OutputLine>> WorkspaceData::getOutputLines(int32_t beginLine, int32_t lineCount) const {
+    return m_outputData.getOutputLines(beginLine, lineCount);
+}
+
+OutputStyleTablePtr WorkspaceData::getOutputStyleTable() const {
+    return m_outputData.getOutputStyleTable();
+}
+
 bool WorkspaceData::getNextMatchByFilter(int32_t filterId, int32_t lineIndex, int32_t charIndex,
                               int32_t& matchLineIndex, int32_t& matchCharStartIndex, int32_t& matchCharEndIndex) {
     return m_outputData.getNextMatchByFilter(filterId, lineIndex, charIndex, matchLineIndex, matchCharStartIndex, matchCharEndIndex);
@@ -59,6 +59,12 @@ public:
     void rollbackFilterUpdate();
     std::string getNextFilterColor();
     void reloadFiles();
+    void setFollowFiles(bool bFollow);
+    bool isFollowingFiles() const;
+    void setFileChangeCallback(OutputData::FileChangeCallback callback);
+    void setFileLoadCallback(OutputData::FileLoadCallback callback);
+    bool updateLoadedFiles();
+    bool updateFollowedFiles();
 
     // Search management
     int32_t addSearch(const SearchData& search);
@@ -73,7 +79,15 @@ public:
     std::string getNextSearchColor();  
 
     // Output management
+    void setOutputUpdateCallback(OutputData::OutputUpdateCallback callback);
+    void cancelOutputUpdate();
+    void waitForOutputUpdate();
+    void setOutputWindow(int32_t topLineIndex, int32_t visiableLineCount);
+    int32_t getOutputLineCount() const;
+    int32_t getMaxFileLineCount() const;
     std::vector<std::shared_ptr<OutputLine>> getOutputStringList() const;
+    std::vector<std::shared_ptr<OutputLine>> getOutputLines(int32_t beginLine, int32_t lineCount) const;
+    OutputStyleTablePtr getOutputStyleTable() const;
     bool getNextMatchByFilter(int32_t filterId, int32_t lineIndex, int32_t charIndex,
                               int32_t& matchLineIndex, int32_t& matchCharStartIndex, int32_t& matchCharEndIndex);
     bool getPreviousMatchByFilter(int32_t filterId, int32_t lineIndex, int32_t charIndex,
@@ -8,6 +8,7 @@
 #include <nlohmann/json.hpp>
 #include "AppUtils.h"
 #include "Logger.h"
+#include "ThreadPool.h"
 
 namespace Core {
 
@@ -116,6 +117,9 @@ bool WorkspaceManager::loadWorkspaces() {
                 auto workspace = std::make_shared<WorkspaceData>();
                 if(workspace->loadFromJson(workspaceObj)){
                     workspaces[workspace->getId()] = workspace;
+                    attachOutputUpdateCallback(workspace);
+                    attachFileChangeCallback(workspace);
+                    attachFileLoadCallback(workspace);
                 }else{
                     Logger::getInstance().error("WorkspaceManager::loadWorkspaces Error loading workspace");
                 }
@@ -163,6 +167,9 @@ int64_t WorkspaceManager::createWorkspace() {
     int64_t newId = nextWorkspaceId++;
     std::string name = "Workspace " + std::to_string(newId);    
     workspaces[newId] = std::make_shared<WorkspaceData>(newId,name);    
+    attachOutputUpdateCallback(workspaces[newId]);
+    attachFileChangeCallback(workspaces[newId]);
+    attachFileLoadCallback(workspaces[newId]);
     setActiveWorkspace(newId);
     Logger::getInstance().info("WorkspaceManager Created workspace: " + name + " (id: " + std::to_string(newId) + ")");
     saveWorkspaces();
@@ -417,6 +424,80 @@ void WorkspaceManager::reloadFilesInWorkspace(int64_t workspaceId) {
     }
     it->second->reloadFiles();
 }
+
+void WorkspaceManager::setFileChangeCallback(FileChangeCallback callback) {
+    fileChangeCallback = std::move(callback);
+    for (auto& it : workspaces) {
+        attachFileChangeCallback(it.second);
+    }
+}
+
+void WorkspaceManager::attachFileChangeCallback(const WorkspaceDataPtr& workspace) {
+    if (!fileChangeCallback) {
+        workspace->setFileChangeCallback(nullptr);
+        return;
+    }
+    FileChangeCallback callback = fileChangeCallback;
+    int64_t workspaceId = workspace->getId();
+    workspace->setFileChangeCallback([callback, workspaceId]() {
+        callback(workspaceId);
+    });
+}
+
+void WorkspaceManager::setFileLoadCallback(FileLoadCallback callback) {
+    fileLoadCallback = std::move(callback);
+    for (auto& it : workspaces) {
+        attachFileLoadCallback(it.second);
+    }
+}
+
+void WorkspaceManager::attachFileLoadCallback(const WorkspaceDataPtr& workspace) {
+    if (!fileLoadCallback) {
+        workspace->setFileLoadCallback(nullptr);
+        return;
+    }
+    FileLoadCallback callback = fileLoadCallback;
+    int64_t workspaceId = workspace->getId();
+    workspace->setFileLoadCallback([callback, workspaceId](int32_t fileId, bool bLoaded) {
+        callback(workspaceId, fileId, bLoaded);
+    });
+}
+
+bool WorkspaceManager::updateLoadedFilesInWorkspace(int64_t workspaceId) {
+    auto it = workspaces.find(workspaceId);
+    if (it == workspaces.end()) {
+        Logger::getInstance().info("WorkspaceManager Failed to update loaded files: Invalid workspace id " + std::to_string(workspaceId));
+        return false;
+    }
+    return it->second->updateLoadedFiles();
+}
+
+void WorkspaceManager::setFollowFilesInWorkspace(int64_t workspaceId, bool bFollow) {
+    auto it = workspaces.find(workspaceId);
+    if (it == workspaces.end()) {
+        Logger::getInstance().info("WorkspaceManager Failed to set follow files: Invalid workspace id " + std::to_string(workspaceId));
+        return;
+    }
+    it->second->setFollowFiles(bFollow);
+}
+
+bool WorkspaceManager::isFollowingFilesInWorkspace(int64_t workspaceId) {
+    auto it = workspaces.find(workspaceId);
+    if (it == workspaces.end()) {
+        Logger::getInstance().info("WorkspaceManager Failed to get follow files: Invalid workspace id " + std::to_string(workspaceId));
+        return false;
+    }
+    return it->second->isFollowingFiles();
+}
+
+bool WorkspaceManager::updateFollowedFilesInWorkspace(int64_t workspaceId) {
+    auto it = workspaces.find(workspaceId);
+    if (it == workspaces.end()) {
+        Logger::getInstance().info("WorkspaceManager Failed to update followed files: Invalid workspace id " + std::to_string(workspaceId));
+        return false;
+    }
+    return it->second->updateFollowedFiles();
+}
 ////////////////////////////////////////////////////////////
 // Filter management
 ////////////////////////////////////////////////////////////
@@ -630,6 +711,63 @@ std::string WorkspaceManager::getNextSearchColor(int64_t workspaceId) {
 // Output management
 ////////////////////////////////////////////////////////////
 
+void WorkspaceManager::setOutputUpdateCallback(OutputUpdateCallback callback) {
+    // Workers run their chunks on the shared pool, create it first so it is destroyed after them
+    ThreadPool::getInstance();
+    outputUpdateCallback = std::move(callback);
+    for (auto& it : workspaces) {
+        attachOutputUpdateCallback(it.second);
+    }
+}
+
+void WorkspaceManager::attachOutputUpdateCallback(const WorkspaceDataPtr& workspace) {
+    if (!outputUpdateCallback) {
+        workspace->setOutputUpdateCallback(nullptr);
+        return;
+    }
+    OutputUpdateCallback callback = outputUpdateCallback;
+    int64_t workspaceId = workspace->getId();
+    workspace->setOutputUpdateCallback([callback, workspaceId](bool bFinished) {
+        callback(workspaceId, bFinished);
+    });
+}
+
+void WorkspaceManager::cancelOutputUpdate(int64_t workspaceId) {
+    auto it = workspaces.find(workspaceId);
+    if (it == workspaces.end()) {
+        Logger::getInstance().info("WorkspaceManager Failed to cancel output update: Invalid workspace id " + std::to_string(workspaceId));
+        return;
+    }
+    it->second->cancelOutputUpdate();
+}
+
+void WorkspaceManager::setOutputWindow(int64_t workspaceId, int32_t topLineIndex, int32_t visiableLineCount) {
+    auto it = workspaces.find(workspaceId);
+    if (it == workspaces.end()) {
+        Logger::getInstance().info("WorkspaceManager Failed to set output window: Invalid workspace id " + std::to_string(workspaceId));
+        return;
+    }
+    it->second->setOutputWindow(topLineIndex, visiableLineCount);
+}
+
+int32_t WorkspaceManager::getOutputLineCount(int64_t workspaceId) {
+    auto it = workspaces.find(workspaceId);
+    if (it == workspaces.end()) {
+        Logger::getInstance().info("WorkspaceManager Failed to get output line count: Invalid workspace id " + std::to_string(workspaceId));
+        return 0;
+    }
+    return it->second->getOutputLineCount();
+}
+
+int32_t WorkspaceManager::getMaxFileLineCount(int64_t workspaceId) {
+    auto it = workspaces.find(workspaceId);
+    if (it == workspaces.end()) {
+        Logger::getInstance().info("WorkspaceManager Failed to get max file line count: Invalid workspace id " + std::to_string(workspaceId));
+        return 0;
+    }
+    return it->second->getMaxFileLineCount();
+}
+
 std::vector<std::shared_ptr<OutputLine>> WorkspaceManager::getOutputStringList(int64_t workspaceId) {
     auto it = workspaces.find(workspaceId);
     if (it == workspaces.end()) {
@@ -639,6 +777,24 @@ std::vector<std::shared_ptr<OutputLine>> WorkspaceManager::getOutputStringList(i
     return it->second->getOutputStringList();
 }
 
+std::vector<std::shared_ptr<OutputLine>> WorkspaceManager::getOutputLines(int64_t workspaceId, int32_t beginLine, int32_t lineCount) {
+    auto it = workspaces.find(workspaceId);
+    if (it == workspaces.end()) {
+        Logger::getInstance().info("WorkspaceManager Failed to get output lines: Invalid workspace id " + std::to_string(workspaceId));
+        return std::vector<std::shared_ptr<OutputLine>>();
+    }
+    return it->second->getOutputLines(beginLine, lineCount);
+}
+
+OutputStyleTablePtr WorkspaceManager::getOutputStyleTable(int64_t workspaceId) {
+    auto it = workspaces.find(workspaceId);
+    if (it == workspaces.end()) {
+        Logger::getInstance().info("WorkspaceManager Failed to get output style table: Invalid workspace id " + std::to_string(workspaceId));
+        return std::make_shared<const OutputStyleTable>();
+    }
+    return it->second->getOutputStyleTable();
+}
+
 bool WorkspaceManager::getNextMatchByFilter(int64_t workspaceId, int32_t filterId, int32_t lineIndex, int32_t charIndex,
                               int32_t& matchLineIndex, int32_t& matchCharStartIndex, int32_t& matchCharEndIndex) {
     auto it = workspaces.find(workspaceId);
@@ -18,6 +18,12 @@ namespace Core {
 class WorkspaceManager {
 public:
     using LogCallback = std::function<void(const std::string&)>;
+    // Called on a worker thread whenever new output of a workspace can be fetched
+    using OutputUpdateCallback = std::function<void(int64_t workspaceId, bool bFinished)>;
+    // Called on a watcher thread when a followed file of a workspace changed
+    using FileChangeCallback = std::function<void(int64_t workspaceId)>;
+    // Called on a pool thread when a file of a workspace was indexed while loading or reloading
+    using FileLoadCallback = std::function<void(int64_t workspaceId, int32_t fileId, bool bLoaded)>;
     
     WorkspaceManager();
     ~WorkspaceManager();
@@ -59,6 +65,12 @@ public:
     void commitFileUpdate(int64_t workspaceId);
     void rollbackFileUpdate(int64_t workspaceId);
     void reloadFilesInWorkspace(int64_t workspaceId);
+    void setFileChangeCallback(FileChangeCallback callback);
+    void setFileLoadCallback(FileLoadCallback callback);
+    bool updateLoadedFilesInWorkspace(int64_t workspaceId);
+    void setFollowFilesInWorkspace(int64_t workspaceId, bool bFollow);
+    bool isFollowingFilesInWorkspace(int64_t workspaceId);
+    bool updateFollowedFilesInWorkspace(int64_t workspaceId);
 
     // Filter management
     int32_t addFilterToWorkspace(int64_t workspaceId, const FilterData& filter);
@@ -85,7 +97,14 @@ public:
     std::string getNextSearchColor(int64_t workspaceId);
 
     /// Output management
+    void setOutputUpdateCallback(OutputUpdateCallback callback);
+    void cancelOutputUpdate(int64_t workspaceId);
+    void setOutputWindow(int64_t workspaceId, int32_t topLineIndex, int32_t visiableLineCount);
+    int32_t getOutputLineCount(int64_t workspaceId);
+    int32_t getMaxFileLineCount(int64_t workspaceId);
     std::vector<std::shared_ptr<OutputLine>> getOutputStringList(int64_t workspaceId);
+    std::vector<std::shared_ptr<OutputLine>> getOutputLines(int64_t workspaceId, int32_t beginLine, int32_t lineCount);
+    OutputStyleTablePtr getOutputStyleTable(int64_t workspaceId);
     bool getNextMatchByFilter(int64_t workspaceId, int32_t filterId, int32_t lineIndex, int32_t charIndex,
                               int32_t& matchLineIndex, int32_t& matchCharStartIndex, int32_t& matchCharEndIndex);
     bool getPreviousMatchByFilter(int64_t workspaceId, int32_t filterId, int32_t lineIndex, int32_t charIndex,
@@ -100,10 +119,16 @@ private:
     int64_t nextWorkspaceId = 1;
     int64_t activeWorkspaceId = -1;
     LogCallback logCallback;
+    OutputUpdateCallback outputUpdateCallback;
+    FileChangeCallback fileChangeCallback;
+    FileLoadCallback fileLoadCallback;
     bool m_saveWorkspacePaused = false;
     bool m_hasPendingSaveWorkspace = false;
     // Helper methods
     bool isValidJsonFile(const std::string& filePath);
+    void attachOutputUpdateCallback(const WorkspaceDataPtr& workspace);
+    void attachFileChangeCallback(const WorkspaceDataPtr& workspace);
+    void attachFileLoadCallback(const WorkspaceDataPtr& workspace);
 
 };
 
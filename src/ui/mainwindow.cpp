@@ -292,6 +292,8 @@ void MainWindow::closeWorkspaceAtIndex(int index) {
     QString name = workspace ? workspace->getDisplayName() : QString::number(index);
     
     int64_t workspaceId = workspace->getWorkspaceId();
+    // Stop recomputing output nobody will look at
+    workspace->stopLoading();
     // Remove workspace from bridge
     bridge.removeWorkspace(workspaceId);
     
@@ -6,6 +6,14 @@
 
 class FileInfo {
 public:
+    // Mirrors Core::FileLoadState
+    enum class LoadState {
+        Unloaded,
+        Loading,
+        Loaded,
+        Failed
+    };
+
     QString filePath;
     QString fileName;
     std::chrono::system_clock::time_point modifiedDate;
@@ -14,6 +22,7 @@ public:
     qint32 fileId;
     qint32 fileRow;
     bool isExists;
+    LoadState loadState = LoadState::Unloaded;
 
     FileInfo();
     FileInfo(const QString &path, const QString &name, 
@@ -41,6 +41,14 @@ FileListWidget::FileListWidget(int64_t workspaceId, QtBridge& bridge, QWidget *p
     reloadButton->setAutoRaise(true);
     headerLayout->addWidget(reloadButton);
     
+    // Create follow button, while checked the selected files are watched for appended lines
+    followButton = new QToolButton(this);
+    followButton->setIcon(QIcon::fromTheme("go-bottom"));
+    followButton->setToolTip(tr("Follow"));
+    followButton->setCheckable(true);
+    followButton->setAutoRaise(true);
+    headerLayout->addWidget(followButton);
+    
     // Add stretch for symmetry to keep elements centered
     headerLayout->addStretch(1);
     
@@ -53,6 +61,9 @@ FileListWidget::FileListWidget(int64_t workspaceId, QtBridge& bridge, QWidget *p
 
     // Connect reload button signal
     connect(reloadButton, &QToolButton::clicked, this, &FileListWidget::onReloadButtonClicked);
+    connect(followButton, &QToolButton::toggled, this, &FileListWidget::onFollowButtonToggled);
+    // Files are indexed off the UI thread, each one is marked as soon as it is done
+    connect(&bridge, &QtBridge::fileLoaded, this, &FileListWidget::onFileLoaded);
 
     fileListWidget->setSelectionMode(QAbstractItemView::SingleSelection);
     fileListWidget->setDragDropMode(QAbstractItemView::InternalMove);
@@ -372,16 +383,8 @@ FileItemWidget::FileItemWidget(FileInfo fileInfo, QWidget *parent)
     layout->addWidget(checkBox);
     
     // File name label with existence check
-    QString displayText = fileInfo.fileName;
-    if (!fileInfo.isExists) {
-        displayText += " (File does not exist)";
-    }
-    fileNameLabel = new QLabel(displayText, this);
-    QString labelStyle = "padding-left: 5px;";
-    if (!fileInfo.isExists) {
-        labelStyle += " color: red;";
-    }
-    fileNameLabel->setStyleSheet(labelStyle);
+    fileNameLabel = new QLabel(this);
+    updateFileNameLabel();
     fileNameLabel->setToolTip(fileInfo.filePath);
     layout->addWidget(fileNameLabel, 1); // Stretch factor 1
     
@@ -403,6 +406,28 @@ FileItemWidget::FileItemWidget(FileInfo fileInfo, QWidget *parent)
     setToolTip(fileInfo.filePath);
 }
 
+void FileItemWidget::setLoadState(FileInfo::LoadState state) {
+    m_fileInfo.loadState = state;
+    updateFileNameLabel();
+}
+
+void FileItemWidget::updateFileNameLabel() {
+    QString displayText = m_fileInfo.fileName;
+    QString labelStyle = "padding-left: 5px;";
+    if (!m_fileInfo.isExists) {
+        displayText += " (File does not exist)";
+        labelStyle += " color: red;";
+    } else if (m_fileInfo.loadState == FileInfo::LoadState::Loading) {
+        displayText += tr(" (Loading...)");
+        labelStyle += " color: gray;";
+    } else if (m_fileInfo.loadState == FileInfo::LoadState::Failed) {
+        displayText += tr(" (Failed to load)");
+        labelStyle += " color: red;";
+    }
+    fileNameLabel->setText(displayText);
+    fileNameLabel->setStyleSheet(labelStyle);
+}
+
 void FileItemWidget::onCheckBoxToggled(bool checked) {
     emit selectionChanged(m_fileInfo.fileId, checked);
 }
@@ -467,4 +492,38 @@ void FileListWidget::onReloadButtonClicked() {
         // Emit signal to notify Workspace about the reload
         emit filesChanged();
     });
-}
\ No newline at end of file
+}
+
+// Follow button handler
+void FileListWidget::onFollowButtonToggled(bool checked) {
+    QtBridge::getInstance().logInfo(QString("FileListWidget: Follow %1").arg(checked ? "on" : "off"));
+    bridge.setFollowFilesInWorkspace(workspaceId, checked);
+    emit followToggled(checked);
+}
+
+void FileListWidget::onFileLoaded(qint64 loadedWorkspaceId, qint32 fileId, bool loaded) {
+    if (loadedWorkspaceId != workspaceId) {
+        return;
+    }
+    for (int i = 0; i < fileListWidget->count(); ++i) {
+        FileItemWidget *fileItemWidget = qobject_cast<FileItemWidget*>(fileListWidget->itemWidget(fileListWidget->item(i)));
+        if (fileItemWidget && fileItemWidget->getFileId() == fileId) {
+            fileItemWidget->setLoadState(loaded ? FileInfo::LoadState::Loaded : FileInfo::LoadState::Failed);
+            break;
+        }
+    }
+}
+
+void FileListWidget::updateLoadStates() {
+    bridge.getFileListFromWorkspace(workspaceId, [this](const QList<FileInfo> &fileList) {
+        for (const FileInfo &fileInfo : fileList) {
+            for (int i = 0; i < fileListWidget->count(); ++i) {
+                FileItemWidget *fileItemWidget = qobject_cast<FileItemWidget*>(fileListWidget->itemWidget(fileListWidget->item(i)));
+                if (fileItemWidget && fileItemWidget->getFileId() == fileInfo.fileId) {
+                    fileItemWidget->setLoadState(fileInfo.loadState);
+                    break;
+                }
+            }
+        }
+    });
+}
@@ -30,9 +30,12 @@ public:
     QString getFilePathAt(int index) const;
     int findFileIndex(const QString &filePath) const;
     void removeFile(qint32 index);
+    // Shows the load state the workspace has for every file
+    void updateLoadStates();
 
 signals:
     void filesChanged();
+    void followToggled(bool follow);
 
 protected:
     bool eventFilter(QObject *obj, QEvent *event) override;
@@ -43,6 +46,8 @@ private slots:
     void updateFileSelection(int id, bool selected);
     void handleItemMoved(int fromIndex, int toIndex);
     void onReloadButtonClicked();
+    void onFollowButtonToggled(bool checked);
+    void onFileLoaded(qint64 loadedWorkspaceId, qint32 fileId, bool loaded);
 
 private:
     int64_t workspaceId = -1;
@@ -50,6 +55,7 @@ private:
     QListWidget *fileListWidget;
     QList<FileInfo> fileList;
     QToolButton *reloadButton;
+    QToolButton *followButton;
     
     void createFileItem(int index, const FileInfo &fileInfo);
     void addFilesFromUrls(const QList<QUrl> &urls);
@@ -66,6 +72,7 @@ public:
     bool isSelected() const { return checkBox->isChecked(); }
     int32_t getFileId() const { return m_fileInfo.fileId; }
     void setFileIndex(int index);
+    void setLoadState(FileInfo::LoadState state);
     FileInfo getFileInfo() const { return m_fileInfo; }
 
 signals:
@@ -80,6 +87,8 @@ protected:
     void mousePressEvent(QMouseEvent *event) override;
 
 private:
+    void updateFileNameLabel();
+
     FileInfo m_fileInfo;
     QLabel *indexLabel;
     QLabel *fileNameLabel;
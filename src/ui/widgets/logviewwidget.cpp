@@ -0,0 +1,473 @@
+#include "logviewwidget.h"
+#include <QApplication>
+#include <QClipboard>
+#include <QKeyEvent>
+#include <QMetaObject>
+#include <QMouseEvent>
+#include <QPainter>
+#include <QPainterPath>
+#include <QScrollBar>
+#include <algorithm>
+#include <cmath>
+#include "bridge/QtBridge.h"
+
+LogViewWidget::LogViewWidget(QtBridge& bridge, int64_t workspaceId, QWidget *parent)
+    : QAbstractScrollArea(parent), m_bridge(bridge), m_workspaceId(workspaceId), m_glyphCache(GLYPH_CACHE_ROWS)
+{
+    setFrameShape(QFrame::NoFrame);
+    setFocusPolicy(Qt::StrongFocus);
+    setVerticalScrollBarPolicy(Qt::ScrollBarAlwaysOn);
+    setHorizontalScrollBarPolicy(Qt::ScrollBarAlwaysOn);
+    viewport()->setCursor(Qt::IBeamCursor);
+    // Every pixel of the viewport is painted, nothing to clear first
+    viewport()->setAttribute(Qt::WA_OpaquePaintEvent);
+    updateMetrics();
+}
+
+void LogViewWidget::setRowCount(int rowCount, int maxFileLineCount)
+{
+    m_rowCount = std::max(0, rowCount);
+    m_bRowsStale = true;
+    m_glyphCache.clear();
+    m_outputLineFieldWidth = QString::number(m_rowCount).length();
+    m_lineIndexFieldWidth = QString::number(maxFileLineCount).length();
+    updateMetrics();
+
+    // Positions past the new end move to the last row, the match belongs to the old output
+    auto clampPosition = [this](Position& position) {
+        if (position.row >= m_rowCount) {
+            position = m_rowCount > 0 ? Position{m_rowCount - 1, 0} : Position();
+        }
+    };
+    clampPosition(m_cursor);
+    clampPosition(m_anchor);
+    m_matchStart = Position();
+    updateScrollBars();
+    viewport()->update();
+}
+
+void LogViewWidget::clear()
+{
+    m_rows = OutputRows();
+    m_maxDisplayColumnCount = 0;
+    m_cursor = Position();
+    m_anchor = Position();
+    setRowCount(0, 0);
+}
+
+int LogViewWidget::getTopRow() const
+{
+    return verticalScrollBar()->value();
+}
+
+void LogViewWidget::setTopRow(int row)
+{
+    verticalScrollBar()->setValue(row);
+}
+
+int LogViewWidget::getVisibleRowCount() const
+{
+    return std::max(1, static_cast<int>(viewport()->height() / m_rowHeight));
+}
+
+bool LogViewWidget::isAtEnd() const
+{
+    return verticalScrollBar()->value() >= verticalScrollBar()->maximum();
+}
+
+void LogViewWidget::scrollToEnd()
+{
+    verticalScrollBar()->setValue(verticalScrollBar()->maximum());
+}
+
+int LogViewWidget::getCursorRow() const
+{
+    return m_cursor.row < 0 ? getTopRow() : m_cursor.row;
+}
+
+int LogViewWidget::getCursorColumn() const
+{
+    return m_cursor.row < 0 ? 0 : m_cursor.column;
+}
+
+void LogViewWidget::setCursorPosition(int row, int column)
+{
+    if (row < 0 || row >= m_rowCount) {
+        return;
+    }
+    m_cursor = {row, std::max(0, column)};
+    m_anchor = m_cursor;
+    if (row < getTopRow()) {
+        setTopRow(row);
+    } else if (row >= getTopRow() + getVisibleRowCount()) {
+        setTopRow(row - getVisibleRowCount() + 1);
+    }
+    viewport()->update();
+}
+
+void LogViewWidget::setMatch(int row, int startColumn, int endColumn)
+{
+    m_matchStart = {row, startColumn};
+    m_matchEndColumn = endColumn;
+    viewport()->update();
+}
+
+int LogViewWidget::toColumn(int row, int32_t byteOffset) const
+{
+    if (!m_bRowsStale && row >= m_rows.getBeginRow() && row < m_rows.getEndRow()) {
+        return m_rows.toColumn(row - m_rows.getBeginRow(), byteOffset);
+    }
+    // A row out of the fetched ones, e.g. a match far from the view, is fetched on its own
+    OutputRows rows = m_bridge.getOutputRows(m_workspaceId, row, 1);
+    return rows.isEmpty() ? 0 : rows.toColumn(0, byteOffset);
+}
+
+int32_t LogViewWidget::toByteOffset(int row, int column) const
+{
+    if (!m_bRowsStale && row >= m_rows.getBeginRow() && row < m_rows.getEndRow()) {
+        return m_rows.toByteOffset(row - m_rows.getBeginRow(), column);
+    }
+    OutputRows rows = m_bridge.getOutputRows(m_workspaceId, row, 1);
+    return rows.isEmpty() ? 0 : rows.toByteOffset(0, column);
+}
+
+bool LogViewWidget::hasSelection() const
+{
+    return m_cursor.row >= 0 && !(m_cursor == m_anchor);
+}
+
+void LogViewWidget::copy() const
+{
+    if (!hasSelection()) {
+        return;
+    }
+    Position start = std::min(m_anchor, m_cursor);
+    Position end = std::max(m_anchor, m_cursor);
+    // The selection may reach beyond the fetched rows, its rows are fetched on their own
+    OutputRows rows = m_bridge.getOutputRows(m_workspaceId, start.row, end.row - start.row + 1);
+    QString text;
+    for (int index = 0; index < rows.size(); ++index) {
+        int row = rows.getBeginRow() + index;
+        QString lineText = rows.getLineText(index);
+        int startColumn = row == start.row ? std::min(start.column, static_cast<int>(lineText.length())) : 0;
+        int endColumn = row == end.row ? std::min(end.column, static_cast<int>(lineText.length())) : static_cast<int>(lineText.length());
+        if (index > 0) {
+            text += QChar('\n');
+        }
+        text += lineText.mid(startColumn, std::max(0, endColumn - startColumn));
+    }
+    QApplication::clipboard()->setText(text);
+}
+
+void LogViewWidget::updateMetrics()
+{
+    QFontMetricsF fm(font());
+    m_rowHeight = std::ceil(fm.height());
+    m_charWidth = fm.horizontalAdvance(QChar('0'));
+    QString example = formatLinePrefix(
+        static_cast<int>(std::pow(10, m_outputLineFieldWidth) - 1),
+        static_cast<int>(std::pow(10, m_fileIndexFieldWidth) - 1),
+        static_cast<int>(std::pow(10, m_lineIndexFieldWidth) - 1) - 1);
+    m_gutterWidth = static_cast<int>(std::ceil(fm.horizontalAdvance(example))) + GUTTER_PADDING;
+    horizontalScrollBar()->setSingleStep(static_cast<int>(std::ceil(m_charWidth * 2)));
+}
+
+void LogViewWidget::updateScrollBars()
+{
+    m_bScrollBarsPending = false;
+    int pageRows = getVisibleRowCount();
+    verticalScrollBar()->setRange(0, std::max(0, m_rowCount - pageRows));
+    verticalScrollBar()->setPageStep(pageRows);
+    verticalScrollBar()->setSingleStep(1);
+
+    int textWidth = std::max(0, viewport()->width() - m_gutterWidth - TEXT_MARGIN);
+    int contentWidth = static_cast<int>(std::ceil(m_maxDisplayColumnCount * m_charWidth)) + TEXT_MARGIN;
+    horizontalScrollBar()->setRange(0, std::max(0, contentWidth - textWidth));
+    horizontalScrollBar()->setPageStep(textWidth);
+}
+
+void LogViewWidget::ensureRows(int beginRow, int rowCount)
+{
+    int endRow = std::min(m_rowCount, beginRow + rowCount);
+    if (!m_bRowsStale && m_rows.getBeginRow() <= beginRow && endRow <= m_rows.getEndRow()) {
+        return;
+    }
+    // A page either side, so short scrolls paint from rows already fetched
+    int fetchBeginRow = std::max(0, beginRow - rowCount);
+    m_rows = m_bridge.getOutputRows(m_workspaceId, fetchBeginRow, rowCount * 3);
+    m_bRowsStale = false;
+}
+
+const LogViewWidget::RowGlyphs* LogViewWidget::getRowGlyphs(int row)
+{
+    if (RowGlyphs* glyphs = m_glyphCache.object(row)) {
+        return glyphs;
+    }
+    if (row < m_rows.getBeginRow() || row >= m_rows.getEndRow()) {
+        return nullptr;
+    }
+    int index = row - m_rows.getBeginRow();
+    RowGlyphs* glyphs = new RowGlyphs;
+    const Core::OutputLine& line = m_rows.getLine(index);
+    glyphs->gutter.setText(formatLinePrefix(row + 1, line.getFileRow(), line.getLineIndex()));
+    glyphs->gutter.setTextFormat(Qt::PlainText);
+    glyphs->gutter.prepare(QTransform(), font());
+
+    int displayColumn = 0;
+    for (int spanIndex = 0; spanIndex < m_rows.getSpanCount(index); ++spanIndex) {
+        QString spanText = m_rows.getSpanText(index, spanIndex);
+        if (spanText.isEmpty()) {
+            continue;
+        }
+        GlyphRun run;
+        run.displayColumn = displayColumn;
+        int colorIndex = m_rows.getSpanColorIndex(index, spanIndex);
+        if (colorIndex != OutputRows::DEFAULT_COLOR_INDEX) {
+            run.color = m_rows.getPalette()[colorIndex];
+        }
+        // Tabs go to the next multiple of TAB_WIDTH, every other character takes one column
+        QString displayText;
+        displayText.reserve(spanText.length());
+        for (QChar c : spanText) {
+            glyphs->displayColumns.append(displayColumn);
+            if (c == QChar('\t')) {
+                int nextColumn = (displayColumn / TAB_WIDTH + 1) * TAB_WIDTH;
+                displayText += QString(nextColumn - displayColumn, QChar(' '));
+                displayColumn = nextColumn;
+            } else {
+                displayText += c;
+                ++displayColumn;
+            }
+        }
+        glyphs->text += spanText;
+        run.text.setText(displayText);
+        run.text.setTextFormat(Qt::PlainText);
+        run.text.setPerformanceHint(QStaticText::AggressiveCaching);
+        run.text.prepare(QTransform(), font());
+        glyphs->runs.append(run);
+    }
+    glyphs->displayColumns.append(displayColumn);
+
+    if (displayColumn > m_maxDisplayColumnCount) {
+        m_maxDisplayColumnCount = displayColumn;
+        // Rows are laid out while painting, the scroll bar follows once the paint is done
+        if (!m_bScrollBarsPending) {
+            m_bScrollBarsPending = true;
+            QMetaObject::invokeMethod(this, [this]() { updateScrollBars(); }, Qt::QueuedConnection);
+        }
+    }
+    m_glyphCache.insert(row, glyphs);
+    return glyphs;
+}
+
+QString LogViewWidget::formatLinePrefix(int outputLineNumber, int fileIndex, int lineIndex) const
+{
+    return QString("%1 [%2:%3]")
+        .arg(outputLineNumber, m_outputLineFieldWidth, 10, QChar('0'))
+        .arg(fileIndex, m_fileIndexFieldWidth, 10, QChar('0'))
+        .arg(lineIndex + 1, m_lineIndexFieldWidth, 10, QChar('0'));
+}
+
+qreal LogViewWidget::getTextLeft() const
+{
+    return m_gutterWidth + TEXT_MARGIN - horizontalScrollBar()->value();
+}
+
+qreal LogViewWidget::getColumnX(const RowGlyphs& glyphs, int column) const
+{
+    column = std::max(0, std::min(column, static_cast<int>(glyphs.displayColumns.size()) - 1));
+    return getTextLeft() + glyphs.displayColumns[column] * m_charWidth;
+}
+
+LogViewWidget::Position LogViewWidget::getPositionAt(const QPoint& point)
+{
+    if (m_rowCount == 0) {
+        return Position();
+    }
+    int row = getTopRow() + static_cast<int>(std::floor(point.y() / m_rowHeight));
+    row = std::max(0, std::min(row, m_rowCount - 1));
+    ensureRows(row, getVisibleRowCount() + 1);
+    const RowGlyphs* glyphs = getRowGlyphs(row);
+    if (!glyphs) {
+        return {row, 0};
+    }
+    // The column whose display column is nearest, a click in a tab lands on its nearer side
+    int displayColumn = static_cast<int>(std::lround((point.x() - getTextLeft()) / m_charWidth));
+    auto it = std::lower_bound(glyphs->displayColumns.begin(), glyphs->displayColumns.end(), displayColumn);
+    int column = static_cast<int>(it - glyphs->displayColumns.begin());
+    return {row, std::min(column, static_cast<int>(glyphs->text.length()))};
+}
+
+void LogViewWidget::paintEvent(QPaintEvent *event)
+{
+    QPainter painter(viewport());
+    const QPalette& palette = QApplication::palette();
+    QColor baseColor = palette.color(QPalette::Base);
+    QColor textColor = palette.color(QPalette::Text);
+    painter.fillRect(event->rect(), baseColor);
+
+    int topRow = getTopRow();
+    int rowCount = std::min(m_rowCount - topRow, getVisibleRowCount() + 1);
+    if (rowCount > 0) {
+        ensureRows(topRow, rowCount);
+    }
+
+    // Text first, clipped so horizontally scrolled text stays out of the gutter
+    painter.save();
+    painter.setClipRect(QRectF(m_gutterWidth, 0, viewport()->width() - m_gutterWidth, viewport()->height()));
+    for (int i = 0; i < rowCount; ++i) {
+        const RowGlyphs* glyphs = getRowGlyphs(topRow + i);
+        if (!glyphs) {
+            break;
+        }
+        paintRow(painter, topRow + i, *glyphs, i * m_rowHeight, textColor);
+    }
+    painter.restore();
+
+    // The gutter in the same pass, with a slightly muted color for subtle contrast
+    painter.fillRect(QRectF(0, 0, m_gutterWidth, viewport()->height()), baseColor);
+    painter.setPen(textColor.darker(120));
+    for (int i = 0; i < rowCount; ++i) {
+        const RowGlyphs* glyphs = m_glyphCache.object(topRow + i);
+        if (!glyphs) {
+            break;
+        }
+        qreal x = m_gutterWidth - GUTTER_PADDING / 2 - glyphs->gutter.size().width();
+        painter.drawStaticText(QPointF(x, i * m_rowHeight), glyphs->gutter);
+    }
+    painter.setPen(QPen(palette.color(QPalette::Mid), 1));
+    painter.drawLine(m_gutterWidth - 1, 0, m_gutterWidth - 1, viewport()->height());
+}
+
+void LogViewWidget::paintRow(QPainter& painter, int row, const RowGlyphs& glyphs, qreal top, const QColor& textColor)
+{
+    const QPalette& palette = QApplication::palette();
+    if (hasSelection()) {
+        Position start = std::min(m_anchor, m_cursor);
+        Position end = std::max(m_anchor, m_cursor);
+        if (start.row <= row && row <= end.row) {
+            qreal left = row == start.row ? getColumnX(glyphs, start.column) : getTextLeft();
+            // A selection going on to the next row covers the line break too
+            qreal right = row == end.row ? getColumnX(glyphs, end.column)
+                                         : getColumnX(glyphs, glyphs.text.length()) + m_charWidth;
+            painter.fillRect(QRectF(left, top, right - left, m_rowHeight), palette.color(QPalette::Highlight));
+        }
+    }
+
+    qreal textLeft = getTextLeft();
+    for (const GlyphRun& run : glyphs.runs) {
+        painter.setPen(run.color.isValid() ? run.color : textColor);
+        painter.drawStaticText(QPointF(textLeft + run.displayColumn * m_charWidth, top), run.text);
+    }
+
+    if (m_matchStart.row == row) {
+        // Wavy underline below the match
+        qreal left = getColumnX(glyphs, m_matchStart.column);
+        qreal right = getColumnX(glyphs, m_matchEndColumn);
+        qreal baseline = top + m_rowHeight - 2;
+        QPainterPath wave(QPointF(left, baseline));
+        bool bUp = true;
+        for (qreal x = left + 2; x <= right; x += 2) {
+            wave.lineTo(x, bUp ? baseline - 2 : baseline);
+            bUp = !bUp;
+        }
+        painter.setPen(QPen(Qt::red, 1));
+        painter.drawPath(wave);
+    }
+
+    if (m_cursor.row == row) {
+        qreal x = getColumnX(glyphs, m_cursor.column);
+        painter.setPen(QPen(textColor, 1));
+        painter.drawLine(QPointF(x, top), QPointF(x, top + m_rowHeight - 1));
+    }
+}
+
+void LogViewWidget::resizeEvent(QResizeEvent *event)
+{
+    QAbstractScrollArea::resizeEvent(event);
+    updateScrollBars();
+}
+
+void LogViewWidget::scrollContentsBy(int dx, int dy)
+{
+    // Scroll bars count rows and pixels, so the viewport is painted again instead of moved
+    Q_UNUSED(dx);
+    Q_UNUSED(dy);
+    viewport()->update();
+}
+
+void LogViewWidget::mousePressEvent(QMouseEvent *event)
+{
+    if (event->button() != Qt::LeftButton) {
+        QAbstractScrollArea::mousePressEvent(event);
+        return;
+    }
+    Position position = getPositionAt(event->position().toPoint());
+    if (position.row < 0) {
+        return;
+    }
+    m_cursor = position;
+    if (!(event->modifiers() & Qt::ShiftModifier)) {
+        m_anchor = position;
+    }
+    m_bSelecting = true;
+    viewport()->update();
+}
+
+void LogViewWidget::mouseMoveEvent(QMouseEvent *event)
+{
+    if (!m_bSelecting) {
+        QAbstractScrollArea::mouseMoveEvent(event);
+        return;
+    }
+    QPoint point = event->position().toPoint();
+    // Dragging past the top or bottom scrolls a row at a time
+    if (point.y() < 0) {
+        setTopRow(getTopRow() - 1);
+    } else if (point.y() >= viewport()->height()) {
+        setTopRow(getTopRow() + 1);
+    }
+    Position position = getPositionAt(point);
+    if (position.row >= 0) {
+        m_cursor = position;
+        viewport()->update();
+    }
+}
+
+void LogViewWidget::mouseReleaseEvent(QMouseEvent *event)
+{
+    if (event->button() == Qt::LeftButton) {
+        m_bSelecting = false;
+    }
+    QAbstractScrollArea::mouseReleaseEvent(event);
+}
+
+void LogViewWidget::keyPressEvent(QKeyEvent *event)
+{
+    if (event->matches(QKeySequence::Copy)) {
+        copy();
+        return;
+    }
+    if (event->matches(QKeySequence::MoveToStartOfDocument)) {
+        setTopRow(0);
+        return;
+    }
+    if (event->matches(QKeySequence::MoveToEndOfDocument)) {
+        scrollToEnd();
+        return;
+    }
+    QAbstractScrollArea::keyPressEvent(event);
+}
+
+void LogViewWidget::changeEvent(QEvent *event)
+{
+    if (event->type() == QEvent::FontChange) {
+        m_glyphCache.clear();
+        updateMetrics();
+        updateScrollBars();
+    }
+    if (event->type() == QEvent::FontChange || event->type() == QEvent::PaletteChange) {
+        viewport()->update();
+    }
+    QAbstractScrollArea::changeEvent(event);
+}
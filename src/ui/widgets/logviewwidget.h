@@ -0,0 +1,123 @@
+#ifndef LOGVIEWWIDGET_H
+#define LOGVIEWWIDGET_H
+
+#include <QAbstractScrollArea>
+#include <QCache>
+#include <QStaticText>
+#include <QVector>
+#include "OutputRows.h"
+
+class QtBridge;
+
+/**
+ * @brief Scroll area painting the output of a workspace as fixed-height monospace rows
+ *
+ * Only the rows in view, and a page either side, are fetched from the bridge, and a paint draws
+ * them straight from their spans together with the gutter of line numbers. Each row is laid out
+ * once into glyph runs that stay cached until the output changes, so scrolling only paints.
+ *
+ * Rows and columns are output rows and characters of their text, the vertical scroll bar counts
+ * rows and the horizontal one pixels.
+ */
+class LogViewWidget : public QAbstractScrollArea {
+    Q_OBJECT
+public:
+    explicit LogViewWidget(QtBridge& bridge, int64_t workspaceId, QWidget *parent = nullptr);
+
+    // The output changed, rows are fetched again the next time they are painted
+    void setRowCount(int rowCount, int maxFileLineCount);
+    void clear();
+    int getRowCount() const { return m_rowCount; }
+
+    int getTopRow() const;
+    void setTopRow(int row);
+    int getVisibleRowCount() const;     // rows that fit in full
+    bool isAtEnd() const;
+    void scrollToEnd();
+
+    // The cursor is at the top row until a click or setCursorPosition() puts it somewhere
+    int getCursorRow() const;
+    int getCursorColumn() const;
+    // Moves the cursor and scrolls its row into view
+    void setCursorPosition(int row, int column);
+    // Underlines [startColumn, endColumn) of row as the match navigation went to, until the output changes
+    void setMatch(int row, int startColumn, int endColumn);
+    // Match navigation in the core counts UTF-8 bytes of a row instead of columns
+    int toColumn(int row, int32_t byteOffset) const;
+    int32_t toByteOffset(int row, int column) const;
+
+    bool hasSelection() const;
+    void copy() const;
+
+protected:
+    void paintEvent(QPaintEvent *event) override;
+    void resizeEvent(QResizeEvent *event) override;
+    void scrollContentsBy(int dx, int dy) override;
+    void mousePressEvent(QMouseEvent *event) override;
+    void mouseMoveEvent(QMouseEvent *event) override;
+    void mouseReleaseEvent(QMouseEvent *event) override;
+    void keyPressEvent(QKeyEvent *event) override;
+    void changeEvent(QEvent *event) override;
+
+private:
+    static constexpr int TAB_WIDTH = 8;
+    static constexpr int TEXT_MARGIN = 4;
+    static constexpr int GUTTER_PADDING = 12;
+    static constexpr int GLYPH_CACHE_ROWS = 4096;
+
+    // Consecutive characters of a row in one color
+    struct GlyphRun {
+        QStaticText text;
+        QColor color;           // invalid for the text color of the palette
+        int displayColumn = 0;  // after tabs are expanded
+    };
+
+    struct RowGlyphs {
+        QStaticText gutter;
+        QVector<GlyphRun> runs;
+        QString text;                   // as in the output, tabs included
+        QVector<int> displayColumns;    // display column of every column of text, and of its end
+    };
+
+    struct Position {
+        int row = -1;
+        int column = 0;
+        bool operator==(const Position& other) const { return row == other.row && column == other.column; }
+        bool operator<(const Position& other) const { return row < other.row || (row == other.row && column < other.column); }
+    };
+
+    void updateMetrics();
+    void updateScrollBars();
+    void ensureRows(int beginRow, int rowCount);
+    const RowGlyphs* getRowGlyphs(int row);
+    QString formatLinePrefix(int outputLineNumber, int fileIndex, int lineIndex) const;
+    qreal getTextLeft() const;
+    qreal getColumnX(const RowGlyphs& glyphs, int column) const;
+    Position getPositionAt(const QPoint& point);
+    void paintRow(QPainter& painter, int row, const RowGlyphs& glyphs, qreal top, const QColor& textColor);
+
+    QtBridge& m_bridge;
+    int64_t m_workspaceId;
+
+    int m_rowCount = 0;
+    OutputRows m_rows;              // fetched rows, a superset of the visible ones unless m_bRowsStale
+    bool m_bRowsStale = true;
+    QCache<int/*row*/, RowGlyphs> m_glyphCache;
+
+    qreal m_rowHeight = 1;
+    qreal m_charWidth = 1;
+    int m_gutterWidth = 0;
+    int m_outputLineFieldWidth = 1;
+    int m_fileIndexFieldWidth = 2;
+    int m_lineIndexFieldWidth = 1;
+    int m_maxDisplayColumnCount = 0;    // widest row laid out so far, for the horizontal scroll bar
+    bool m_bScrollBarsPending = false;
+
+    Position m_cursor;
+    Position m_anchor;                  // selection is between the anchor and the cursor
+    bool m_bSelecting = false;
+    Position m_matchStart;
+    int m_matchEndColumn = 0;
+};
+
+#endif // LOGVIEWWIDGET_H
@@ -79,6 +79,7 @@ Workspace::Workspace(int64_t id, QWidget *parent)
     
     // Connect file selection signals
     connect(fileListWidget, &FileListWidget::filesChanged, this, &Workspace::onFilesChanged);
+    connect(fileListWidget, &FileListWidget::followToggled, outputDisplay, &OutputDisplayWidget::setFollowTail);
         
     // Connect filter change signal
     connect(filterListWidget, &FilterListWidget::filtersChanged, this, &Workspace::onFiltersChanged); 
@@ -89,6 +90,11 @@ Workspace::Workspace(int64_t id, QWidget *parent)
     connect(searchListWidget, &SearchListWidget::searchsChanged, this, &Workspace::onSearchsChanged);
     connect(searchListWidget, &SearchListWidget::navigateToNextMatch, outputDisplay, &OutputDisplayWidget::onNavigateToNextSearchMatch);
     connect(searchListWidget, &SearchListWidget::navigateToPreviousMatch, outputDisplay, &OutputDisplayWidget::onNavigateToPreviousSearchMatch);
+
+    // Output is recomputed in the background, refresh when new lines and match counts are published
+    connect(&bridge, &QtBridge::outputUpdated, this, &Workspace::onOutputUpdated);
+    connect(&bridge, &QtBridge::followedFilesChanged, this, &Workspace::onFollowedFilesChanged);
+    connect(&bridge, &QtBridge::fileLoaded, this, &Workspace::onFileLoaded);
         
     bridge.logInfo("[Workspace:" + QString::number(workspaceId) + "] Created workspace: ");
 }
@@ -156,6 +162,8 @@ void Workspace::setSortIndex(int index)
 
 void Workspace::stopLoading()
 {
+    // Keeps the lines processed so far, the next edit starts a new pass
+    bridge.cancelOutputUpdate(workspaceId);
 }
 
 QStringList Workspace::getSelectedFiles() const
@@ -208,6 +216,9 @@ void Workspace::setActive(bool active)
     searchListWidget->doUpdate();
     
     if (active) {
+        // Activating the workspace starts loading its files
+        fileListWidget->updateLoadStates();
+
         // 强制布局更新以确保 OutputDisplayWidget 接收到正确的尺寸
         outputDisplay->updateGeometry();
         outputDisplay->layout()->invalidate();
@@ -259,6 +270,37 @@ void Workspace::onFilterMatchCountsUpdated(const QMap<int, int> &matchCounts)
 {
 }
 
+void Workspace::onOutputUpdated(qint64 updatedWorkspaceId, bool finished)
+{
+    if (updatedWorkspaceId != workspaceId) {
+        return;
+    }
+    Q_UNUSED(finished);
+    outputDisplay->doUpdate(true);
+    filterListWidget->doUpdate();
+    searchListWidget->doUpdate();
+}
+
+void Workspace::onFollowedFilesChanged(qint64 changedWorkspaceId)
+{
+    if (changedWorkspaceId != workspaceId) {
+        return;
+    }
+    // The appended lines are matched in the background and arrive through onOutputUpdated
+    bridge.updateFollowedFilesInWorkspace(workspaceId);
+}
+
+void Workspace::onFileLoaded(qint64 loadedWorkspaceId, qint32 fileId, bool loaded)
+{
+    if (loadedWorkspaceId != workspaceId) {
+        return;
+    }
+    Q_UNUSED(fileId);
+    Q_UNUSED(loaded);
+    // The files are taken in once the last one of the load is indexed, the output follows through onOutputUpdated
+    bridge.updateLoadedFilesInWorkspace(workspaceId);
+}
+
 void Workspace::updateTheme()
 {
     // Log that we're updating the theme for this workspace
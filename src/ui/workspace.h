@@ -57,6 +57,9 @@ private slots:
     void onFiltersChanged();
     void onSearchsChanged();
     void onFilterMatchCountsUpdated(const QMap<int, int> &matchCounts);
+    void onOutputUpdated(qint64 updatedWorkspaceId, bool finished);
+    void onFollowedFilesChanged(qint64 changedWorkspaceId);
+    void onFileLoaded(qint64 loadedWorkspaceId, qint32 fileId, bool loaded);
 
 private:
     const int64_t workspaceId;